@@ -0,0 +1,118 @@
+/**
+ * @file generator_bench.cpp
+ * @brief Code generation throughput benchmark
+ *
+ * Preprocesses, parses and analyzes the given IDL files once, then runs
+ * the C++11 generator over all of them repeatedly, without writing any
+ * files, and reports units and generated megabytes per second.
+ *
+ * Usage: iborb_idl_generator_bench [--iterations <n>] [-I <dir>...] <idl-files...>
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "generator/cpp11_generator.hpp"
+#include "parser/parser.hpp"
+#include "preprocessor/builtin_preprocessor.hpp"
+#include "semantic/analyzer.hpp"
+
+namespace {
+
+/**
+ * @brief A unit ready for generation
+ */
+struct Input {
+    iborb::ast::TranslationUnit unit;
+    std::unique_ptr<iborb::semantic::Analyzer> analyzer;  // Owns the symbol table
+};
+
+bool load(const std::string& file, const std::vector<std::string>& includePaths,
+          std::vector<Input>& inputs) {
+    iborb::preprocessor::BuiltinPreprocessor pp;
+    for (const auto& path : includePaths) {
+        pp.addIncludePath(path);
+    }
+    auto preprocessed = pp.preprocessFile(file);
+    if (!preprocessed.success) {
+        std::cerr << file << ": " << preprocessed.errorMessage << "\n";
+        return false;
+    }
+
+    iborb::parser::Parser parser(std::move(preprocessed.output), file);
+    Input input;
+    input.unit = parser.parse();
+    if (parser.hasErrors()) {
+        std::cerr << file << ": parse errors\n";
+        return false;
+    }
+
+    input.analyzer = std::make_unique<iborb::semantic::Analyzer>();
+    if (!input.analyzer->analyze(input.unit, parser.getImportedSymbols())) {
+        std::cerr << file << ": semantic errors\n";
+        return false;
+    }
+    inputs.push_back(std::move(input));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = 2000;
+    std::vector<std::string> includePaths;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::stoul(argv[++i]);
+        } else if (arg == "-I" && i + 1 < argc) {
+            includePaths.push_back(argv[++i]);
+        } else if (arg.rfind("-I", 0) == 0 && arg.size() > 2) {
+            includePaths.push_back(arg.substr(2));
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--iterations <n>] [-I <dir>...] <idl-files...>\n";
+        return 1;
+    }
+
+    std::vector<Input> inputs;
+    for (const auto& file : files) {
+        if (!load(file, includePaths, inputs)) {
+            return 1;
+        }
+    }
+
+    iborb::generator::GeneratorConfig config;
+    config.outputDir.clear();
+    config.deferWrite = true;
+
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (const auto& input : inputs) {
+            iborb::generator::Cpp11Generator generator(config);
+            generator.setSymbolTable(&input.analyzer->getSymbolTable());
+            generator.generate(input.unit);
+            bytes += generator.getHeader().size() + generator.getSource().size();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    size_t units = iterations * inputs.size();
+
+    std::cout << "Generated " << units << " units (" << inputs.size() << " file(s) x "
+              << iterations << ") in " << seconds << " s\n"
+              << "  " << static_cast<double>(units) / seconds << " units/s, "
+              << static_cast<double>(bytes) / seconds / (1024.0 * 1024.0) << " MB/s of output\n";
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file lexer_bench.cpp
+ * @brief Lexer throughput micro-benchmark
+ *
+ * Replicates the given IDL files until the corpus reaches the requested
+ * size and reports tokens per second for plain consumption and for a
+ * parser-like pattern that peeks a few tokens ahead before consuming.
+ *
+ * Usage: iborb_idl_lexer_bench [--mb <size>] [--peek <n>]
+ *                              [--simd scalar|sse2|avx2|all] <idl-files...>
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lexer/lexer.hpp"
+#include "lexer/simd_scan.hpp"
+
+using iborb::lexer::Lexer;
+using iborb::lexer::SimdLevel;
+using iborb::lexer::TokenType;
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+struct Result {
+    size_t tokens = 0;
+    double seconds = 0.0;
+    size_t checksum = 0;  // Of the peeked token types, reported so the peeks are kept
+};
+
+Result run(const std::string& corpus, size_t peekDepth) {
+    auto start = std::chrono::steady_clock::now();
+    Lexer lexer(corpus, "<bench>");
+    Result result;
+    while (true) {
+        for (size_t i = 0; i < peekDepth; ++i) {
+            result.checksum += static_cast<size_t>(lexer.peekToken(i).type);
+        }
+        auto tok = lexer.nextToken();
+        ++result.tokens;
+        if (tok.type == TokenType::Eof) {
+            break;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+void report(const char* label, const Result& r, size_t bytes) {
+    std::cout << label << ": " << r.tokens << " tokens in " << r.seconds << " s, "
+              << static_cast<double>(r.tokens) / r.seconds / 1e6 << " Mtok/s, "
+              << static_cast<double>(bytes) / r.seconds / (1024.0 * 1024.0) << " MB/s"
+              << " (checksum " << r.checksum << ")\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t targetMb = 100;
+    size_t peekDepth = 3;
+    std::string simd = "auto";
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mb" && i + 1 < argc) {
+            targetMb = std::stoul(argv[++i]);
+        } else if (arg == "--peek" && i + 1 < argc) {
+            peekDepth = std::stoul(argv[++i]);
+        } else if (arg == "--simd" && i + 1 < argc) {
+            simd = argv[++i];
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--mb <size>] [--peek <n>]"
+                  << " [--simd scalar|sse2|avx2|all] <idl-files...>\n";
+        return 1;
+    }
+
+    std::string unit;
+    for (const auto& file : files) {
+        unit += readFile(file);
+        unit += '\n';
+    }
+
+    std::string corpus;
+    corpus.reserve(targetMb * 1024 * 1024 + unit.size());
+    while (corpus.size() < targetMb * 1024 * 1024) {
+        corpus += unit;
+    }
+
+    std::cout << "Corpus: " << corpus.size() / (1024 * 1024) << " MB from "
+              << files.size() << " file(s)\n";
+
+    std::vector<SimdLevel> levels;
+    if (simd == "all") {
+        levels = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2};
+    } else if (simd == "scalar") {
+        levels = {SimdLevel::Scalar};
+    } else if (simd == "sse2") {
+        levels = {SimdLevel::SSE2};
+    } else if (simd == "avx2") {
+        levels = {SimdLevel::AVX2};
+    } else {
+        levels = {iborb::lexer::detectSimdLevel()};
+    }
+
+    for (auto level : levels) {
+        iborb::lexer::setSimdLevel(level);
+        std::cout << "Kernels: "
+                  << iborb::lexer::simdLevelName(iborb::lexer::scanKernels().level) << "\n";
+        report("  next", run(corpus, 0), corpus.size());
+        report("  peek+next", run(corpus, peekDepth), corpus.size());
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file output_file_bench.cpp
+ * @brief Rewrite-if-changed output benchmark
+ *
+ * Writes a multi-chunk generated file over an existing one through
+ * OutputFile for each kind of change (identical, edited first or last
+ * chunk, chunks reordered, output grown or shrunk), reports the time per
+ * write, and checks that the file on disk matches the generated output
+ * afterwards.
+ *
+ * Usage: iborb_idl_output_file_bench [--iterations <n>] [--chunks <n>] [--dir <dir>]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "generator/code_buffer.hpp"
+#include "generator/output_file.hpp"
+
+using iborb::generator::CodeBuffer;
+using iborb::generator::OutputFile;
+
+namespace {
+
+constexpr size_t kChunkSize = 64 * 1024;
+
+/**
+ * @brief One chunk worth of text, distinct for each tag
+ */
+std::string block(char tag) {
+    std::string text;
+    text.reserve(kChunkSize);
+    while (text.size() < kChunkSize) {
+        text += "// ";
+        text.append(60, tag);
+        text += '\n';
+    }
+    text.resize(kChunkSize);
+    return text;
+}
+
+/**
+ * @brief Old and new contents of the file, one tag per chunk
+ */
+struct Scenario {
+    const char* name;
+    std::string before;
+    std::string after;
+};
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = 200;
+    size_t chunks = 16;
+    std::string dir = std::filesystem::temp_directory_path().string();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::stoul(argv[++i]);
+        } else if (arg == "--chunks" && i + 1 < argc) {
+            chunks = std::max<size_t>(std::stoul(argv[++i]), 3);
+        } else if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--iterations <n>] [--chunks <n>] [--dir <dir>]\n";
+            return 1;
+        }
+    }
+
+    // Chunk i is tagged 'a' + i % 26; 'Z' marks an edited chunk
+    std::string base;
+    for (size_t i = 0; i < chunks; ++i) {
+        base += static_cast<char>('a' + i % 26);
+    }
+    std::string editFirst = base;
+    editFirst.front() = 'Z';
+    std::string editLast = base;
+    editLast.back() = 'Z';
+    // Old file A B B, new output A C B: the second chunk differs but the
+    // third matches the old file at the offset of the second
+    std::string repeated = base;
+    repeated[2] = repeated[1];
+    std::string reordered = repeated;
+    reordered[1] = 'Z';
+
+    std::vector<Scenario> scenarios = {
+        {"unchanged", base, base},
+        {"edit first chunk", base, editFirst},
+        {"edit last chunk", base, editLast},
+        {"reorder chunks", repeated, reordered},
+        {"grow", base, base + "Z"},
+        {"shrink", base + "Z", base},
+    };
+
+    std::string path = (std::filesystem::path(dir) / "iborb_idl_output_file_bench.hpp").string();
+    bool ok = true;
+    for (const auto& scenario : scenarios) {
+        std::string before;
+        for (char tag : scenario.before) {
+            before += block(tag);
+        }
+        CodeBuffer after;
+        for (char tag : scenario.after) {
+            after.append(block(tag));
+        }
+        std::string expected = after.str();
+
+        double seconds = 0.0;
+        bool matched = true;
+        for (size_t i = 0; i < iterations && matched; ++i) {
+            writeFile(path, before);
+            auto start = std::chrono::steady_clock::now();
+            OutputFile file(path);
+            file.write(after);
+            bool committed = file.commit();
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (!committed || readFile(path) != expected) {
+                std::cerr << scenario.name << ": output on disk does not match\n";
+                matched = false;
+            }
+        }
+        if (!matched) {
+            ok = false;
+            continue;
+        }
+
+        std::cout << scenario.name << ": " << seconds / static_cast<double>(iterations) * 1e6
+                  << " us per write (" << expected.size() / 1024 << " KiB)\n";
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return ok ? 0 : 1;
+}
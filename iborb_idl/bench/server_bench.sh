@@ -0,0 +1,59 @@
+#!/bin/sh
+# Cold vs warm compile time benchmark
+#
+# Runs the same compiler invocation repeatedly, first as separate
+# processes and then as clients of a compile server (--server/--connect),
+# and reports the average wall time of each.
+#
+# Usage: server_bench.sh <iborb_idl> [--runs <n>] <compiler arguments...>
+# Example: server_bench.sh build/iborb_idl --runs 20 -I idl -o /tmp/out idl/*.idl
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <iborb_idl> [--runs <n>] <compiler arguments...>" >&2
+    exit 1
+fi
+
+compiler=$1
+shift
+runs=10
+if [ "$1" = "--runs" ]; then
+    runs=$2
+    shift 2
+fi
+
+socket=$(mktemp -u "${TMPDIR:-/tmp}/iborb_idl_bench.XXXXXX")
+
+now_ms() {
+    date +%s%N | cut -b1-13
+}
+
+# Average milliseconds per invocation of the given command
+time_runs() {
+    start=$(now_ms)
+    i=0
+    while [ $i -lt "$runs" ]; do
+        "$@" > /dev/null
+        i=$((i + 1))
+    done
+    end=$(now_ms)
+    echo $(((end - start) / runs))
+}
+
+cold=$(time_runs "$compiler" "$@")
+
+"$compiler" --server "$socket" &
+server=$!
+trap 'kill $server 2>/dev/null' EXIT
+while [ ! -S "$socket" ]; do
+    sleep 0.05
+done
+
+# The first request parses the shared headers, like a cold run
+first=$(runs=1 time_runs "$compiler" --connect "$socket" "$@")
+warm=$(time_runs "$compiler" --connect "$socket" "$@")
+
+echo "Cold (new process):      $cold ms per invocation ($runs runs)"
+echo "Server, first request:   $first ms"
+echo "Warm (server):           $warm ms per invocation ($runs runs)"
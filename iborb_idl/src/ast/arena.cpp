@@ -0,0 +1,100 @@
+#include "ast/arena.hpp"
+#include <algorithm>
+
+namespace iborb::ast {
+
+namespace {
+
+constexpr size_t kFirstBlockSize = 16 * 1024;
+constexpr size_t kMaxBlockSize = 1024 * 1024;
+
+// Block payloads start after the header, suitably aligned for any object
+constexpr size_t kHeaderSize =
+    (sizeof(void*) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+    alignof(std::max_align_t);
+
+} // anonymous namespace
+
+Arena::~Arena() {
+    release();
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : cursor_(std::exchange(other.cursor_, nullptr)),
+      end_(std::exchange(other.end_, nullptr)),
+      blocks_(std::exchange(other.blocks_, nullptr)),
+      finalizers_(std::exchange(other.finalizers_, nullptr)),
+      nextBlockSize_(std::exchange(other.nextBlockSize_, 0)),
+      reserved_(std::exchange(other.reserved_, 0)) {
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        release();
+        cursor_ = std::exchange(other.cursor_, nullptr);
+        end_ = std::exchange(other.end_, nullptr);
+        blocks_ = std::exchange(other.blocks_, nullptr);
+        finalizers_ = std::exchange(other.finalizers_, nullptr);
+        nextBlockSize_ = std::exchange(other.nextBlockSize_, 0);
+        reserved_ = std::exchange(other.reserved_, 0);
+    }
+    return *this;
+}
+
+void* Arena::allocateSlow(size_t size, size_t align) {
+    size_t needed = size + align - 1;
+
+    // Oversized requests get a block of their own so the current block
+    // keeps serving small allocations
+    if (needed > kMaxBlockSize / 4) {
+        char* memory = static_cast<char*>(::operator new(kHeaderSize + needed));
+        Block* block = reinterpret_cast<Block*>(memory);
+        if (blocks_) {
+            block->next = blocks_->next;
+            blocks_->next = block;
+        } else {
+            block->next = nullptr;
+            blocks_ = block;
+        }
+        reserved_ += kHeaderSize + needed;
+        char* data = memory + kHeaderSize;
+        return data + (align - reinterpret_cast<uintptr_t>(data) % align) % align;
+    }
+
+    nextBlockSize_ = nextBlockSize_ == 0 ? kFirstBlockSize
+                                         : std::min(nextBlockSize_ * 2, kMaxBlockSize);
+    size_t blockSize = std::max(nextBlockSize_, kHeaderSize + needed);
+    char* memory = static_cast<char*>(::operator new(blockSize));
+    Block* block = reinterpret_cast<Block*>(memory);
+    block->next = blocks_;
+    blocks_ = block;
+    reserved_ += blockSize;
+
+    cursor_ = memory + kHeaderSize;
+    end_ = memory + blockSize;
+    return allocate(size, align);
+}
+
+void Arena::addFinalizer(void* object, void (*destroy)(void*)) {
+    void* memory = allocate(sizeof(Finalizer), alignof(Finalizer));
+    finalizers_ = new (memory) Finalizer{destroy, object, finalizers_};
+}
+
+void Arena::release() {
+    for (Finalizer* finalizer = finalizers_; finalizer; finalizer = finalizer->next) {
+        finalizer->destroy(finalizer->object);
+    }
+    finalizers_ = nullptr;
+
+    while (blocks_) {
+        Block* next = blocks_->next;
+        ::operator delete(blocks_);
+        blocks_ = next;
+    }
+    cursor_ = nullptr;
+    end_ = nullptr;
+    nextBlockSize_ = 0;
+    reserved_ = 0;
+}
+
+} // namespace iborb::ast
@@ -0,0 +1,151 @@
+#ifndef IBORB_IDL_ARENA_HPP
+#define IBORB_IDL_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace iborb::ast {
+
+/**
+ * @brief Fixed-size array stored in an Arena
+ *
+ * A lightweight view that does not own its elements; the arena that
+ * allocated them does.
+ */
+template<typename T>
+class ArenaArray {
+public:
+    ArenaArray() = default;
+    ArenaArray(T* data, size_t size) : data_(data), size_(size) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t index) const { return data_[index]; }
+    T& front() const { return data_[0]; }
+    T& back() const { return data_[size_ - 1]; }
+
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Bump allocator that owns every node of a translation unit
+ *
+ * Objects are placed back to back in large blocks and are never freed
+ * one at a time. Destroying the arena releases all blocks at once;
+ * objects with non-trivial destructors are registered on creation and
+ * destroyed first, in reverse order of creation. Objects that are
+ * trivially destructible cost nothing to tear down.
+ *
+ * The arena is move-only. Moving it keeps all objects at their
+ * addresses, so pointers into it stay valid.
+ */
+class Arena {
+public:
+    Arena() = default;
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+
+    /**
+     * @brief Allocate uninitialized memory
+     * @param size Number of bytes
+     * @param align Required alignment, at most alignof(std::max_align_t)
+     */
+    void* allocate(size_t size, size_t align) {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+        if (cursor_ && static_cast<size_t>(end_ - cursor_) >= size + padding) {
+            void* result = cursor_ + padding;
+            cursor_ += size + padding;
+            return result;
+        }
+        return allocateSlow(size, align);
+    }
+
+    /**
+     * @brief Construct an object in the arena
+     * @return Pointer that stays valid for the lifetime of the arena
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            addFinalizer(object, [](void* p) { static_cast<T*>(p)->~T(); });
+        }
+        return object;
+    }
+
+    /**
+     * @brief Copy elements into a contiguous array in the arena
+     */
+    template<typename T>
+    ArenaArray<T> copyArray(const std::vector<T>& items) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "arena arrays hold plain values such as node pointers");
+        if (items.empty()) {
+            return {};
+        }
+        T* data = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+        std::uninitialized_copy(items.begin(), items.end(), data);
+        return {data, items.size()};
+    }
+
+    /**
+     * @brief Copy a string into the arena
+     */
+    std::string_view copyString(std::string_view text) {
+        if (text.empty()) {
+            return {};
+        }
+        char* data = static_cast<char*>(allocate(text.size(), 1));
+        std::copy(text.begin(), text.end(), data);
+        return {data, text.size()};
+    }
+
+    /**
+     * @brief Number of bytes reserved from the system, including unused block tails
+     */
+    size_t bytesReserved() const { return reserved_; }
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    Block* blocks_ = nullptr;          // Most recent first
+    Finalizer* finalizers_ = nullptr;  // Most recent first
+    size_t nextBlockSize_ = 0;
+    size_t reserved_ = 0;
+
+    void* allocateSlow(size_t size, size_t align);
+    void addFinalizer(void* object, void (*destroy)(void*));
+    void release();
+};
+
+} // namespace iborb::ast
+
+#endif // IBORB_IDL_ARENA_HPP
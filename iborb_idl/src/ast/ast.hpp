@@ -1,50 +1,193 @@
 #ifndef IBORB_IDL_AST_HPP
 #define IBORB_IDL_AST_HPP
 
+#include <cassert>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <optional>
+#include <unordered_set>
 #include <variant>
+#include "arena.hpp"
+#include "name.hpp"
 #include "visitor.hpp"
 
+namespace iborb::source {
+class SourceManager;
+}
+
 namespace iborb::ast {
 
 /**
- * @brief Source location information for error reporting
+ * @brief Compact source location for error reporting
+ *
+ * Identifies a SourceManager file entry and a byte offset into its
+ * buffer. Use source::SourceManager to obtain file name, line and column.
  */
 struct SourceLocation {
-    std::string filename;
-    size_t line = 1;
-    size_t column = 1;
+    uint32_t fileId = 0;  // 0 means "no location"
+    uint32_t offset = 0;
 
-    std::string toString() const {
-        return filename + ":" + std::to_string(line) + ":" + std::to_string(column);
-    }
+    bool isValid() const { return fileId != 0; }
+};
+
+/**
+ * @brief Concrete class of an AST node
+ *
+ * Type nodes come first and definition nodes form one contiguous range,
+ * so TypeNode and DefinitionNode are recognized with a range check.
+ */
+enum class NodeKind : uint8_t {
+    // Type nodes
+    BasicType,
+    SequenceType,
+    StringType,
+    ScopedName,
+    ArrayType,
+
+    // Definition nodes
+    Const,
+    Struct,
+    Enum,
+    Typedef,
+    Union,
+    Exception,
+    Operation,
+    Attribute,
+    Interface,
+    Module,
+
+    // Other nodes
+    StructMember,
+    UnionCase,
+    Parameter
 };
 
 /**
  * @brief Base class for all AST nodes
+ *
+ * Nodes are created in the Arena of their TranslationUnit and are
+ * destroyed with it, never individually, so the destructor is not
+ * virtual. The kind tag lets isa/cast/dyn_cast and StaticVisitor
+ * classify nodes without RTTI or virtual calls.
  */
 class ASTNode {
 public:
-    virtual ~ASTNode() = default;
     virtual void accept(ASTVisitor& visitor) = 0;
     virtual void accept(ConstASTVisitor& visitor) const = 0;
 
     SourceLocation location;
+    const NodeKind kind;
 
 protected:
-    ASTNode() = default;
-    explicit ASTNode(SourceLocation loc) : location(std::move(loc)) {}
+    explicit ASTNode(NodeKind nodeKind, SourceLocation loc = {})
+        : location(std::move(loc)), kind(nodeKind) {}
+    ~ASTNode() = default;
 };
 
-// Smart pointer type for AST nodes
+/**
+ * @brief Check whether a node is a T
+ *
+ * T provides classof(const ASTNode*), as every node class does.
+ */
+template<typename T>
+bool isa(const ASTNode* node) {
+    return T::classof(node);
+}
+
+/**
+ * @brief Downcast a node known to be a T
+ */
+template<typename T>
+T* cast(ASTNode* node) {
+    assert(isa<T>(node) && "cast to the wrong node class");
+    return static_cast<T*>(node);
+}
+
+template<typename T>
+const T* cast(const ASTNode* node) {
+    assert(isa<T>(node) && "cast to the wrong node class");
+    return static_cast<const T*>(node);
+}
+
+/**
+ * @brief Downcast a node if it is a T
+ * @return The node, or nullptr if it is not a T or is null
+ */
 template<typename T>
-using ASTPtr = std::unique_ptr<T>;
+T* dyn_cast(ASTNode* node) {
+    return node && isa<T>(node) ? static_cast<T*>(node) : nullptr;
+}
 
 template<typename T>
-using ASTList = std::vector<ASTPtr<T>>;
+const T* dyn_cast(const ASTNode* node) {
+    return node && isa<T>(node) ? static_cast<const T*>(node) : nullptr;
+}
+
+// Non-owning pointer to a node in the translation unit's arena
+template<typename T>
+using ASTPtr = T*;
+
+// Contiguous list of nodes in the translation unit's arena
+template<typename T>
+using ASTList = ArenaArray<ASTPtr<T>>;
+
+// ============================================================================
+// Constant Expressions
+// ============================================================================
+
+/**
+ * @brief Constant value types
+ */
+using ConstValue = std::variant<
+    int64_t,           // Integer constants
+    uint64_t,          // Unsigned integer constants
+    double,            // Floating point constants
+    std::string,       // String/char constants
+    bool               // Boolean constants
+>;
+
+/**
+ * @brief Literal in a constant expression; string literals live in the arena
+ */
+using ConstLiteral = std::variant<int64_t, double, std::string_view, bool>;
+
+/**
+ * @brief Constant expression as written in the source
+ *
+ * The parser keeps expressions unevaluated, since names in them can
+ * only be looked up once all symbols are known; semantic analysis
+ * folds them into ConstValues. Trivially destructible, so the arena
+ * has nothing to do for it on teardown.
+ */
+struct ConstExpr {
+    enum class Op {
+        Literal,
+        Name,        // Reference to a constant or enumerator
+        Negate,
+        Complement,
+        Or,
+        Xor,
+        And,
+        ShiftLeft,
+        ShiftRight,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo
+    };
+
+    Op op = Op::Literal;
+    bool isAbsolute = false;      // Op::Name
+    ConstLiteral literal;         // Op::Literal
+    ArenaArray<Name> parts;       // Op::Name
+    ASTPtr<ConstExpr> lhs = nullptr;  // Operand of unary operators
+    ASTPtr<ConstExpr> rhs = nullptr;
+    SourceLocation location;
+};
 
 // ============================================================================
 // Type Nodes
@@ -56,10 +199,15 @@ using ASTList = std::vector<ASTPtr<T>>;
 class TypeNode : public ASTNode {
 public:
     using ASTNode::ASTNode;
+
+    static bool classof(const ASTNode* node) {
+        return node->kind <= NodeKind::ArrayType;
+    }
     
-    // Returns the fully qualified C++ type name (set during semantic analysis)
-    std::string resolvedCppType;
-    std::string resolvedScope;  // Scope where this type is defined
+    // Set once by semantic::TypeResolver
+    Name resolvedCppType;  // C++ spelling of the type
+    Name resolvedScope;  // Scope where a named type is defined
+    Name typeId;  // Canonical IDL spelling, shared by identical types
 };
 
 /**
@@ -89,10 +237,11 @@ public:
     BasicType type;
 
     explicit BasicTypeNode(BasicType t, SourceLocation loc = {})
-        : TypeNode(std::move(loc)), type(t) {}
+        : TypeNode(NodeKind::BasicType, std::move(loc)), type(t) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::BasicType; }
 
     static std::string typeToString(BasicType t) {
         switch (t) {
@@ -123,15 +272,17 @@ public:
 class SequenceTypeNode : public TypeNode {
 public:
     ASTPtr<TypeNode> elementType;
-    std::optional<size_t> bound;  // Max size if bounded
+    ASTPtr<ConstExpr> boundExpr = nullptr;  // Null if unbounded
+    std::optional<size_t> bound;  // Max size if bounded, once folded
 
     explicit SequenceTypeNode(ASTPtr<TypeNode> elemType, 
                               std::optional<size_t> maxSize = std::nullopt,
                               SourceLocation loc = {})
-        : TypeNode(std::move(loc)), elementType(std::move(elemType)), bound(maxSize) {}
+        : TypeNode(NodeKind::SequenceType, std::move(loc)), elementType(std::move(elemType)), bound(maxSize) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::SequenceType; }
 };
 
 /**
@@ -139,16 +290,18 @@ public:
  */
 class StringTypeNode : public TypeNode {
 public:
-    std::optional<size_t> bound;  // Max length if bounded
+    ASTPtr<ConstExpr> boundExpr = nullptr;  // Null if unbounded
+    std::optional<size_t> bound;  // Max length if bounded, once folded
     bool isWide = false;  // true for wstring
 
     explicit StringTypeNode(std::optional<size_t> maxLen = std::nullopt,
                            bool wide = false,
                            SourceLocation loc = {})
-        : TypeNode(std::move(loc)), bound(maxLen), isWide(wide) {}
+        : TypeNode(NodeKind::StringType, std::move(loc)), bound(maxLen), isWide(wide) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::StringType; }
 };
 
 /**
@@ -156,26 +309,27 @@ public:
  */
 class ScopedNameNode : public TypeNode {
 public:
-    std::vector<std::string> parts;  // ["ModuleA", "StructB"]
+    std::vector<Name> parts;  // ["ModuleA", "StructB"]
     bool isAbsolute = false;  // true if starts with ::
 
-    explicit ScopedNameNode(std::vector<std::string> nameParts,
+    explicit ScopedNameNode(std::vector<Name> nameParts,
                            bool absolute = false,
                            SourceLocation loc = {})
-        : TypeNode(std::move(loc)), parts(std::move(nameParts)), isAbsolute(absolute) {}
+        : TypeNode(NodeKind::ScopedName, std::move(loc)), parts(std::move(nameParts)), isAbsolute(absolute) {}
 
     std::string toString() const {
         std::string result;
         if (isAbsolute) result = "::";
         for (size_t i = 0; i < parts.size(); ++i) {
             if (i > 0) result += "::";
-            result += parts[i];
+            result += parts[i].view();
         }
         return result;
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ScopedName; }
 };
 
 /**
@@ -184,15 +338,17 @@ public:
 class ArrayTypeNode : public TypeNode {
 public:
     ASTPtr<TypeNode> elementType;
-    std::vector<size_t> dimensions;
+    ASTList<ConstExpr> dimensionExprs;
+    std::vector<size_t> dimensions;  // Folded from dimensionExprs
 
-    ArrayTypeNode(ASTPtr<TypeNode> elemType, std::vector<size_t> dims,
+    ArrayTypeNode(ASTPtr<TypeNode> elemType, ASTList<ConstExpr> dims,
                   SourceLocation loc = {})
-        : TypeNode(std::move(loc)), elementType(std::move(elemType)), 
-          dimensions(std::move(dims)) {}
+        : TypeNode(NodeKind::ArrayType, std::move(loc)), elementType(std::move(elemType)), 
+          dimensionExprs(dims) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ArrayType; }
 };
 
 // ============================================================================
@@ -205,20 +361,14 @@ public:
 class DefinitionNode : public ASTNode {
 public:
     using ASTNode::ASTNode;
-    std::string name;
-    std::string fullyQualifiedName;  // Set during semantic analysis
-};
 
-/**
- * @brief Constant value types
- */
-using ConstValue = std::variant<
-    int64_t,           // Integer constants
-    uint64_t,          // Unsigned integer constants
-    double,            // Floating point constants
-    std::string,       // String/char constants
-    bool               // Boolean constants
->;
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::Const && node->kind <= NodeKind::Module;
+    }
+
+    Name name;
+    Name fullyQualifiedName;  // Set during semantic analysis
+};
 
 /**
  * @brief Constant declaration: const <type> <name> = <value>
@@ -226,16 +376,18 @@ using ConstValue = std::variant<
 class ConstNode : public DefinitionNode {
 public:
     ASTPtr<TypeNode> type;
-    ConstValue value;
+    ASTPtr<ConstExpr> expr;
+    ConstValue value;  // Folded from expr
 
-    ConstNode(std::string constName, ASTPtr<TypeNode> constType,
-              ConstValue val, SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)), type(std::move(constType)), value(std::move(val)) {
+    ConstNode(Name constName, ASTPtr<TypeNode> constType,
+              ASTPtr<ConstExpr> valueExpr, SourceLocation loc = {})
+        : DefinitionNode(NodeKind::Const, std::move(loc)), type(std::move(constType)), expr(valueExpr) {
         name = std::move(constName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Const; }
 };
 
 /**
@@ -244,15 +396,16 @@ public:
 class StructMemberNode : public ASTNode {
 public:
     ASTPtr<TypeNode> type;
-    std::string name;
+    Name name;
 
-    StructMemberNode(ASTPtr<TypeNode> memberType, std::string memberName,
+    StructMemberNode(ASTPtr<TypeNode> memberType, Name memberName,
                      SourceLocation loc = {})
-        : ASTNode(std::move(loc)), type(std::move(memberType)), 
+        : ASTNode(NodeKind::StructMember, std::move(loc)), type(std::move(memberType)), 
           name(std::move(memberName)) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::StructMember; }
 };
 
 /**
@@ -262,13 +415,14 @@ class StructNode : public DefinitionNode {
 public:
     ASTList<StructMemberNode> members;
 
-    explicit StructNode(std::string structName, SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)) {
+    explicit StructNode(Name structName, SourceLocation loc = {})
+        : DefinitionNode(NodeKind::Struct, std::move(loc)) {
         name = std::move(structName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Struct; }
 };
 
 /**
@@ -276,24 +430,26 @@ public:
  */
 class EnumNode : public DefinitionNode {
 public:
-    std::vector<std::string> enumerators;
+    std::vector<Name> enumerators;
 
-    EnumNode(std::string enumName, std::vector<std::string> values,
+    EnumNode(Name enumName, std::vector<Name> values,
              SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)), enumerators(std::move(values)) {
+        : DefinitionNode(NodeKind::Enum, std::move(loc)), enumerators(std::move(values)) {
         name = std::move(enumName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Enum; }
 };
 
 /**
  * @brief Typedef declarator with optional array dimensions
  */
 struct TypedefDeclarator {
-    std::string name;
-    std::vector<size_t> arrayDimensions;  // Empty for non-array typedefs
+    Name name;
+    ASTList<ConstExpr> dimensionExprs;
+    std::vector<size_t> arrayDimensions;  // Folded from dimensionExprs; empty for non-array typedefs
 };
 
 /**
@@ -306,7 +462,7 @@ public:
 
     TypedefNode(ASTPtr<TypeNode> origType, std::vector<TypedefDeclarator> decls,
                 SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)), originalType(std::move(origType)),
+        : DefinitionNode(NodeKind::Typedef, std::move(loc)), originalType(std::move(origType)),
           declarators(std::move(decls)) {
         if (!declarators.empty()) {
             name = declarators[0].name;
@@ -315,6 +471,7 @@ public:
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Typedef; }
 };
 
 /**
@@ -322,7 +479,8 @@ public:
  */
 struct CaseLabel {
     bool isDefault = false;
-    ConstValue value;
+    ASTPtr<ConstExpr> expr = nullptr;
+    ConstValue value;  // Folded from expr
 };
 
 /**
@@ -332,15 +490,16 @@ class UnionCaseNode : public ASTNode {
 public:
     std::vector<CaseLabel> labels;
     ASTPtr<TypeNode> type;
-    std::string name;
+    Name name;
 
     UnionCaseNode(std::vector<CaseLabel> caseLabels, ASTPtr<TypeNode> memberType,
-                  std::string memberName, SourceLocation loc = {})
-        : ASTNode(std::move(loc)), labels(std::move(caseLabels)),
+                  Name memberName, SourceLocation loc = {})
+        : ASTNode(NodeKind::UnionCase, std::move(loc)), labels(std::move(caseLabels)),
           type(std::move(memberType)), name(std::move(memberName)) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::UnionCase; }
 };
 
 /**
@@ -351,14 +510,15 @@ public:
     ASTPtr<TypeNode> discriminatorType;
     ASTList<UnionCaseNode> cases;
 
-    UnionNode(std::string unionName, ASTPtr<TypeNode> discType,
+    UnionNode(Name unionName, ASTPtr<TypeNode> discType,
               SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)), discriminatorType(std::move(discType)) {
+        : DefinitionNode(NodeKind::Union, std::move(loc)), discriminatorType(std::move(discType)) {
         name = std::move(unionName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Union; }
 };
 
 /**
@@ -368,13 +528,14 @@ class ExceptionNode : public DefinitionNode {
 public:
     ASTList<StructMemberNode> members;
 
-    explicit ExceptionNode(std::string excName, SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)) {
+    explicit ExceptionNode(Name excName, SourceLocation loc = {})
+        : DefinitionNode(NodeKind::Exception, std::move(loc)) {
         name = std::move(excName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Exception; }
 };
 
 /**
@@ -393,15 +554,16 @@ class ParameterNode : public ASTNode {
 public:
     ParamDirection direction;
     ASTPtr<TypeNode> type;
-    std::string name;
+    Name name;
 
     ParameterNode(ParamDirection dir, ASTPtr<TypeNode> paramType,
-                  std::string paramName, SourceLocation loc = {})
-        : ASTNode(std::move(loc)), direction(dir), type(std::move(paramType)),
+                  Name paramName, SourceLocation loc = {})
+        : ASTNode(NodeKind::Parameter, std::move(loc)), direction(dir), type(std::move(paramType)),
           name(std::move(paramName)) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Parameter; }
 };
 
 /**
@@ -414,14 +576,15 @@ public:
     std::vector<std::string> raises;  // Exception names
     bool isOneway = false;
 
-    OperationNode(std::string opName, ASTPtr<TypeNode> retType,
+    OperationNode(Name opName, ASTPtr<TypeNode> retType,
                   SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)), returnType(std::move(retType)) {
+        : DefinitionNode(NodeKind::Operation, std::move(loc)), returnType(std::move(retType)) {
         name = std::move(opName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Operation; }
 };
 
 /**
@@ -432,15 +595,16 @@ public:
     ASTPtr<TypeNode> type;
     bool isReadonly = false;
 
-    AttributeNode(std::string attrName, ASTPtr<TypeNode> attrType,
+    AttributeNode(Name attrName, ASTPtr<TypeNode> attrType,
                   bool readonly = false, SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)), type(std::move(attrType)), 
+        : DefinitionNode(NodeKind::Attribute, std::move(loc)), type(std::move(attrType)), 
           isReadonly(readonly) {
         name = std::move(attrName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Attribute; }
 };
 
 /**
@@ -454,13 +618,14 @@ public:
     bool isLocal = false;
     bool isForward = false;  // Forward declaration only
 
-    explicit InterfaceNode(std::string ifaceName, SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)) {
+    explicit InterfaceNode(Name ifaceName, SourceLocation loc = {})
+        : DefinitionNode(NodeKind::Interface, std::move(loc)) {
         name = std::move(ifaceName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Interface; }
 };
 
 /**
@@ -470,13 +635,24 @@ class ModuleNode : public DefinitionNode {
 public:
     ASTList<DefinitionNode> definitions;
 
-    explicit ModuleNode(std::string modName, SourceLocation loc = {})
-        : DefinitionNode(std::move(loc)) {
+    explicit ModuleNode(Name modName, SourceLocation loc = {})
+        : DefinitionNode(NodeKind::Module, std::move(loc)) {
         name = std::move(modName);
     }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
     void accept(ConstASTVisitor& visitor) const override { visitor.visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Module; }
+};
+
+class TranslationUnit;
+
+/**
+ * @brief An included file whose definitions were parsed once and are shared
+ */
+struct ImportedUnit {
+    std::shared_ptr<const TranslationUnit> unit;
+    size_t position = 0;  // Index into definitions that the include precedes
 };
 
 /**
@@ -484,18 +660,55 @@ public:
  */
 class TranslationUnit {
 public:
-    ASTList<DefinitionNode> definitions;
+    Arena arena;  // Owns every node of this unit; declared first so it is destroyed last
+    ASTList<DefinitionNode> definitions;  // Parsed from this unit's own tokens
+    std::vector<ImportedUnit> imports;    // Shared headers, in include order
     std::string filename;
+    std::shared_ptr<const source::SourceManager> sourceManager;  // Resolves node locations
+
+    /**
+     * @brief Visit imported and own definitions in source order
+     * @param fn Called as fn(owningUnit, definition)
+     *
+     * A unit imported more than once, directly or through other imports,
+     * is only visited at its first position, as if it were a guarded
+     * file included textually.
+     */
+    template<typename Fn>
+    void forEachDefinition(Fn&& fn) const {
+        std::unordered_set<const TranslationUnit*> visited;
+        forEachDefinition(fn, visited);
+    }
 
     void accept(ASTVisitor& visitor) {
-        for (auto& def : definitions) {
-            def->accept(visitor);
-        }
+        forEachDefinition([&](const TranslationUnit&, DefinitionNode& def) {
+            def.accept(visitor);
+        });
     }
 
     void accept(ConstASTVisitor& visitor) const {
-        for (const auto& def : definitions) {
-            def->accept(visitor);
+        forEachDefinition([&](const TranslationUnit&, const DefinitionNode& def) {
+            def.accept(visitor);
+        });
+    }
+
+    /**
+     * @brief Continue a walk that spans several units
+     * @param visited Imported units already visited; updated by the walk
+     */
+    template<typename Fn>
+    void forEachDefinition(Fn& fn, std::unordered_set<const TranslationUnit*>& visited) const {
+        size_t next = 0;
+        for (size_t i = 0; i <= definitions.size(); ++i) {
+            for (; next < imports.size() && imports[next].position == i; ++next) {
+                const TranslationUnit* imported = imports[next].unit.get();
+                if (visited.insert(imported).second) {
+                    imported->forEachDefinition(fn, visited);
+                }
+            }
+            if (i < definitions.size()) {
+                fn(*this, *definitions[i]);
+            }
         }
     }
 };
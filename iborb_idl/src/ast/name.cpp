@@ -0,0 +1,108 @@
+#include "ast/name.hpp"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace iborb::ast {
+
+namespace {
+
+// Workers parse in parallel; spreading names over shards keeps them
+// from contending on a single lock
+constexpr size_t kShardCount = 16;
+
+/**
+ * @brief Slot of a shard's table: the full hash is kept next to the
+ * text so that most probes are settled without touching the text
+ */
+struct Slot {
+    size_t hash = 0;
+    const std::string* text = nullptr;
+};
+
+struct Shard {
+    std::shared_mutex mutex;
+    std::deque<std::string> texts;  // Stable storage for the slots' texts
+    std::vector<Slot> slots = std::vector<Slot>(1024);  // Open addressing, at most half full
+
+    const std::string* find(std::string_view text, size_t hash) const {
+        size_t mask = slots.size() - 1;
+        for (size_t i = (hash >> 4) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (!slot.text) {
+                return nullptr;
+            }
+            if (slot.hash == hash && *slot.text == text) {
+                return slot.text;
+            }
+        }
+    }
+
+    void insert(const std::string* text, size_t hash) {
+        if ((texts.size() + 1) * 2 > slots.size()) {
+            std::vector<Slot> old(slots.size() * 2);
+            old.swap(slots);
+            for (const Slot& slot : old) {
+                if (slot.text) {
+                    place(slot);
+                }
+            }
+        }
+        place({hash, text});
+    }
+
+    void place(const Slot& entry) {
+        size_t mask = slots.size() - 1;
+        size_t i = (entry.hash >> 4) & mask;
+        while (slots[i].text) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = entry;
+    }
+};
+
+Shard& shardFor(size_t hash) {
+    // Never destroyed, so names stay valid during static destruction
+    static Shard* shards = new Shard[kShardCount];
+    return shards[hash % kShardCount];
+}
+
+} // anonymous namespace
+
+Name Name::intern(std::string_view text) {
+    if (text.empty()) {
+        return Name();
+    }
+
+    size_t hash = std::hash<std::string_view>()(text);
+    Shard& shard = shardFor(hash);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (const std::string* found = shard.find(text, hash)) {
+            return Name(found);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (const std::string* found = shard.find(text, hash)) {
+        return Name(found);
+    }
+    const std::string& stored = shard.texts.emplace_back(text);
+    shard.insert(&stored, hash);
+    return Name(&stored);
+}
+
+Name Name::find(std::string_view text) {
+    if (text.empty()) {
+        return Name();
+    }
+
+    size_t hash = std::hash<std::string_view>()(text);
+    Shard& shard = shardFor(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    const std::string* found = shard.find(text, hash);
+    return found ? Name(found) : Name();
+}
+
+} // namespace iborb::ast
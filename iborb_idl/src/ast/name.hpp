@@ -0,0 +1,66 @@
+#ifndef IBORB_IDL_NAME_HPP
+#define IBORB_IDL_NAME_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace iborb::ast {
+
+// Text of the empty name, shared so that a default Name is always valid
+inline const std::string kEmptyNameText;
+
+/**
+ * @brief Interned identifier or qualified name
+ *
+ * Every distinct spelling is stored once for the lifetime of the
+ * process, so a Name is a single pointer. Names compare and hash by
+ * address; equal spellings always yield the same handle, including
+ * across threads and translation units.
+ */
+class Name {
+public:
+    Name() = default;
+
+    /**
+     * @brief Get the handle for a spelling, interning it on first use
+     *
+     * Safe to call from several threads at once.
+     */
+    static Name intern(std::string_view text);
+
+    /**
+     * @brief Get the handle for a spelling without interning it
+     * @return The empty name if the spelling was never interned
+     */
+    static Name find(std::string_view text);
+
+    const std::string& str() const { return *text_; }
+    std::string_view view() const { return *text_; }
+    bool empty() const { return text_->empty(); }
+    size_t size() const { return text_->size(); }
+
+    bool operator==(Name other) const { return text_ == other.text_; }
+    bool operator!=(Name other) const { return text_ != other.text_; }
+
+    size_t hash() const { return std::hash<const void*>()(text_); }
+
+private:
+    explicit Name(const std::string* text) : text_(text) {}
+
+    const std::string* text_ = &kEmptyNameText;
+};
+
+} // namespace iborb::ast
+
+namespace std {
+
+template<>
+struct hash<iborb::ast::Name> {
+    size_t operator()(iborb::ast::Name name) const { return name.hash(); }
+};
+
+} // namespace std
+
+#endif // IBORB_IDL_NAME_HPP
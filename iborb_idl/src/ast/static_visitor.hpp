@@ -0,0 +1,54 @@
+#ifndef IBORB_IDL_STATIC_VISITOR_HPP
+#define IBORB_IDL_STATIC_VISITOR_HPP
+
+#include "ast/ast.hpp"
+
+namespace iborb::ast {
+
+/**
+ * @brief Visitor dispatched on NodeKind instead of virtual calls
+ *
+ * Derived (CRTP) provides a visit() overload for every node class.
+ * dispatch() switches on the node's kind and calls the overload
+ * directly, so hot traversals pay neither an indirect call per node
+ * nor the accept() round trip, and the visits can be inlined.
+ *
+ * Use ASTVisitor where the visitor itself has to be chosen at run time.
+ */
+template<typename Derived, typename Result = void>
+class StaticVisitor {
+public:
+    Result dispatch(ASTNode& node) {
+        auto& self = static_cast<Derived&>(*this);
+        switch (node.kind) {
+            case NodeKind::BasicType:    return self.visit(static_cast<BasicTypeNode&>(node));
+            case NodeKind::SequenceType: return self.visit(static_cast<SequenceTypeNode&>(node));
+            case NodeKind::StringType:   return self.visit(static_cast<StringTypeNode&>(node));
+            case NodeKind::ScopedName:   return self.visit(static_cast<ScopedNameNode&>(node));
+            case NodeKind::ArrayType:    return self.visit(static_cast<ArrayTypeNode&>(node));
+            case NodeKind::Const:        return self.visit(static_cast<ConstNode&>(node));
+            case NodeKind::Struct:       return self.visit(static_cast<StructNode&>(node));
+            case NodeKind::Enum:         return self.visit(static_cast<EnumNode&>(node));
+            case NodeKind::Typedef:      return self.visit(static_cast<TypedefNode&>(node));
+            case NodeKind::Union:        return self.visit(static_cast<UnionNode&>(node));
+            case NodeKind::Exception:    return self.visit(static_cast<ExceptionNode&>(node));
+            case NodeKind::Operation:    return self.visit(static_cast<OperationNode&>(node));
+            case NodeKind::Attribute:    return self.visit(static_cast<AttributeNode&>(node));
+            case NodeKind::Interface:    return self.visit(static_cast<InterfaceNode&>(node));
+            case NodeKind::Module:       return self.visit(static_cast<ModuleNode&>(node));
+            case NodeKind::StructMember: return self.visit(static_cast<StructMemberNode&>(node));
+            case NodeKind::UnionCase:    return self.visit(static_cast<UnionCaseNode&>(node));
+            case NodeKind::Parameter:    return self.visit(static_cast<ParameterNode&>(node));
+        }
+        assert(false && "unknown node kind");
+        return Result();
+    }
+
+protected:
+    StaticVisitor() = default;
+    ~StaticVisitor() = default;
+};
+
+} // namespace iborb::ast
+
+#endif // IBORB_IDL_STATIC_VISITOR_HPP
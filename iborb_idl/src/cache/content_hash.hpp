@@ -0,0 +1,73 @@
+#ifndef IBORB_IDL_CONTENT_HASH_HPP
+#define IBORB_IDL_CONTENT_HASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace iborb::cache {
+
+namespace detail {
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t finalize(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace detail
+
+/**
+ * @brief Hash bytes eight at a time, continuing from a previous hash
+ *
+ * One lane of MurmurHash3's 64-bit mixing: fast enough that hashing a
+ * preprocessed input costs a small fraction of parsing it. Not meant to
+ * resist deliberate collisions.
+ */
+inline uint64_t hashBytes(std::string_view data, uint64_t seed) {
+    constexpr uint64_t c1 = 0x87C37B91114253D5ull;
+    constexpr uint64_t c2 = 0x4CF5AD432745937Full;
+    uint64_t h = seed ^ data.size();
+
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, sizeof(word));
+        h ^= detail::rotateLeft(word * c1, 31) * c2;
+        h = detail::rotateLeft(h, 27) * 5 + 0x52DCE729;
+    }
+
+    uint64_t tail = 0;
+    if (i < data.size()) {
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+    }
+    h ^= detail::rotateLeft(tail * c1, 31) * c2;
+    return detail::finalize(h);
+}
+
+/**
+ * @brief Hash the content of a file an input was generated from
+ */
+inline uint64_t hashFileContent(std::string_view data) {
+    return hashBytes(data, 0);
+}
+
+/**
+ * @brief Hash of a file's content as it was read, not as it is now
+ */
+struct FileHash {
+    std::string filename;  // As named by the line markers of the preprocessed output
+    uint64_t hash = 0;
+};
+
+} // namespace iborb::cache
+
+#endif // IBORB_IDL_CONTENT_HASH_HPP
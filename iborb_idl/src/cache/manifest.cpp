@@ -0,0 +1,258 @@
+#include "cache/manifest.hpp"
+#include "cache/content_hash.hpp"
+#include "generator/output_file.hpp"
+#include "source/source_buffer.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace iborb::cache {
+
+namespace {
+
+constexpr std::string_view kHeader = "iborb_idl manifest ";
+
+// Coarser than the timestamps of any common file system
+constexpr auto kTimestampSlack = std::chrono::seconds(2);
+
+bool hasNewline(const std::string& path) {
+    return path.find('\n') != std::string::npos;
+}
+
+} // anonymous namespace
+
+Manifest::Manifest(const std::string& directory, std::string_view settings)
+    : path_((std::filesystem::path(directory) / kFilename).string()),
+      settings_(hashBytes(settings, kFormatVersion)) {
+    load();
+}
+
+bool Manifest::isUpToDate(const std::string& input, std::vector<std::string>& dependencies,
+                          std::vector<std::string>& outputs) {
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(input);
+        if (it == entries_.end() || it->second.settings != settings_) {
+            return false;
+        }
+        entry = it->second;
+    }
+
+    // Unchanged content with a new timestamp is recorded, so the next
+    // run does not hash the file again
+    bool refreshed = false;
+    for (auto& dependency : entry.dependencies) {
+        FileRecord now(dependency.path);
+        if (!stat(now) || now.size != dependency.size) {
+            return false;
+        }
+        if (now.modified != dependency.modified) {
+            if (contentHash(dependency.path) != dependency.hash) {
+                return false;
+            }
+            dependency.modified = settledTime(now.modified);
+            refreshed = true;
+        }
+    }
+    for (const auto& output : entry.outputs) {
+        FileRecord now(output.path);
+        if (!stat(now) || now.size != output.size || now.modified != output.modified) {
+            return false;
+        }
+    }
+
+    dependencies.clear();
+    for (const auto& dependency : entry.dependencies) {
+        dependencies.push_back(dependency.path);
+    }
+    outputs.clear();
+    for (const auto& output : entry.outputs) {
+        outputs.push_back(output.path);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++skipped_;
+    if (refreshed) {
+        entries_[input] = std::move(entry);
+        changed_ = true;
+    }
+    return true;
+}
+
+void Manifest::record(const std::string& input, const std::vector<std::string>& dependencies,
+                      const std::vector<FileHash>& fileHashes, const std::vector<std::string>& outputs) {
+    if (hasNewline(input)) {
+        return;
+    }
+
+    // Dependencies are named like the line markers, without "." and ".."
+    std::unordered_map<std::string, uint64_t> hashes;
+    for (const auto& file : fileHashes) {
+        std::string path = std::filesystem::path(file.filename).lexically_normal().string();
+        auto [it, inserted] = hashes.emplace(std::move(path), file.hash);
+        if (!inserted && it->second != file.hash) {
+            forget(input);
+            return;
+        }
+    }
+
+    Entry entry;
+    entry.settings = settings_;
+    for (const auto& path : dependencies) {
+        FileRecord record(path);
+        auto hash = hashes.find(path);
+        if (hasNewline(path) || hash == hashes.end() || !stat(record)) {
+            forget(input);
+            return;
+        }
+        record.hash = hash->second;
+        record.modified = settledTime(record.modified);
+        entry.dependencies.push_back(std::move(record));
+    }
+    for (const auto& path : outputs) {
+        FileRecord record(path);
+        if (hasNewline(path) || !stat(record)) {
+            forget(input);
+            return;
+        }
+        entry.outputs.push_back(std::move(record));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[input] = std::move(entry);
+    changed_ = true;
+}
+
+void Manifest::forget(const std::string& input) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.erase(input) > 0) {
+        changed_ = true;
+    }
+}
+
+bool Manifest::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!changed_) {
+        return true;
+    }
+
+    std::ostringstream text;
+    text << kHeader << kFormatVersion << '\n';
+    for (const auto& [input, entry] : entries_) {
+        text << "input " << input << '\n'
+             << "settings " << std::hex << entry.settings << std::dec << '\n';
+        for (const auto& file : entry.dependencies) {
+            text << "dep " << file.size << ' ' << file.modified << ' ' << std::hex << file.hash
+                 << std::dec << ' ' << file.path << '\n';
+        }
+        for (const auto& file : entry.outputs) {
+            text << "out " << file.size << ' ' << file.modified << ' ' << file.path << '\n';
+        }
+    }
+
+    generator::OutputFile file(path_);
+    file.write(text.str());
+    if (!file.commit()) {
+        return false;
+    }
+    changed_ = false;
+    return true;
+}
+
+size_t Manifest::skipped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return skipped_;
+}
+
+void Manifest::load() {
+    std::ifstream file(path_);
+    std::string line;
+    if (!std::getline(file, line) || line != std::string(kHeader) + std::to_string(kFormatVersion)) {
+        return;
+    }
+
+    // Anything malformed discards the whole manifest, which only costs a full run
+    Entry* entry = nullptr;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        fields.get();  // The separating space
+
+        if (kind == "input") {
+            std::string input;
+            std::getline(fields, input);
+            entry = &entries_[input];
+            continue;
+        }
+        if (!entry) {
+            entries_.clear();
+            return;
+        }
+
+        FileRecord record;
+        bool valid = true;
+        if (kind == "settings") {
+            valid = static_cast<bool>(fields >> std::hex >> entry->settings);
+        } else if (kind == "dep") {
+            valid = static_cast<bool>(fields >> record.size >> record.modified >> std::hex >>
+                                      record.hash);
+        } else if (kind == "out") {
+            valid = static_cast<bool>(fields >> record.size >> record.modified);
+        } else {
+            valid = false;
+        }
+        if (valid && kind != "settings") {
+            fields.get();
+            valid = static_cast<bool>(std::getline(fields, record.path)) && !record.path.empty();
+            (kind == "dep" ? entry->dependencies : entry->outputs).push_back(std::move(record));
+        }
+        if (!valid) {
+            entries_.clear();
+            return;
+        }
+    }
+}
+
+uint64_t Manifest::contentHash(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = hashes_.find(path);
+        if (it != hashes_.end()) {
+            return it->second;
+        }
+    }
+
+    uint64_t hash = 0;
+    try {
+        hash = hashFileContent(source::SourceBuffer::fromFile(path)->data());
+    } catch (const std::exception&) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    hashes_.emplace(path, hash);
+    return hash;
+}
+
+bool Manifest::stat(FileRecord& record) {
+    std::error_code ec;
+    record.size = std::filesystem::file_size(record.path, ec);
+    if (ec) {
+        return false;
+    }
+    record.modified = std::filesystem::last_write_time(record.path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+int64_t Manifest::settledTime(int64_t modified) {
+    using Duration = std::filesystem::file_time_type::duration;
+    auto settled = std::filesystem::file_time_type::clock::now() - kTimestampSlack;
+    return modified > std::chrono::duration_cast<Duration>(settled.time_since_epoch()).count()
+               ? 0
+               : modified;
+}
+
+} // namespace iborb::cache
@@ -0,0 +1,131 @@
+#ifndef IBORB_IDL_MANIFEST_HPP
+#define IBORB_IDL_MANIFEST_HPP
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "cache/content_hash.hpp"
+
+namespace iborb::cache {
+
+/**
+ * @brief What earlier runs generated into an output directory, and from what
+ *
+ * For every input it records a hash of the settings, the size,
+ * modification time and content hash of every file the input read, and
+ * the size and modification time of every file generated from it. An
+ * input is up to date when the settings match, every file it read has
+ * the recorded content, and every generated file is still as written.
+ * Such an input need not be preprocessed, parsed or generated at all.
+ * The hashes recorded are those of the content the input was generated
+ * from, captured when the files were read, so a file edited while the
+ * input was being compiled makes it out of date.
+ *
+ * Checking a file compares its size and modification time first and
+ * only hashes its content when they differ, so touching a file without
+ * changing it does not make its dependents out of date, and a run
+ * where nothing changed reads no input at all.
+ *
+ * Entries of inputs not compiled in a run are kept, so several
+ * invocations can share an output directory. The file is replaced
+ * atomically; when invocations race, one's entries may be lost, which
+ * only costs a regeneration, since a lost or stale entry never matches
+ * the files on disk.
+ */
+class Manifest {
+public:
+    static constexpr std::string_view kFilename = ".iborb_idl.manifest";
+
+    /**
+     * @brief Load the manifest of a directory; a missing or unreadable one is empty
+     * @param settings Everything besides the files read that the outputs depend on
+     */
+    Manifest(const std::string& directory, std::string_view settings);
+
+    /**
+     * @brief Check whether an input can be skipped
+     * @param dependencies Receives the files it read, if it is up to date
+     * @param outputs Receives the files generated from it, if it is up to date
+     */
+    bool isUpToDate(const std::string& input, std::vector<std::string>& dependencies,
+                    std::vector<std::string>& outputs);
+
+    /**
+     * @brief Record an input that was generated successfully
+     * @param fileHashes Content of the files read, as they were read
+     *
+     * An input with a dependency whose content was not captured, or was
+     * read twice with different content, is not recorded.
+     */
+    void record(const std::string& input, const std::vector<std::string>& dependencies,
+                const std::vector<FileHash>& fileHashes, const std::vector<std::string>& outputs);
+
+    /**
+     * @brief Drop the entry of an input that failed
+     */
+    void forget(const std::string& input);
+
+    /**
+     * @brief Write the manifest if it changed
+     * @return false if it could not be written
+     */
+    bool save();
+
+    /**
+     * @brief Number of inputs found up to date
+     */
+    size_t skipped() const;
+
+private:
+    static constexpr uint32_t kFormatVersion = 2;
+
+    struct FileRecord {
+        std::string path;
+        uint64_t size = 0;
+        int64_t modified = 0;  // Ticks of std::filesystem::file_time_type
+        uint64_t hash = 0;     // Content hash; not kept for outputs
+
+        FileRecord() = default;
+        explicit FileRecord(std::string file) : path(std::move(file)) {}
+    };
+
+    struct Entry {
+        uint64_t settings = 0;
+        std::vector<FileRecord> dependencies;
+        std::vector<FileRecord> outputs;
+    };
+
+    std::string path_;
+    uint64_t settings_;
+    mutable std::mutex mutex_;  // Guards everything below
+    std::map<std::string, Entry> entries_;  // Ordered, so the file does not depend on scheduling
+    std::unordered_map<std::string, uint64_t> hashes_;  // Content hashes computed by this run
+    bool changed_ = false;
+    size_t skipped_ = 0;
+
+    void load();
+    uint64_t contentHash(const std::string& path);
+
+    /**
+     * @brief Read the size and modification time of a file
+     * @return false if the file does not exist
+     */
+    static bool stat(FileRecord& record);
+
+    /**
+     * @brief The modification time to record for a dependency
+     *
+     * A file modified within the last moments may change again without
+     * its time changing. Its time is recorded as 0 instead, so that the
+     * next check compares its content.
+     */
+    static int64_t settledTime(int64_t modified);
+};
+
+} // namespace iborb::cache
+
+#endif // IBORB_IDL_MANIFEST_HPP
@@ -0,0 +1,65 @@
+#include "cache/unit_cache.hpp"
+#include "cache/content_hash.hpp"
+#include "generator/output_file.hpp"
+#include "source/source_buffer.hpp"
+#include "source/source_manager.hpp"
+#include <cstdio>
+#include <filesystem>
+
+namespace iborb::cache {
+
+UnitCache::UnitCache(std::string directory, std::string settings)
+    : directory_(std::move(directory)), settings_(std::move(settings)) {
+}
+
+uint64_t UnitCache::computeKey(std::string_view filename, std::string_view source) const {
+    uint64_t key = hashBytes(settings_, kFormatVersion);
+    key = hashBytes(filename, key);
+    return hashBytes(source, key);
+}
+
+std::unique_ptr<CachedUnit> UnitCache::load(uint64_t key,
+                                            std::unique_ptr<source::SourceBuffer>& source) {
+    std::unique_ptr<source::SourceBuffer> file;
+    try {
+        file = source::SourceBuffer::fromFile(pathFor(key));
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+
+    auto unit = deserializeUnit(file->data(), key, source);
+    if (unit) {
+        ++hits_;
+    }
+    return unit;
+}
+
+bool UnitCache::store(uint64_t key, const ast::TranslationUnit& unit,
+                      const semantic::SymbolTable& symbols, uint64_t sourceSize) {
+    if (!unit.imports.empty() || !unit.sourceManager ||
+        unit.sourceManager->getBufferCount() != 1) {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        return false;
+    }
+
+    generator::OutputFile file(pathFor(key));
+    file.write(serializeUnit(unit, symbols, key, sourceSize));
+    if (!file.commit()) {
+        return false;
+    }
+    ++stores_;
+    return true;
+}
+
+std::string UnitCache::pathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ipch", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+} // namespace iborb::cache
@@ -0,0 +1,78 @@
+#ifndef IBORB_IDL_UNIT_CACHE_HPP
+#define IBORB_IDL_UNIT_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "cache/unit_format.hpp"
+
+namespace iborb::cache {
+
+/**
+ * @brief Analyzed units kept in a directory across compiler runs
+ *
+ * A unit is looked up by a key hashed from the exact text handed to the
+ * parser, the name of the input and the preprocessor settings. After
+ * preprocessing, the text already contains every included file, so an
+ * edit anywhere the input depends on yields a different key; stale
+ * files are never consulted, only left behind.
+ *
+ * Only units that parse and analyze without any diagnostic are stored,
+ * so loading one never hides a warning. Files are replaced atomically,
+ * so several compiler processes can share a directory.
+ */
+class UnitCache {
+public:
+    /**
+     * @param directory Where the units are stored; created when the first is stored
+     * @param settings Preprocessor settings that take part in every key
+     */
+    UnitCache(std::string directory, std::string settings);
+
+    /**
+     * @brief Compute the key of an input
+     * @param filename Name the input was given as
+     * @param source Text handed to the parser
+     */
+    uint64_t computeKey(std::string_view filename, std::string_view source) const;
+
+    /**
+     * @brief Load a stored unit
+     * @param source Buffer the key was computed from; taken only if the unit is loaded
+     * @return The unit, or nullptr if none is stored for the key
+     */
+    std::unique_ptr<CachedUnit> load(uint64_t key,
+                                     std::unique_ptr<source::SourceBuffer>& source);
+
+    /**
+     * @brief Store an analyzed unit that has no imports
+     * @param sourceSize Size of the buffer the key was computed from
+     * @return true if the unit was written
+     */
+    bool store(uint64_t key, const ast::TranslationUnit& unit,
+               const semantic::SymbolTable& symbols, uint64_t sourceSize);
+
+    /**
+     * @brief Number of units loaded
+     */
+    size_t hits() const { return hits_; }
+
+    /**
+     * @brief Number of units stored
+     */
+    size_t stores() const { return stores_; }
+
+private:
+    std::string directory_;
+    std::string settings_;
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> stores_{0};
+
+    std::string pathFor(uint64_t key) const;
+};
+
+} // namespace iborb::cache
+
+#endif // IBORB_IDL_UNIT_CACHE_HPP
@@ -0,0 +1,834 @@
+#include "cache/unit_format.hpp"
+#include "source/source_buffer.hpp"
+#include "source/source_manager.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace iborb::cache {
+
+using namespace ast;
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'B', 'O', 'R', 'B', 'P', 'C', 'H'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr uint8_t kNullNode = 0xFF;
+constexpr uint32_t kNoNode = 0xFFFFFFFF;
+
+/**
+ * @brief Fixed-size start of an encoded unit
+ */
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t key;
+    uint64_t sourceSize;
+    uint32_t stringCount;
+    uint32_t nodeCount;
+    uint64_t stringsOffset;  // Index of (offset, length) pairs into the string data
+    uint64_t stringDataOffset;
+    uint64_t treeOffset;
+    uint64_t treeSize;
+};
+
+/**
+ * @brief Position of a string in the string data
+ */
+struct StringEntry {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * @brief Thrown when encoded data is truncated or inconsistent
+ */
+class FormatError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+class Writer {
+public:
+    std::string encode(const TranslationUnit& unit, const semantic::SymbolTable& symbols,
+                       uint64_t key, uint64_t sourceSize) {
+        const source::SourceManager& sourceManager = *unit.sourceManager;
+        string(sourceManager.getFilename(SourceLocation{1, 0}));
+        auto markers = sourceManager.getLineMarkers();
+        u32(static_cast<uint32_t>(markers.size()));
+        for (const auto& marker : markers) {
+            string(marker.filename);
+            u32(marker.offset);
+            u32(marker.line);
+        }
+
+        string(unit.filename);
+        list(unit.definitions);
+        scope(*symbols.getGlobalScope());
+
+        // Lay out the file: header, string index, string data, tree
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kFormatVersion;
+        header.byteOrder = kByteOrderMark;
+        header.key = key;
+        header.sourceSize = sourceSize;
+        header.stringCount = static_cast<uint32_t>(strings_.size());
+        header.nodeCount = nodeCount_;
+        header.stringsOffset = sizeof(FileHeader);
+        header.stringDataOffset = header.stringsOffset + strings_.size() * sizeof(StringEntry);
+
+        std::vector<StringEntry> index;
+        index.reserve(strings_.size());
+        uint64_t dataSize = 0;
+        for (std::string_view text : strings_) {
+            index.push_back({static_cast<uint32_t>(dataSize), static_cast<uint32_t>(text.size())});
+            dataSize += text.size();
+        }
+        header.treeOffset = header.stringDataOffset + dataSize;
+        header.treeSize = tree_.size();
+
+        std::string result;
+        result.reserve(header.treeOffset + tree_.size());
+        result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        result.append(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(StringEntry));
+        for (std::string_view text : strings_) {
+            result.append(text);
+        }
+        result.append(tree_);
+        return result;
+    }
+
+private:
+    std::string tree_;
+    std::vector<std::string_view> strings_;  // Views of names, arena strings and node fields
+    std::unordered_map<std::string_view, uint32_t> stringIds_;
+    std::unordered_map<const ASTNode*, uint32_t> nodeIds_;  // For symbols that refer to nodes
+    uint32_t nodeCount_ = 0;
+
+    template<typename T>
+    void raw(T value) {
+        tree_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void u8(uint8_t value) { tree_.push_back(static_cast<char>(value)); }
+    void u32(uint32_t value) { raw(value); }
+    void u64(uint64_t value) { raw(value); }
+
+    void string(std::string_view text) {
+        auto [it, inserted] = stringIds_.try_emplace(text, static_cast<uint32_t>(strings_.size()));
+        if (inserted) {
+            strings_.push_back(text);
+        }
+        u32(it->second);
+    }
+
+    void name(Name value) { string(value.view()); }
+
+    void location(SourceLocation loc) {
+        u32(loc.fileId);
+        u32(loc.offset);
+    }
+
+    void optionalSize(const std::optional<size_t>& value) {
+        u8(value.has_value());
+        u64(value.value_or(0));
+    }
+
+    void sizes(const std::vector<size_t>& values) {
+        u32(static_cast<uint32_t>(values.size()));
+        for (size_t value : values) {
+            u64(value);
+        }
+    }
+
+    void strings(const std::vector<std::string>& values) {
+        u32(static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) {
+            string(value);
+        }
+    }
+
+    void value(const ConstValue& constValue) {
+        u8(static_cast<uint8_t>(constValue.index()));
+        std::visit([this](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                string(v);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                u8(v);
+            } else {
+                raw(v);
+            }
+        }, constValue);
+    }
+
+    void expr(const ConstExpr* node) {
+        u8(node != nullptr);
+        if (!node) {
+            return;
+        }
+        u8(static_cast<uint8_t>(node->op));
+        u8(node->isAbsolute);
+        location(node->location);
+        u8(static_cast<uint8_t>(node->literal.index()));
+        std::visit([this](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                string(v);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                u8(v);
+            } else {
+                raw(v);
+            }
+        }, node->literal);
+        u32(static_cast<uint32_t>(node->parts.size()));
+        for (Name part : node->parts) {
+            name(part);
+        }
+        expr(node->lhs);
+        expr(node->rhs);
+    }
+
+    void exprs(const ASTList<ConstExpr>& items) {
+        u32(static_cast<uint32_t>(items.size()));
+        for (const ConstExpr* item : items) {
+            expr(item);
+        }
+    }
+
+    template<typename T>
+    void list(const ASTList<T>& items) {
+        u32(static_cast<uint32_t>(items.size()));
+        for (const T* item : items) {
+            node(item);
+        }
+    }
+
+    void node(const ASTNode* node) {
+        if (!node) {
+            u8(kNullNode);
+            return;
+        }
+        nodeIds_.emplace(node, nodeCount_++);
+        u8(static_cast<uint8_t>(node->kind));
+        location(node->location);
+
+        if (const auto* type = dyn_cast<TypeNode>(node)) {
+            name(type->resolvedCppType);
+            name(type->resolvedScope);
+            name(type->typeId);
+        } else if (const auto* def = dyn_cast<DefinitionNode>(node)) {
+            name(def->name);
+            name(def->fullyQualifiedName);
+        }
+
+        switch (node->kind) {
+            case NodeKind::BasicType:
+                u8(static_cast<uint8_t>(cast<BasicTypeNode>(node)->type));
+                break;
+            case NodeKind::SequenceType: {
+                const auto* seq = cast<SequenceTypeNode>(node);
+                this->node(seq->elementType);
+                expr(seq->boundExpr);
+                optionalSize(seq->bound);
+                break;
+            }
+            case NodeKind::StringType: {
+                const auto* str = cast<StringTypeNode>(node);
+                expr(str->boundExpr);
+                optionalSize(str->bound);
+                u8(str->isWide);
+                break;
+            }
+            case NodeKind::ScopedName: {
+                const auto* scoped = cast<ScopedNameNode>(node);
+                u8(scoped->isAbsolute);
+                u32(static_cast<uint32_t>(scoped->parts.size()));
+                for (Name part : scoped->parts) {
+                    name(part);
+                }
+                break;
+            }
+            case NodeKind::ArrayType: {
+                const auto* array = cast<ArrayTypeNode>(node);
+                this->node(array->elementType);
+                exprs(array->dimensionExprs);
+                sizes(array->dimensions);
+                break;
+            }
+            case NodeKind::Const: {
+                const auto* constNode = cast<ConstNode>(node);
+                this->node(constNode->type);
+                expr(constNode->expr);
+                value(constNode->value);
+                break;
+            }
+            case NodeKind::Struct:
+                list(cast<StructNode>(node)->members);
+                break;
+            case NodeKind::Enum: {
+                const auto* enumNode = cast<EnumNode>(node);
+                u32(static_cast<uint32_t>(enumNode->enumerators.size()));
+                for (Name enumerator : enumNode->enumerators) {
+                    name(enumerator);
+                }
+                break;
+            }
+            case NodeKind::Typedef: {
+                const auto* typedefNode = cast<TypedefNode>(node);
+                this->node(typedefNode->originalType);
+                u32(static_cast<uint32_t>(typedefNode->declarators.size()));
+                for (const auto& declarator : typedefNode->declarators) {
+                    name(declarator.name);
+                    exprs(declarator.dimensionExprs);
+                    sizes(declarator.arrayDimensions);
+                }
+                break;
+            }
+            case NodeKind::Union: {
+                const auto* unionNode = cast<UnionNode>(node);
+                this->node(unionNode->discriminatorType);
+                list(unionNode->cases);
+                break;
+            }
+            case NodeKind::Exception:
+                list(cast<ExceptionNode>(node)->members);
+                break;
+            case NodeKind::Operation: {
+                const auto* operation = cast<OperationNode>(node);
+                this->node(operation->returnType);
+                list(operation->parameters);
+                strings(operation->raises);
+                u8(operation->isOneway);
+                break;
+            }
+            case NodeKind::Attribute: {
+                const auto* attribute = cast<AttributeNode>(node);
+                this->node(attribute->type);
+                u8(attribute->isReadonly);
+                break;
+            }
+            case NodeKind::Interface: {
+                const auto* iface = cast<InterfaceNode>(node);
+                strings(iface->baseInterfaces);
+                list(iface->contents);
+                u8(iface->isAbstract);
+                u8(iface->isLocal);
+                u8(iface->isForward);
+                break;
+            }
+            case NodeKind::Module:
+                list(cast<ModuleNode>(node)->definitions);
+                break;
+            case NodeKind::StructMember: {
+                const auto* member = cast<StructMemberNode>(node);
+                this->node(member->type);
+                name(member->name);
+                break;
+            }
+            case NodeKind::UnionCase: {
+                const auto* unionCase = cast<UnionCaseNode>(node);
+                u32(static_cast<uint32_t>(unionCase->labels.size()));
+                for (const auto& label : unionCase->labels) {
+                    u8(label.isDefault);
+                    expr(label.expr);
+                    value(label.value);
+                }
+                this->node(unionCase->type);
+                name(unionCase->name);
+                break;
+            }
+            case NodeKind::Parameter: {
+                const auto* parameter = cast<ParameterNode>(node);
+                u8(static_cast<uint8_t>(parameter->direction));
+                this->node(parameter->type);
+                name(parameter->name);
+                break;
+            }
+        }
+    }
+
+    void scope(const semantic::Scope& scope) {
+        // Sorted, so that the same unit always encodes to the same bytes
+        std::vector<const semantic::Symbol*> symbols;
+        symbols.reserve(scope.symbols.size());
+        for (const auto& [symbolName, symbol] : scope.symbols) {
+            symbols.push_back(&symbol);
+        }
+        std::sort(symbols.begin(), symbols.end(), [](const auto* a, const auto* b) {
+            return a->name.view() < b->name.view();
+        });
+
+        u32(static_cast<uint32_t>(symbols.size()));
+        for (const auto* symbol : symbols) {
+            name(symbol->name);
+            u8(static_cast<uint8_t>(symbol->kind));
+            auto it = nodeIds_.find(symbol->node);
+            u32(it != nodeIds_.end() ? it->second : kNoNode);
+        }
+
+        u32(static_cast<uint32_t>(scope.children.size()));
+        for (const auto& child : scope.children) {
+            name(child->name);
+            this->scope(*child);
+        }
+    }
+};
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+class Reader {
+public:
+    Reader(std::string_view data, const FileHeader& header, Arena& arena)
+        : arena_(arena) {
+        if (header.stringsOffset > header.stringDataOffset ||
+            header.stringDataOffset > header.treeOffset || header.treeOffset > data.size() ||
+            header.treeSize > data.size() - header.treeOffset ||
+            header.stringCount > (header.stringDataOffset - header.stringsOffset) /
+                                     sizeof(StringEntry)) {
+            throw FormatError("section out of range");
+        }
+        stringIndex_ = data.data() + header.stringsOffset;
+        stringData_ = data.substr(header.stringDataOffset, header.treeOffset - header.stringDataOffset);
+        stringCount_ = header.stringCount;
+        names_.resize(stringCount_);
+        nodes_.reserve(header.nodeCount);
+        pos_ = data.data() + header.treeOffset;
+        end_ = pos_ + header.treeSize;
+    }
+
+    std::string_view string() { return stringAt(u32()); }
+
+    std::string_view stringAt(uint32_t id) const {
+        if (id >= stringCount_) {
+            throw FormatError("string index out of range");
+        }
+        StringEntry entry;
+        std::memcpy(&entry, stringIndex_ + id * sizeof(StringEntry), sizeof(entry));
+        if (entry.offset > stringData_.size() || entry.length > stringData_.size() - entry.offset) {
+            throw FormatError("string out of range");
+        }
+        return stringData_.substr(entry.offset, entry.length);
+    }
+
+    std::vector<source::LineMarker> lineMarkers() {
+        std::vector<source::LineMarker> markers(count(3 * sizeof(uint32_t)));
+        for (auto& marker : markers) {
+            marker.filename = string();
+            marker.offset = u32();
+            marker.line = u32();
+        }
+        return markers;
+    }
+
+    ASTList<DefinitionNode> definitions() { return list<DefinitionNode>(); }
+
+    void scope(semantic::SymbolTable& symbols) {
+        for (uint32_t count = u32(); count > 0; --count) {
+            Name symbolName = name();
+            uint8_t kind = u8();
+            uint32_t nodeId = u32();
+            if (kind > static_cast<uint8_t>(semantic::SymbolKind::EnumValue) ||
+                (nodeId != kNoNode && nodeId >= nodes_.size())) {
+                throw FormatError("invalid symbol");
+            }
+            symbols.addSymbol(symbolName, static_cast<semantic::SymbolKind>(kind),
+                              nodeId != kNoNode ? nodes_[nodeId] : nullptr);
+        }
+        for (uint32_t count = u32(); count > 0; --count) {
+            symbols.enterScope(name());
+            scope(symbols);
+            symbols.leaveScope();
+        }
+    }
+
+    bool atEnd() const { return pos_ == end_; }
+
+private:
+    Arena& arena_;
+    const char* pos_ = nullptr;
+    const char* end_ = nullptr;
+    const char* stringIndex_ = nullptr;
+    std::string_view stringData_;
+    uint32_t stringCount_ = 0;
+    std::vector<Name> names_;  // Interned on first use; empty until then
+    std::vector<ASTNode*> nodes_;  // In the order they were encoded
+
+    template<typename T>
+    T raw() {
+        if (static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+            throw FormatError("unexpected end of data");
+        }
+        T value;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    uint8_t u8() { return raw<uint8_t>(); }
+    uint32_t u32() { return raw<uint32_t>(); }
+    uint64_t u64() { return raw<uint64_t>(); }
+    bool flag() { return u8() != 0; }
+
+    // Element counts are checked against the remaining data before
+    // anything is reserved, so a corrupt count cannot exhaust memory
+    uint32_t count(size_t minimumSize) {
+        uint32_t value = u32();
+        if (value > static_cast<size_t>(end_ - pos_) / minimumSize) {
+            throw FormatError("count out of range");
+        }
+        return value;
+    }
+
+    Name name() {
+        uint32_t id = u32();
+        if (id >= stringCount_) {
+            throw FormatError("string index out of range");
+        }
+        if (names_[id].empty()) {
+            names_[id] = Name::intern(stringAt(id));
+        }
+        return names_[id];
+    }
+
+    SourceLocation location() {
+        SourceLocation loc;
+        loc.fileId = u32();
+        loc.offset = u32();
+        return loc;
+    }
+
+    std::optional<size_t> optionalSize() {
+        bool present = flag();
+        uint64_t value = u64();
+        return present ? std::optional<size_t>(static_cast<size_t>(value)) : std::nullopt;
+    }
+
+    std::vector<size_t> sizes() {
+        std::vector<size_t> values(count(sizeof(uint64_t)));
+        for (auto& value : values) {
+            value = static_cast<size_t>(u64());
+        }
+        return values;
+    }
+
+    std::vector<std::string> strings() {
+        std::vector<std::string> values(count(sizeof(uint32_t)));
+        for (auto& value : values) {
+            value = std::string(string());
+        }
+        return values;
+    }
+
+    std::vector<Name> names() {
+        std::vector<Name> values(count(sizeof(uint32_t)));
+        for (auto& value : values) {
+            value = name();
+        }
+        return values;
+    }
+
+    ConstValue value() {
+        switch (u8()) {
+            case 0: return raw<int64_t>();
+            case 1: return raw<uint64_t>();
+            case 2: return raw<double>();
+            case 3: return std::string(string());
+            case 4: return flag();
+        }
+        throw FormatError("invalid constant value");
+    }
+
+    ASTPtr<ConstExpr> expr() {
+        if (!flag()) {
+            return nullptr;
+        }
+        auto* node = arena_.create<ConstExpr>();
+        uint8_t op = u8();
+        if (op > static_cast<uint8_t>(ConstExpr::Op::Modulo)) {
+            throw FormatError("invalid operator");
+        }
+        node->op = static_cast<ConstExpr::Op>(op);
+        node->isAbsolute = flag();
+        node->location = location();
+        switch (u8()) {
+            case 0: node->literal = raw<int64_t>(); break;
+            case 1: node->literal = raw<double>(); break;
+            case 2: node->literal = arena_.copyString(string()); break;
+            case 3: node->literal = flag(); break;
+            default: throw FormatError("invalid literal");
+        }
+        node->parts = arena_.copyArray(names());
+        node->lhs = expr();
+        node->rhs = expr();
+        return node;
+    }
+
+    ASTList<ConstExpr> exprs() {
+        std::vector<ASTPtr<ConstExpr>> items(count(1));
+        for (auto& item : items) {
+            item = expr();
+        }
+        return arena_.copyArray(items);
+    }
+
+    template<typename T>
+    ASTList<T> list() {
+        std::vector<ASTPtr<T>> items(count(1));
+        for (auto& item : items) {
+            item = node<T>();
+            if (!item) {
+                throw FormatError("missing list element");
+            }
+        }
+        return arena_.copyArray(items);
+    }
+
+    /**
+     * @brief Decode a node that must be a T, or null
+     */
+    template<typename T>
+    ASTPtr<T> node() {
+        ASTNode* decoded = anyNode();
+        if (decoded && !isa<T>(decoded)) {
+            throw FormatError("unexpected node kind");
+        }
+        return static_cast<T*>(decoded);
+    }
+
+    ASTNode* anyNode() {
+        uint8_t kind = u8();
+        if (kind == kNullNode) {
+            return nullptr;
+        }
+        if (kind > static_cast<uint8_t>(NodeKind::Parameter)) {
+            throw FormatError("invalid node kind");
+        }
+        SourceLocation loc = location();
+
+        // Nodes are created before their children, in encoding order, so
+        // that their indices match those the symbols refer to
+        ASTNode* result = create(static_cast<NodeKind>(kind), loc);
+        nodes_.push_back(result);
+
+        if (auto* type = dyn_cast<TypeNode>(result)) {
+            type->resolvedCppType = name();
+            type->resolvedScope = name();
+            type->typeId = name();
+        } else if (auto* def = dyn_cast<DefinitionNode>(result)) {
+            def->name = name();
+            def->fullyQualifiedName = name();
+        }
+
+        switch (result->kind) {
+            case NodeKind::BasicType: {
+                uint8_t type = u8();
+                if (type > static_cast<uint8_t>(BasicType::Object)) {
+                    throw FormatError("invalid basic type");
+                }
+                cast<BasicTypeNode>(result)->type = static_cast<BasicType>(type);
+                break;
+            }
+            case NodeKind::SequenceType: {
+                auto* seq = cast<SequenceTypeNode>(result);
+                seq->elementType = node<TypeNode>();
+                seq->boundExpr = expr();
+                seq->bound = optionalSize();
+                break;
+            }
+            case NodeKind::StringType: {
+                auto* str = cast<StringTypeNode>(result);
+                str->boundExpr = expr();
+                str->bound = optionalSize();
+                str->isWide = flag();
+                break;
+            }
+            case NodeKind::ScopedName: {
+                auto* scoped = cast<ScopedNameNode>(result);
+                scoped->isAbsolute = flag();
+                scoped->parts = names();
+                break;
+            }
+            case NodeKind::ArrayType: {
+                auto* array = cast<ArrayTypeNode>(result);
+                array->elementType = node<TypeNode>();
+                array->dimensionExprs = exprs();
+                array->dimensions = sizes();
+                break;
+            }
+            case NodeKind::Const: {
+                auto* constNode = cast<ConstNode>(result);
+                constNode->type = node<TypeNode>();
+                constNode->expr = expr();
+                constNode->value = value();
+                break;
+            }
+            case NodeKind::Struct:
+                cast<StructNode>(result)->members = list<StructMemberNode>();
+                break;
+            case NodeKind::Enum:
+                cast<EnumNode>(result)->enumerators = names();
+                break;
+            case NodeKind::Typedef: {
+                auto* typedefNode = cast<TypedefNode>(result);
+                typedefNode->originalType = node<TypeNode>();
+                typedefNode->declarators.resize(count(sizeof(uint32_t)));
+                for (auto& declarator : typedefNode->declarators) {
+                    declarator.name = name();
+                    declarator.dimensionExprs = exprs();
+                    declarator.arrayDimensions = sizes();
+                }
+                break;
+            }
+            case NodeKind::Union: {
+                auto* unionNode = cast<UnionNode>(result);
+                unionNode->discriminatorType = node<TypeNode>();
+                unionNode->cases = list<UnionCaseNode>();
+                break;
+            }
+            case NodeKind::Exception:
+                cast<ExceptionNode>(result)->members = list<StructMemberNode>();
+                break;
+            case NodeKind::Operation: {
+                auto* operation = cast<OperationNode>(result);
+                operation->returnType = node<TypeNode>();
+                operation->parameters = list<ParameterNode>();
+                operation->raises = strings();
+                operation->isOneway = flag();
+                break;
+            }
+            case NodeKind::Attribute: {
+                auto* attribute = cast<AttributeNode>(result);
+                attribute->type = node<TypeNode>();
+                attribute->isReadonly = flag();
+                break;
+            }
+            case NodeKind::Interface: {
+                auto* iface = cast<InterfaceNode>(result);
+                iface->baseInterfaces = strings();
+                iface->contents = list<DefinitionNode>();
+                iface->isAbstract = flag();
+                iface->isLocal = flag();
+                iface->isForward = flag();
+                break;
+            }
+            case NodeKind::Module:
+                cast<ModuleNode>(result)->definitions = list<DefinitionNode>();
+                break;
+            case NodeKind::StructMember: {
+                auto* member = cast<StructMemberNode>(result);
+                member->type = node<TypeNode>();
+                member->name = name();
+                break;
+            }
+            case NodeKind::UnionCase: {
+                auto* unionCase = cast<UnionCaseNode>(result);
+                unionCase->labels.resize(count(1));
+                for (auto& label : unionCase->labels) {
+                    label.isDefault = flag();
+                    label.expr = expr();
+                    label.value = value();
+                }
+                unionCase->type = node<TypeNode>();
+                unionCase->name = name();
+                break;
+            }
+            case NodeKind::Parameter: {
+                auto* parameter = cast<ParameterNode>(result);
+                uint8_t direction = u8();
+                if (direction > static_cast<uint8_t>(ParamDirection::InOut)) {
+                    throw FormatError("invalid parameter direction");
+                }
+                parameter->direction = static_cast<ParamDirection>(direction);
+                parameter->type = node<TypeNode>();
+                parameter->name = name();
+                break;
+            }
+        }
+        return result;
+    }
+
+    // Create an empty node of the given kind; its fields are decoded next
+    ASTNode* create(NodeKind kind, SourceLocation loc) {
+        switch (kind) {
+            case NodeKind::BasicType:    return arena_.create<BasicTypeNode>(BasicType::Void, loc);
+            case NodeKind::SequenceType: return arena_.create<SequenceTypeNode>(nullptr, std::nullopt, loc);
+            case NodeKind::StringType:   return arena_.create<StringTypeNode>(std::nullopt, false, loc);
+            case NodeKind::ScopedName:   return arena_.create<ScopedNameNode>(std::vector<Name>{}, false, loc);
+            case NodeKind::ArrayType:    return arena_.create<ArrayTypeNode>(nullptr, ASTList<ConstExpr>{}, loc);
+            case NodeKind::Const:        return arena_.create<ConstNode>(Name(), nullptr, nullptr, loc);
+            case NodeKind::Struct:       return arena_.create<StructNode>(Name(), loc);
+            case NodeKind::Enum:         return arena_.create<EnumNode>(Name(), std::vector<Name>{}, loc);
+            case NodeKind::Typedef:      return arena_.create<TypedefNode>(nullptr, std::vector<TypedefDeclarator>{}, loc);
+            case NodeKind::Union:        return arena_.create<UnionNode>(Name(), nullptr, loc);
+            case NodeKind::Exception:    return arena_.create<ExceptionNode>(Name(), loc);
+            case NodeKind::Operation:    return arena_.create<OperationNode>(Name(), nullptr, loc);
+            case NodeKind::Attribute:    return arena_.create<AttributeNode>(Name(), nullptr, false, loc);
+            case NodeKind::Interface:    return arena_.create<InterfaceNode>(Name(), loc);
+            case NodeKind::Module:       return arena_.create<ModuleNode>(Name(), loc);
+            case NodeKind::StructMember: return arena_.create<StructMemberNode>(nullptr, Name(), loc);
+            case NodeKind::UnionCase:    return arena_.create<UnionCaseNode>(std::vector<CaseLabel>{}, nullptr, Name(), loc);
+            case NodeKind::Parameter:    return arena_.create<ParameterNode>(ParamDirection::In, nullptr, Name(), loc);
+        }
+        throw FormatError("invalid node kind");
+    }
+};
+
+} // anonymous namespace
+
+std::string serializeUnit(const TranslationUnit& unit, const semantic::SymbolTable& symbols,
+                          uint64_t key, uint64_t sourceSize) {
+    Writer writer;
+    return writer.encode(unit, symbols, key, sourceSize);
+}
+
+std::unique_ptr<CachedUnit> deserializeUnit(std::string_view data, uint64_t key,
+                                            std::unique_ptr<source::SourceBuffer>& source) {
+    FileHeader header;
+    if (data.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion || header.byteOrder != kByteOrderMark ||
+        header.key != key || header.sourceSize != source->data().size()) {
+        return nullptr;
+    }
+
+    auto result = std::make_unique<CachedUnit>();
+    std::string bufferName;
+    std::vector<source::LineMarker> markers;
+    try {
+        Reader reader(data, header, result->unit.arena);
+        bufferName = reader.string();
+        markers = reader.lineMarkers();
+        result->unit.filename = reader.string();
+        result->unit.definitions = reader.definitions();
+        reader.scope(result->symbols);
+        if (!reader.atEnd()) {
+            return nullptr;
+        }
+    } catch (const FormatError&) {
+        return nullptr;
+    }
+
+    // Recreate the file entries the locations refer to, under the same ids
+    auto sourceManager = std::make_shared<source::SourceManager>();
+    uint32_t fileId = sourceManager->addBuffer(std::move(source), bufferName);
+    for (const auto& marker : markers) {
+        sourceManager->addLineMarker(fileId, marker.filename, marker.offset, marker.line);
+    }
+    result->unit.sourceManager = std::move(sourceManager);
+    return result;
+}
+
+} // namespace iborb::cache
@@ -0,0 +1,72 @@
+#ifndef IBORB_IDL_UNIT_FORMAT_HPP
+#define IBORB_IDL_UNIT_FORMAT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "ast/ast.hpp"
+#include "semantic/symbol_table.hpp"
+
+namespace iborb::source {
+class SourceBuffer;
+}
+
+namespace iborb::cache {
+
+/**
+ * @brief Version of the binary unit format
+ *
+ * Bump it whenever the AST, the symbol table, the analysis results
+ * stored in them or the encoding change, so that stale files are
+ * ignored instead of misread.
+ */
+inline constexpr uint32_t kFormatVersion = 2;
+
+/**
+ * @brief An analyzed unit read back from its binary form
+ */
+struct CachedUnit {
+    ast::TranslationUnit unit;
+    semantic::SymbolTable symbols;
+};
+
+/**
+ * @brief Encode an analyzed unit and its symbol table
+ *
+ * The file starts with a fixed header, followed by a table of every
+ * distinct string (names, literals, file names) and a stream of
+ * records for the tree. Records refer to strings and to other nodes by
+ * index, never by address, so the file can be mapped and decoded in one
+ * forward pass. Analysis results (qualified names, resolved types,
+ * folded values) are stored too, so a decoded unit is ready for
+ * generation. Integers are stored in the byte order of the machine that
+ * wrote them; the header records it.
+ *
+ * The unit must have no imports, and its source manager must hold the
+ * single buffer it was parsed from.
+ *
+ * @param key Identifies the input; deserializeUnit() checks it
+ * @param sourceSize Size of the buffer the unit was parsed from
+ */
+std::string serializeUnit(const ast::TranslationUnit& unit, const semantic::SymbolTable& symbols,
+                          uint64_t key, uint64_t sourceSize);
+
+/**
+ * @brief Decode a unit encoded by serializeUnit()
+ *
+ * Locations refer to the buffer the unit was parsed from, so the same
+ * buffer has to be supplied; it becomes part of the unit's source
+ * manager.
+ *
+ * @param data Encoded unit, typically a mapped file
+ * @param key Expected key
+ * @param source Buffer the unit was parsed from; taken only on success
+ * @return The unit, or nullptr if data is not a valid encoding for the key and source
+ */
+std::unique_ptr<CachedUnit> deserializeUnit(std::string_view data, uint64_t key,
+                                            std::unique_ptr<source::SourceBuffer>& source);
+
+} // namespace iborb::cache
+
+#endif // IBORB_IDL_UNIT_FORMAT_HPP
@@ -0,0 +1,291 @@
+#include "driver/compile_server.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <csignal>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace iborb::driver {
+
+#ifndef _WIN32
+
+namespace {
+
+constexpr uint32_t kRequestMagic = 0x49425251;   // "IBRQ"
+constexpr uint32_t kResponseMagic = 0x49425253;  // "IBRS"
+constexpr uint32_t kMaxStringSize = 64u * 1024 * 1024;
+constexpr uint32_t kMaxArguments = 64u * 1024;
+constexpr int kPollIntervalMs = 1000;   // Bounds the delay in noticing a stop signal
+constexpr int kClientTimeoutSec = 30;   // A client that stops sending is dropped
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+/**
+ * @brief Length-prefixed encoding of a message
+ */
+class MessageWriter {
+public:
+    void u32(uint32_t value) {
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void str(std::string_view text) {
+        u32(static_cast<uint32_t>(text.size()));
+        data_.append(text);
+    }
+
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+};
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t count = ::send(fd, data.data() + sent, data.size() - sent, kSendFlags);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+bool receiveAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = ::recv(fd, data, size, 0);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+bool receiveU32(int fd, uint32_t& value) {
+    return receiveAll(fd, reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+bool receiveString(int fd, std::string& text) {
+    uint32_t size;
+    if (!receiveU32(fd, size) || size > kMaxStringSize) {
+        return false;
+    }
+    text.resize(size);
+    return receiveAll(fd, text.data(), size);
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    std::memcpy(address.sun_path, path.data(), path.size());
+    return address;
+}
+
+/**
+ * @brief Connect to the socket at path
+ * @return The connected descriptor, or -1
+ */
+int connectTo(const sockaddr_un& address) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool receiveRequest(int fd, CompileRequest& request) {
+    uint32_t magic;
+    uint32_t count;
+    if (!receiveU32(fd, magic) || magic != kRequestMagic ||
+        !receiveString(fd, request.workingDirectory) || !receiveU32(fd, count) ||
+        count > kMaxArguments) {
+        return false;
+    }
+    request.arguments.resize(count);
+    for (auto& argument : request.arguments) {
+        if (!receiveString(fd, argument)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void serveClient(int fd, const CompileServer::Handler& handler) {
+    timeval timeout{};
+    timeout.tv_sec = kClientTimeoutSec;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    CompileRequest request;
+    if (!receiveRequest(fd, request)) {
+        return;
+    }
+
+    CompileResponse response;
+    try {
+        response = handler(request);
+    } catch (const std::exception& e) {
+        response.exitCode = 1;
+        response.err += std::string("Server error: ") + e.what() + "\n";
+    }
+
+    MessageWriter writer;
+    writer.u32(kResponseMagic);
+    writer.u32(static_cast<uint32_t>(response.exitCode));
+    writer.str(response.out);
+    writer.str(response.err);
+    sendAll(fd, writer.data());
+}
+
+} // anonymous namespace
+
+CompileServer::CompileServer(std::string socketPath)
+    : socketPath_(std::move(socketPath)) {
+    sockaddr_un address = socketAddress(socketPath_);
+
+    // A socket nobody answers on was left behind by a server that exited
+    struct stat info;
+    if (::lstat(socketPath_.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            throw std::runtime_error(socketPath_ + " exists and is not a socket");
+        }
+        int fd = connectTo(address);
+        if (fd >= 0) {
+            ::close(fd);
+            throw std::runtime_error("A server is already listening on " + socketPath_);
+        }
+        ::unlink(socketPath_.c_str());
+    }
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+    }
+    ::fcntl(fd_, F_SETFD, FD_CLOEXEC);  // Not inherited by external preprocessors
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd_, SOMAXCONN) != 0) {
+        std::string reason = std::strerror(errno);
+        ::close(fd_);
+        throw std::runtime_error("Cannot listen on " + socketPath_ + ": " + reason);
+    }
+}
+
+CompileServer::~CompileServer() {
+    ::close(fd_);
+    ::unlink(socketPath_.c_str());
+}
+
+void CompileServer::run(const Handler& handler) {
+    // Without SA_RESTART, so that a signal also interrupts a waiting poll()
+    struct sigaction action {};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    stopRequested = 0;
+    while (!stopRequested) {
+        pollfd listener{fd_, POLLIN, 0};
+        if (::poll(&listener, 1, kPollIntervalMs) <= 0) {
+            continue;
+        }
+        int client = ::accept(fd_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        ::fcntl(client, F_SETFD, FD_CLOEXEC);
+        serveClient(client, handler);
+        ::close(client);
+    }
+}
+
+std::optional<CompileResponse> sendRequest(const std::string& socketPath,
+                                           const CompileRequest& request) {
+    sockaddr_un address;
+    try {
+        address = socketAddress(socketPath);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+    int fd = connectTo(address);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    MessageWriter writer;
+    writer.u32(kRequestMagic);
+    writer.str(request.workingDirectory);
+    writer.u32(static_cast<uint32_t>(request.arguments.size()));
+    for (const auto& argument : request.arguments) {
+        writer.str(argument);
+    }
+
+    CompileResponse response;
+    uint32_t magic;
+    uint32_t exitCode;
+    bool ok = sendAll(fd, writer.data()) && receiveU32(fd, magic) && magic == kResponseMagic &&
+              receiveU32(fd, exitCode) && receiveString(fd, response.out) &&
+              receiveString(fd, response.err);
+    ::close(fd);
+    if (!ok) {
+        return std::nullopt;
+    }
+    response.exitCode = static_cast<int>(exitCode);
+    return response;
+}
+
+#else // _WIN32
+
+CompileServer::CompileServer(std::string socketPath)
+    : socketPath_(std::move(socketPath)) {
+    throw std::runtime_error("The compile server is not supported on this platform");
+}
+
+CompileServer::~CompileServer() = default;
+
+void CompileServer::run(const Handler&) {
+}
+
+std::optional<CompileResponse> sendRequest(const std::string&, const CompileRequest&) {
+    return std::nullopt;
+}
+
+#endif
+
+} // namespace iborb::driver
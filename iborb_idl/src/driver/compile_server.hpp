@@ -0,0 +1,83 @@
+#ifndef IBORB_IDL_COMPILE_SERVER_HPP
+#define IBORB_IDL_COMPILE_SERVER_HPP
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace iborb::driver {
+
+/**
+ * @brief A compiler invocation forwarded to a server
+ */
+struct CompileRequest {
+    std::string workingDirectory;        // Relative paths in the arguments are resolved here
+    std::vector<std::string> arguments;  // Command line, without the program name
+};
+
+/**
+ * @brief What the invocation would have printed and returned
+ */
+struct CompileResponse {
+    int exitCode = 1;
+    std::string out;  // For stdout
+    std::string err;  // For stderr
+};
+
+/**
+ * @brief Serves compile requests on a local (Unix domain) socket
+ *
+ * Keeps one process, and whatever the handler caches, alive between
+ * the compiler invocations of a build. Requests are handled one at a
+ * time in the order they connect; each one may use every core. Clients
+ * that connect while a request is running wait in the listen queue.
+ *
+ * Not available on Windows, where the constructor throws.
+ */
+class CompileServer {
+public:
+    using Handler = std::function<CompileResponse(const CompileRequest&)>;
+
+    /**
+     * @brief Listen on the given socket path
+     *
+     * A stale socket left by a server that is no longer running is
+     * replaced. Throws std::runtime_error if another server is
+     * listening there or the socket cannot be created.
+     */
+    explicit CompileServer(std::string socketPath);
+
+    /**
+     * @brief Stop listening and remove the socket
+     */
+    ~CompileServer();
+
+    CompileServer(const CompileServer&) = delete;
+    CompileServer& operator=(const CompileServer&) = delete;
+
+    /**
+     * @brief Handle requests until the process receives SIGINT or SIGTERM
+     *
+     * Exceptions thrown by the handler are reported to the client as
+     * errors; a client that disconnects early is ignored.
+     */
+    void run(const Handler& handler);
+
+    const std::string& getSocketPath() const { return socketPath_; }
+
+private:
+    std::string socketPath_;
+    int fd_ = -1;
+};
+
+/**
+ * @brief Have the server listening on socketPath handle a request
+ * @return The response, or std::nullopt if no server answered
+ */
+std::optional<CompileResponse> sendRequest(const std::string& socketPath,
+                                           const CompileRequest& request);
+
+} // namespace iborb::driver
+
+#endif // IBORB_IDL_COMPILE_SERVER_HPP
@@ -0,0 +1,182 @@
+#include "driver/definition_pipeline.hpp"
+
+namespace iborb::driver {
+
+DefinitionPipeline::DefinitionPipeline(generator::GeneratorConfig config)
+    : generator_(std::make_unique<generator::Cpp11Generator>(std::move(config))) {
+    thread_ = std::thread([this] { run(); });
+}
+
+DefinitionPipeline::~DefinitionPipeline() {
+    if (thread_.joinable()) {
+        Event event(Event::Kind::Finish);
+        {
+            // Jump the queue; whatever is still in it is dropped
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.clear();
+            queue_.push_back(std::move(event));
+        }
+        ready_.notify_one();
+        thread_.join();
+    }
+}
+
+void DefinitionPipeline::beginUnit(const std::string& filename,
+                                   std::shared_ptr<const source::SourceManager> sourceManager) {
+    Event event(Event::Kind::BeginUnit);
+    event.filename = filename;
+    event.sourceManager = std::move(sourceManager);
+    push(std::move(event));
+}
+
+void DefinitionPipeline::importUnit(std::shared_ptr<const ast::TranslationUnit> unit,
+                                    const semantic::SymbolTable& symbols) {
+    Event event(Event::Kind::Import);
+    event.unit = std::move(unit);
+    event.symbols = &symbols;
+    push(std::move(event));
+}
+
+void DefinitionPipeline::beginModule(ast::Name name, ast::SourceLocation) {
+    Event event(Event::Kind::BeginModule);
+    event.name = name;
+    push(std::move(event));
+}
+
+void DefinitionPipeline::endModule() {
+    push(Event(Event::Kind::EndModule));
+}
+
+void DefinitionPipeline::definition(ast::Arena arena, ast::DefinitionNode& definition) {
+    Event event(Event::Kind::Definition);
+    event.arena = std::move(arena);
+    event.definition = &definition;
+    push(std::move(event));
+}
+
+bool DefinitionPipeline::finish(bool commit) {
+    Event event(Event::Kind::Finish);
+    event.commit = commit;
+    push(std::move(event));
+    thread_.join();
+
+    if (exception_) {
+        std::rethrow_exception(exception_);
+    }
+    return succeeded_;
+}
+
+void DefinitionPipeline::push(Event event) {
+    bool wasEmpty;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [this] { return stopped_ || queue_.size() < kCapacity; });
+        if (stopped_) {
+            return;
+        }
+        wasEmpty = queue_.empty();
+        queue_.push_back(std::move(event));
+    }
+
+    // The consumer only ever waits for an empty queue
+    if (wasEmpty) {
+        ready_.notify_one();
+    }
+}
+
+void DefinitionPipeline::run() {
+    // Events are taken a batch at a time, so the threads synchronize
+    // once per batch rather than once per definition
+    std::deque<Event> batch;
+    bool last = false;
+    while (!last) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return !queue_.empty(); });
+            batch.swap(queue_);
+        }
+        space_.notify_one();
+
+        // Each definition's arena is released as its event is popped
+        for (; !batch.empty() && !last; batch.pop_front()) {
+            Event& event = batch.front();
+            last = event.kind == Event::Kind::Finish;
+            try {
+                handle(event);
+            } catch (...) {
+                exception_ = std::current_exception();
+                last = true;
+            }
+        }
+    }
+    batch.clear();
+
+    // Let a parser waiting for space go on; its events are dropped
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    space_.notify_all();
+}
+
+void DefinitionPipeline::handle(Event& event) {
+    switch (event.kind) {
+        case Event::Kind::BeginUnit:
+            sourceManager_ = std::move(event.sourceManager);
+            generator_->beginStream(event.filename);
+            break;
+
+        case Event::Kind::Import: {
+            analyzer_.addImportedSymbols(*event.symbols);
+            imports_.push_back(event.unit);
+
+            // Imported definitions were analyzed when the header was parsed
+            auto generate = [this](const ast::TranslationUnit& owner, ast::DefinitionNode& def) {
+                ++definitions_;
+                if (generating_) {
+                    generator_->streamDefinition(def, owner.sourceManager.get(), true);
+                }
+            };
+            if (visited_.insert(event.unit.get()).second) {
+                event.unit->forEachDefinition(generate, visited_);
+            }
+            break;
+        }
+
+        case Event::Kind::BeginModule:
+            if (depth_++ == 0) {
+                ++definitions_;
+            }
+            analyzer_.beginModule(event.name);
+            generator_->beginModule(event.name);
+            break;
+
+        case Event::Kind::EndModule:
+            --depth_;
+            analyzer_.endModule();
+            generator_->endModule();
+            break;
+
+        case Event::Kind::Definition:
+            if (depth_ == 0) {
+                ++definitions_;
+            }
+            if (!analyzer_.analyzeDefinition(*event.definition, sourceManager_.get())) {
+                generating_ = false;
+            }
+            if (generating_) {
+                generator_->streamDefinition(*event.definition, sourceManager_.get());
+            }
+            break;
+
+        case Event::Kind::Finish:
+            dependencies_.add(*sourceManager_);
+            for (const auto& unit : imports_) {
+                dependencies_.add(*unit);
+            }
+            succeeded_ = generator_->endStream(event.commit && generating_) && generating_;
+            break;
+    }
+}
+
+} // namespace iborb::driver
@@ -0,0 +1,150 @@
+#ifndef IBORB_IDL_DEFINITION_PIPELINE_HPP
+#define IBORB_IDL_DEFINITION_PIPELINE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "driver/dependency_file.hpp"
+#include "generator/cpp11_generator.hpp"
+#include "parser/definition_sink.hpp"
+#include "semantic/analyzer.hpp"
+
+namespace iborb::driver {
+
+/**
+ * @brief Analyzes and generates a unit on a second thread while it is parsed
+ *
+ * The parser hands each definition over as soon as it is complete
+ * (see parser::Parser::parse(DefinitionSink&)). A consumer thread
+ * analyzes it, generates its code into the header, which is written out
+ * as it grows, and releases its arena. Parsing and generation overlap,
+ * and memory is bounded by the definitions in flight rather than the
+ * size of the unit: the queue between the threads holds at most
+ * kCapacity of them, and the parser waits when it is full. The consumer
+ * takes everything queued at once, so the threads meet once per batch
+ * rather than once per definition.
+ *
+ * Once a definition has an analysis error nothing more is generated,
+ * but the rest is still analyzed so that all diagnostics are reported.
+ */
+class DefinitionPipeline : public parser::DefinitionSink {
+public:
+    explicit DefinitionPipeline(generator::GeneratorConfig config);
+
+    /**
+     * @brief Stop the consumer, discarding anything not finished
+     */
+    ~DefinitionPipeline() override;
+
+    DefinitionPipeline(const DefinitionPipeline&) = delete;
+    DefinitionPipeline& operator=(const DefinitionPipeline&) = delete;
+
+    void beginUnit(const std::string& filename,
+                   std::shared_ptr<const source::SourceManager> sourceManager) override;
+    void importUnit(std::shared_ptr<const ast::TranslationUnit> unit,
+                    const semantic::SymbolTable& symbols) override;
+    void beginModule(ast::Name name, ast::SourceLocation location) override;
+    void endModule() override;
+    void definition(ast::Arena arena, ast::DefinitionNode& definition) override;
+
+    /**
+     * @brief Wait until the unit is analyzed and generated
+     * @param commit Put the generated files in place; false discards them
+     * @return true if analysis and generation succeeded
+     * @throws Whatever the consumer thread failed with
+     */
+    bool finish(bool commit);
+
+    /**
+     * @brief Get the analyzer's errors and warnings, once finished
+     */
+    const std::vector<semantic::Diagnostic>& getDiagnostics() const {
+        return analyzer_.getDiagnostics();
+    }
+
+    /**
+     * @brief Check whether analysis found errors, once finished
+     */
+    bool hasAnalysisErrors() const { return analyzer_.hasErrors(); }
+
+    /**
+     * @brief Get the generator's errors, once finished
+     */
+    const std::vector<std::string>& getGeneratorErrors() const { return generator_->getErrors(); }
+
+    /**
+     * @brief Take the generator, once finished
+     *
+     * With GeneratorConfig::deferWrite, its writeFiles() puts the
+     * streamed files in place, so the caller decides in which order
+     * inputs that generate the same files replace each other.
+     */
+    std::unique_ptr<generator::Cpp11Generator> takeGenerator() { return std::move(generator_); }
+
+    /**
+     * @brief Get the files the unit was read from, once finished
+     */
+    const DependencyList& getDependencies() const { return dependencies_; }
+
+    /**
+     * @brief Number of top-level definitions, including those of imported headers
+     */
+    size_t getDefinitionCount() const { return definitions_; }
+
+private:
+    static constexpr size_t kCapacity = 16;  // Definitions queued before the parser waits
+
+    /**
+     * @brief One call of the sink, queued for the consumer
+     */
+    struct Event {
+        enum class Kind { BeginUnit, Import, BeginModule, EndModule, Definition, Finish };
+
+        explicit Event(Kind eventKind) : kind(eventKind) {}
+
+        Kind kind;
+        std::string filename;                                // BeginUnit
+        std::shared_ptr<const source::SourceManager> sourceManager;  // BeginUnit
+        std::shared_ptr<const ast::TranslationUnit> unit;    // Import
+        const semantic::SymbolTable* symbols = nullptr;      // Import
+        ast::Name name;                                      // BeginModule
+        ast::Arena arena;                                    // Definition
+        ast::DefinitionNode* definition = nullptr;           // Definition
+        bool commit = false;                                 // Finish
+    };
+
+    // Consumer state
+    semantic::Analyzer analyzer_;
+    std::unique_ptr<generator::Cpp11Generator> generator_;
+    std::shared_ptr<const source::SourceManager> sourceManager_;
+    std::unordered_set<const ast::TranslationUnit*> visited_;  // Imported units generated so far
+    std::vector<std::shared_ptr<const ast::TranslationUnit>> imports_;
+    DependencyList dependencies_;
+    size_t depth_ = 0;  // Modules open
+    size_t definitions_ = 0;
+    bool generating_ = true;  // Cleared by the first analysis error
+    bool succeeded_ = false;
+
+    // Shared between the threads
+    std::mutex mutex_;
+    std::condition_variable ready_;  // Signalled when an event is queued
+    std::condition_variable space_;  // Signalled when an event is taken
+    std::deque<Event> queue_;
+    bool stopped_ = false;  // The consumer is done and takes no more events
+    std::exception_ptr exception_;
+    std::thread thread_;
+
+    void push(Event event);
+    void run();
+    void handle(Event& event);
+};
+
+} // namespace iborb::driver
+
+#endif // IBORB_IDL_DEFINITION_PIPELINE_HPP
@@ -0,0 +1,65 @@
+#include "driver/dependency_file.hpp"
+#include <filesystem>
+
+namespace iborb::driver {
+
+namespace {
+
+void appendEscaped(std::string& out, const std::string& file) {
+    for (char c : file) {
+        if (c == ' ' || c == '#') {
+            out += '\\';
+        } else if (c == '$') {
+            out += '$';
+        }
+        out += c;
+    }
+}
+
+} // anonymous namespace
+
+void DependencyList::add(const source::SourceManager& sourceManager) {
+    for (const auto& name : sourceManager.getFilenames()) {
+        // "./a.idl" and "a.idl" are the same dependency
+        std::string file = std::filesystem::path(name).lexically_normal().string();
+        if (!seen_.insert(file).second) {
+            continue;
+        }
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(file, ec)) {
+            files_.push_back(std::move(file));
+        }
+    }
+}
+
+void DependencyList::add(const ast::TranslationUnit& unit) {
+    if (!units_.insert(&unit).second) {
+        return;
+    }
+    if (unit.sourceManager) {
+        add(*unit.sourceManager);
+    }
+    for (const auto& import : unit.imports) {
+        add(*import.unit);
+    }
+}
+
+std::string formatMakeRule(const std::vector<std::string>& targets,
+                           const std::vector<std::string>& dependencies) {
+    std::string rule;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (i > 0) {
+            rule += ' ';
+        }
+        appendEscaped(rule, targets[i]);
+    }
+    rule += ':';
+    for (const auto& dependency : dependencies) {
+        rule += " \\\n  ";
+        appendEscaped(rule, dependency);
+    }
+    rule += '\n';
+    return rule;
+}
+
+} // namespace iborb::driver
@@ -0,0 +1,52 @@
+#ifndef IBORB_IDL_DEPENDENCY_FILE_HPP
+#define IBORB_IDL_DEPENDENCY_FILE_HPP
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "ast/ast.hpp"
+#include "source/source_manager.hpp"
+
+namespace iborb::driver {
+
+/**
+ * @brief The files a unit was read from, for dependency files (-MD)
+ *
+ * Files are named as the line markers of the preprocessed input name
+ * them, so they are spelled relative to the include paths like the
+ * external preprocessor spells them, and are listed once each, with
+ * redundant "." and ".." components removed. Names
+ * that are not files, such as `<built-in>` or the target of a `#line`
+ * directive, are left out.
+ */
+class DependencyList {
+public:
+    /**
+     * @brief Add the files named by the buffers and line markers of a unit
+     */
+    void add(const source::SourceManager& sourceManager);
+
+    /**
+     * @brief Add the files of a unit and, recursively, of the headers it imports
+     */
+    void add(const ast::TranslationUnit& unit);
+
+    const std::vector<std::string>& getFiles() const { return files_; }
+
+private:
+    std::vector<std::string> files_;
+    std::unordered_set<std::string> seen_;
+    std::unordered_set<const ast::TranslationUnit*> units_;  // Added, with their imports
+};
+
+/**
+ * @brief Format a Make rule that makes the targets depend on the dependencies
+ *
+ * Spaces, '#' and '$' in file names are escaped the way GCC escapes them.
+ */
+std::string formatMakeRule(const std::vector<std::string>& targets,
+                           const std::vector<std::string>& dependencies);
+
+} // namespace iborb::driver
+
+#endif // IBORB_IDL_DEPENDENCY_FILE_HPP
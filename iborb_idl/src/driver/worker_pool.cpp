@@ -0,0 +1,98 @@
+#include "driver/worker_pool.hpp"
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace iborb::driver {
+
+namespace {
+
+/**
+ * @brief Pending task indices of one worker
+ */
+struct TaskQueue {
+    std::mutex mutex;
+    std::deque<size_t> items;
+};
+
+/**
+ * @brief Take the next task for a worker, stealing if its own queue is empty
+ */
+bool takeTask(std::vector<TaskQueue>& queues, size_t self, size_t& item) {
+    {
+        std::lock_guard<std::mutex> lock(queues[self].mutex);
+        if (!queues[self].items.empty()) {
+            item = queues[self].items.front();
+            queues[self].items.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        TaskQueue& victim = queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            item = victim.items.back();
+            victim.items.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+WorkerPool::WorkerPool(unsigned threads)
+    : threads_(threads == 0 ? hardwareThreads() : threads) {
+}
+
+unsigned WorkerPool::hardwareThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)>& task) const {
+    if (count == 0) {
+        return;
+    }
+
+    size_t workers = std::min<size_t>(threads_, count);
+    std::vector<TaskQueue> queues(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        for (size_t i = w * count / workers; i < (w + 1) * count / workers; ++i) {
+            queues[w].items.push_back(i);
+        }
+    }
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto work = [&](size_t self) {
+        size_t item;
+        while (takeTask(queues, self, item)) {
+            try {
+                task(item);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace iborb::driver
@@ -0,0 +1,50 @@
+#ifndef IBORB_IDL_WORKER_POOL_HPP
+#define IBORB_IDL_WORKER_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace iborb::driver {
+
+/**
+ * @brief Runs independent, indexed tasks on a fixed number of threads
+ *
+ * Each worker starts with a contiguous range of task indices and takes
+ * them lowest first; a worker that runs out steals the highest pending
+ * index of another worker. Early indices therefore tend to finish
+ * first, which lets callers publish results in order with little
+ * buffering, while uneven task sizes still balance across threads.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Create a pool
+     * @param threads Number of workers, including the calling thread (0 means one per core)
+     */
+    explicit WorkerPool(unsigned threads = 0);
+
+    /**
+     * @brief Number of workers, including the calling thread
+     */
+    unsigned size() const { return threads_; }
+
+    /**
+     * @brief Run task(i) for every i in [0, count) and wait for all of them
+     *
+     * The calling thread works as well. If tasks throw, the remaining
+     * tasks still run and the first exception is rethrown afterwards.
+     */
+    void run(size_t count, const std::function<void(size_t)>& task) const;
+
+    /**
+     * @brief Number of hardware threads, or 1 if unknown
+     */
+    static unsigned hardwareThreads();
+
+private:
+    unsigned threads_;
+};
+
+} // namespace iborb::driver
+
+#endif // IBORB_IDL_WORKER_POOL_HPP
@@ -0,0 +1,69 @@
+#include "generator/code_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace iborb::generator {
+
+CodeBuffer::CodeBuffer(std::string_view indentUnit)
+    : indentUnit_(indentUnit) {
+}
+
+void CodeBuffer::appendIndent(int level) {
+    if (level <= 0) {
+        return;
+    }
+    size_t length = static_cast<size_t>(level) * indentUnit_.size();
+    while (indentCache_.size() < length) {
+        indentCache_ += indentUnit_;
+    }
+    appendPart(std::string_view(indentCache_.data(), length));
+}
+
+void CodeBuffer::clear() {
+    if (chunks_.size() > 1) {
+        chunks_.resize(1);
+    }
+    if (!chunks_.empty()) {
+        chunks_.front().size = 0;
+    }
+    size_ = 0;
+}
+
+std::string CodeBuffer::str() const {
+    std::string result;
+    result.reserve(size_);
+    for (const auto& chunk : chunks_) {
+        result.append(chunk.data.get(), chunk.size);
+    }
+    return result;
+}
+
+void CodeBuffer::appendPart(std::string_view text) {
+    Chunk* chunk = chunks_.empty() ? &grow() : &chunks_.back();
+    while (!text.empty()) {
+        if (chunk->size == kChunkSize) {
+            chunk = &grow();
+        }
+        size_t count = std::min(text.size(), kChunkSize - chunk->size);
+        std::memcpy(chunk->data.get() + chunk->size, text.data(), count);
+        chunk->size += count;
+        size_ += count;
+        text.remove_prefix(count);
+    }
+}
+
+void CodeBuffer::appendPart(char c) {
+    if (chunks_.empty() || chunks_.back().size == kChunkSize) {
+        grow();
+    }
+    Chunk& chunk = chunks_.back();
+    chunk.data[chunk.size++] = c;
+    ++size_;
+}
+
+CodeBuffer::Chunk& CodeBuffer::grow() {
+    chunks_.push_back({std::make_unique<char[]>(kChunkSize), 0});
+    return chunks_.back();
+}
+
+} // namespace iborb::generator
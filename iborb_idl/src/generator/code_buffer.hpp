@@ -0,0 +1,116 @@
+#ifndef IBORB_IDL_CODE_BUFFER_HPP
+#define IBORB_IDL_CODE_BUFFER_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace iborb::generator {
+
+/**
+ * @brief Append-only output buffer for generated code
+ *
+ * Text is copied into fixed-size chunks that are never reallocated, so
+ * growing the buffer never moves what was already written, and the
+ * chunks are written to the output file (see OutputFile) with one
+ * gathered write instead of being joined into a string first. Indentation prefixes
+ * are cached, so indenting a line is a single copy.
+ *
+ * Pieces are appended as string_views or integers; lines are written
+ * as a list of pieces rather than built by string concatenation.
+ */
+class CodeBuffer {
+public:
+    /**
+     * @param indentUnit Text of one indentation level
+     */
+    explicit CodeBuffer(std::string_view indentUnit = "    ");
+
+    CodeBuffer(const CodeBuffer&) = delete;
+    CodeBuffer& operator=(const CodeBuffer&) = delete;
+
+    /**
+     * @brief Append the pieces, each a string_view-convertible or an integer
+     */
+    template<typename... Parts>
+    void append(const Parts&... parts) {
+        (appendPart(parts), ...);
+    }
+
+    /**
+     * @brief Append the indentation prefix of the given level
+     */
+    void appendIndent(int level);
+
+    /**
+     * @brief Append an indented line; an empty line is not indented
+     */
+    template<typename... Parts>
+    void line(int level, const Parts&... parts) {
+        if constexpr (sizeof...(Parts) > 0) {
+            appendIndent(level);
+            (appendPart(parts), ...);
+        }
+        appendPart('\n');
+    }
+
+    /**
+     * @brief Discard the contents, keeping the first chunk for reuse
+     */
+    void clear();
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Copy the contents into a string
+     */
+    std::string str() const;
+
+    /**
+     * @brief Call fn with each non-empty chunk, as a string_view, in order
+     */
+    template<typename Fn>
+    void forEachChunk(Fn&& fn) const {
+        for (const auto& chunk : chunks_) {
+            if (chunk.size > 0) {
+                fn(std::string_view(chunk.data.get(), chunk.size));
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t size_ = 0;
+    std::string indentUnit_;
+    std::string indentCache_;  // indentUnit_ repeated for the deepest level seen
+
+    void appendPart(std::string_view text);
+    void appendPart(char c);
+
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                                     !std::is_same_v<T, char>>>
+    void appendPart(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        appendPart(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    // Start a new chunk; the last one is full
+    Chunk& grow();
+};
+
+} // namespace iborb::generator
+
+#endif // IBORB_IDL_CODE_BUFFER_HPP
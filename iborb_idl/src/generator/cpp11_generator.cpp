@@ -1,87 +1,248 @@
 #include "generator/cpp11_generator.hpp"
+#include "generator/output_file.hpp"
 #include <algorithm>
 #include <cctype>
-#include <iomanip>
+#include <cstdio>
+#include <cstring>
 
 namespace iborb::generator {
 
 using namespace ast;
 
 Cpp11Generator::Cpp11Generator(GeneratorConfig config)
-    : config_(std::move(config)) {
+    : config_(std::move(config)), header_(config_.indent), source_(config_.indent),
+      prologue_(config_.indent), headerOut_(&header_), umbrella_(config_.indent) {
 }
 
+Cpp11Generator::~Cpp11Generator() = default;
+
 void Cpp11Generator::setSymbolTable(const semantic::SymbolTable* symTable) {
     symbolTable_ = symTable;
 }
 
 bool Cpp11Generator::generate(const TranslationUnit& unit) {
+    beginUnit(unit.filename);
+    sourceManager_ = unit.sourceManager.get();
+
+    // Process all definitions, including those of imported headers
+    unit.forEachDefinition([this, &unit](const TranslationUnit& owner, DefinitionNode& def) {
+        sourceManager_ = owner.sourceManager.get();
+        imported_ = &owner != &unit;
+        dispatch(def);
+    });
+    imported_ = false;
+
+    endUnit();
+    generatePrologues();
+
+    // Write files now unless the caller commits them later
+    if (!config_.deferWrite) {
+        writeFiles();
+    }
+
+    return errors_.empty();
+}
+
+void Cpp11Generator::beginStream(const std::string& filename) {
+    beginUnit(filename);
+
+    // The header is written out before its definitions are seen, so it
+    // includes every standard header generated code may use
+    if (config_.addIncludeGuards) {
+        generateIncludeGuardBegin(baseName_);
+    }
+    generateStandardIncludes(kAllStandardHeaders);
+    writeHeaderLine();
+
+    streamedHeader_.reset();
+    if (!config_.outputDir.empty()) {
+        std::filesystem::create_directories(config_.outputDir);
+        streamedHeader_ = std::make_unique<OutputFile>(outputPath(config_.headerExtension));
+    }
+}
+
+void Cpp11Generator::beginModule(Name name) {
+    generateNamespaceBegin(name.str());
+}
+
+void Cpp11Generator::endModule() {
+    generateNamespaceEnd();
+}
+
+void Cpp11Generator::streamDefinition(DefinitionNode& definition,
+                                      const source::SourceManager* sourceManager, bool imported) {
+    sourceManager_ = sourceManager;
+    imported_ = imported;
+    dispatch(definition);
+    imported_ = false;
+
+    // Hand complete chunks to the file rather than keeping the whole header
+    if (streamedHeader_ && header_.size() >= kStreamFlushSize) {
+        streamedHeader_->write(header_);
+        header_.clear();
+    }
+}
+
+bool Cpp11Generator::endStream(bool commit) {
+    endUnit();
+
+    if (!commit || !streamedHeader_) {
+        // Dropping the header discards what was written so far
+        streamedHeader_.reset();
+        return errors_.empty();
+    }
+
+    streamedHeader_->write(header_);
+    header_.clear();
+    if (!config_.deferWrite) {
+        writeFiles();
+    }
+    return errors_.empty();
+}
+
+void Cpp11Generator::beginUnit(const std::string& filename) {
     errors_.clear();
-    header_.str("");
-    source_.str("");
+    outputFiles_.clear();
+    header_.clear();
+    source_.clear();
+    headerOut_ = &header_;
+    standardHeaders_ = 0;
     indentLevel_ = 0;
     namespaceStack_.clear();
+    baseName_ = std::filesystem::path(filename).stem().string();
+    prologue_.clear();
+    umbrella_.clear();
+    typeHeaders_.clear();
+    typeHeader_ = nullptr;
+    typeHeaderIndex_.clear();
+    typedefs_.clear();
+    interfaceName_ = {};
+    instantiations_.clear();
+    instantiated_.clear();
+    namedTypes_.clear();
+
+    if (outOfLine()) {
+        writeSourceLine("#include \"", baseName_, config_.headerExtension, "\"");
+    }
+}
 
-    // Extract base filename
-    std::filesystem::path path(unit.filename);
-    std::string baseName = path.stem().string();
-
-    // Generate header file
+void Cpp11Generator::endUnit() {
+    if (!config_.splitHeaders) {
+        generateExternTemplates(instantiations_);
+    }
     if (config_.addIncludeGuards) {
-        generateIncludeGuardBegin(baseName);
+        generateIncludeGuardEnd();
     }
 
-    generateIncludes();
-    writeHeaderLine();
+    if (!instantiations_.empty()) {
+        writeSourceLine();
+        for (const auto& type : instantiations_) {
+            writeSourceLine("template class ", type, ";");
+        }
+    }
+}
 
-    // Process all definitions
-    for (const auto& def : unit.definitions) {
-        def->accept(*this);
+void Cpp11Generator::generatePrologues() {
+    if (config_.splitHeaders) {
+        generateSplitHeaders();
+        return;
     }
 
+    // Only now that the code is generated are the headers it needs known
+    headerOut_ = &prologue_;
     if (config_.addIncludeGuards) {
-        generateIncludeGuardEnd();
+        generateIncludeGuardBegin(baseName_);
+    }
+    if (standardHeaders_ != 0) {
+        generateStandardIncludes(standardHeaders_);
+        writeHeaderLine();
     }
+    headerOut_ = &header_;
+}
 
-    headerContent_ = header_.str();
-    sourceContent_ = source_.str();
+std::string Cpp11Generator::outputPath(const std::string& extension) const {
+    return (std::filesystem::path(config_.outputDir) / (baseName_ + extension)).string();
+}
 
-    // Write files if output directory is specified
-    if (!config_.outputDir.empty()) {
-        std::filesystem::path outDir(config_.outputDir);
-        std::filesystem::create_directories(outDir);
+bool Cpp11Generator::writeFiles() {
+    if (config_.outputDir.empty()) {
+        return errors_.empty();
+    }
+
+    std::filesystem::create_directories(config_.outputDir);
 
-        std::string headerPath = (outDir / (baseName + config_.headerExtension)).string();
-        std::ofstream headerFile(headerPath);
-        if (headerFile) {
-            headerFile << headerContent_;
+    // A streamed header is already written, and only needs to be put in place
+    if (auto header = std::move(streamedHeader_)) {
+        if (!header->commit()) {
+            addError("Failed to write header file: " + header->getPath());
         } else {
-            addError("Failed to write header file: " + headerPath);
+            outputFiles_.push_back(header->getPath());
+            if (header->isUnchanged()) {
+                ++unchangedFiles_;
+            }
         }
+        writeSourceFile();
+        return errors_.empty();
+    }
 
-        if (config_.generateImplementation && !sourceContent_.empty()) {
-            std::string sourcePath = (outDir / (baseName + config_.sourceExtension)).string();
-            std::ofstream sourceFile(sourcePath);
-            if (sourceFile) {
-                sourceFile << sourceContent_;
-            } else {
-                addError("Failed to write source file: " + sourcePath);
+    if (config_.splitHeaders) {
+        std::string forwardPath = (std::filesystem::path(config_.outputDir) / forwardHeaderName()).string();
+        if (!writeFileIfChanged(forwardPath, {&prologue_, &header_})) {
+            addError("Failed to write header file: " + forwardPath);
+        }
+        for (const auto& type : typeHeaders_) {
+            std::string typePath = (std::filesystem::path(config_.outputDir) / type->filename).string();
+            if (!writeFileIfChanged(typePath, {&type->prologue, &type->code})) {
+                addError("Failed to write header file: " + typePath);
             }
         }
     }
 
+    std::string headerPath = outputPath(config_.headerExtension);
+    bool written = config_.splitHeaders ? writeFileIfChanged(headerPath, {&umbrella_})
+                                        : writeFileIfChanged(headerPath, {&prologue_, &header_});
+    if (!written) {
+        addError("Failed to write header file: " + headerPath);
+    }
+    writeSourceFile();
+
     return errors_.empty();
 }
 
+void Cpp11Generator::writeSourceFile() {
+    if (config_.generateImplementation && !source_.empty()) {
+        std::string sourcePath = outputPath(config_.sourceExtension);
+        if (!writeFileIfChanged(sourcePath, {&source_})) {
+            addError("Failed to write source file: " + sourcePath);
+        }
+    }
+}
+
+bool Cpp11Generator::writeFileIfChanged(const std::string& path,
+                                        std::initializer_list<const CodeBuffer*> parts) {
+    OutputFile file(path);
+    for (const CodeBuffer* part : parts) {
+        file.write(*part);
+    }
+    if (!file.commit()) {
+        return false;
+    }
+    outputFiles_.push_back(path);
+    if (file.isUnchanged()) {
+        ++unchangedFiles_;
+    }
+    return true;
+}
+
 // ============================================================================
 // Visitor Implementation
 // ============================================================================
 
 void Cpp11Generator::visit(ModuleNode& node) {
-    generateNamespaceBegin(node.name);
+    generateNamespaceBegin(node.name.str());
 
     for (auto& def : node.definitions) {
-        def->accept(*this);
+        dispatch(*def);
     }
 
     generateNamespaceEnd();
@@ -90,12 +251,14 @@ void Cpp11Generator::visit(ModuleNode& node) {
 void Cpp11Generator::visit(InterfaceNode& node) {
     if (node.isForward) {
         // Forward declaration
-        writeHeaderLine("class " + node.name + ";");
+        writeHeaderLine("class ", node.name.str(), ";");
         writeHeaderLine();
         return;
     }
 
+    beginTypeHeader(node, "class ");
     generateInterface(node);
+    endTypeHeader();
 }
 
 void Cpp11Generator::visit(OperationNode& node) {
@@ -111,7 +274,9 @@ void Cpp11Generator::visit(AttributeNode& node) {
 }
 
 void Cpp11Generator::visit(StructNode& node) {
+    beginTypeHeader(node, "struct ");
     generateStruct(node);
+    endTypeHeader();
 }
 
 void Cpp11Generator::visit(StructMemberNode& node) {
@@ -131,54 +296,39 @@ void Cpp11Generator::visit(ConstNode& node) {
 }
 
 void Cpp11Generator::visit(ExceptionNode& node) {
+    beginTypeHeader(node, "class ");
     generateException(node);
+    endTypeHeader();
 }
 
 void Cpp11Generator::visit(UnionNode& node) {
+    beginTypeHeader(node, "class ");
     generateUnion(node);
+    endTypeHeader();
 }
 
 void Cpp11Generator::visit(UnionCaseNode& node) {
     // Union cases are handled within generateUnion
 }
 
-void Cpp11Generator::visit(BasicTypeNode& node) {
-    currentTypeName_ = mapBasicType(node.type);
+void Cpp11Generator::visit(BasicTypeNode&) {
+    // Spelled by semantic::TypeResolver, read through mapType()
 }
 
-void Cpp11Generator::visit(SequenceTypeNode& node) {
-    std::string elemType = mapType(node.elementType.get());
-    currentTypeName_ = "std::vector<" + elemType + ">";
+void Cpp11Generator::visit(SequenceTypeNode&) {
+    // Spelled by semantic::TypeResolver, read through mapType()
 }
 
-void Cpp11Generator::visit(StringTypeNode& node) {
-    if (node.isWide) {
-        currentTypeName_ = "std::wstring";
-    } else {
-        currentTypeName_ = "std::string";
-    }
+void Cpp11Generator::visit(StringTypeNode&) {
+    // Spelled by semantic::TypeResolver, read through mapType()
 }
 
-void Cpp11Generator::visit(ScopedNameNode& node) {
-    // Build the C++ scoped name
-    std::string result;
-    if (node.isAbsolute) {
-        result = "::";
-    }
-    for (size_t i = 0; i < node.parts.size(); ++i) {
-        if (i > 0) result += "::";
-        result += node.parts[i];
-    }
-    currentTypeName_ = result;
+void Cpp11Generator::visit(ScopedNameNode&) {
+    // Spelled by semantic::TypeResolver, read through mapType()
 }
 
-void Cpp11Generator::visit(ArrayTypeNode& node) {
-    std::string elemType = mapType(node.elementType.get());
-    // Use std::array for fixed-size arrays
-    for (auto it = node.dimensions.rbegin(); it != node.dimensions.rend(); ++it) {
-        elemType = "std::array<" + elemType + ", " + std::to_string(*it) + ">";
-    }
-    currentTypeName_ = elemType;
+void Cpp11Generator::visit(ArrayTypeNode&) {
+    // Spelled by semantic::TypeResolver, read through mapType()
 }
 
 // ============================================================================
@@ -195,77 +345,27 @@ void Cpp11Generator::outdent() {
     }
 }
 
-std::string Cpp11Generator::getIndent() const {
-    std::string result;
-    for (int i = 0; i < indentLevel_; ++i) {
-        result += config_.indent;
-    }
-    return result;
-}
-
-void Cpp11Generator::writeHeader(const std::string& text) {
-    header_ << text;
-}
-
-void Cpp11Generator::writeHeaderLine(const std::string& line) {
-    if (!line.empty()) {
-        header_ << getIndent() << line;
-    }
-    header_ << "\n";
-}
-
-void Cpp11Generator::writeSource(const std::string& text) {
-    source_ << text;
-}
-
-void Cpp11Generator::writeSourceLine(const std::string& line) {
-    if (!line.empty()) {
-        source_ << getIndent() << line;
-    }
-    source_ << "\n";
-}
 
 // ============================================================================
 // Type Mapping
 // ============================================================================
 
-std::string Cpp11Generator::mapBasicType(BasicType type) const {
-    switch (type) {
-        case BasicType::Void:       return "void";
-        case BasicType::Boolean:    return "bool";
-        case BasicType::Char:       return "char";
-        case BasicType::WChar:      return "wchar_t";
-        case BasicType::Octet:      return "uint8_t";
-        case BasicType::Short:      return "int16_t";
-        case BasicType::UShort:     return "uint16_t";
-        case BasicType::Long:       return "int32_t";
-        case BasicType::ULong:      return "uint32_t";
-        case BasicType::LongLong:   return "int64_t";
-        case BasicType::ULongLong:  return "uint64_t";
-        case BasicType::Float:      return "float";
-        case BasicType::Double:     return "double";
-        case BasicType::LongDouble: return "long double";
-        case BasicType::Any:        return "std::any";
-        case BasicType::Object:     return "Object";
-    }
-    return "void";
-}
-
-std::string Cpp11Generator::mapType(TypeNode* node) {
-    if (!node) return "void";
-    
-    currentTypeName_.clear();
-    node->accept(*this);
-    return currentTypeName_;
+const std::string& Cpp11Generator::mapType(TypeNode* node) {
+    static const std::string kVoid = "void";
+    if (!node) {
+        return kVoid;
+    }
+    useStandardHeaders(node);
+    return node->resolvedCppType.str();
 }
 
-std::string Cpp11Generator::mapTypeForParameter(TypeNode* node, ParamDirection dir) {
-    std::string baseType = mapType(node);
-    
+void Cpp11Generator::writeParameterType(TypeNode* node, ParamDirection dir) {
+    const std::string& baseType = mapType(node);
+
     // For 'in' parameters, use const reference for complex types
     if (dir == ParamDirection::In) {
         // Check if it's a simple type (basic types that should be passed by value)
-        if (auto* basic = dynamic_cast<BasicTypeNode*>(node)) {
+        if (auto* basic = dyn_cast<BasicTypeNode>(node)) {
             switch (basic->type) {
                 case BasicType::Boolean:
                 case BasicType::Char:
@@ -280,31 +380,71 @@ std::string Cpp11Generator::mapTypeForParameter(TypeNode* node, ParamDirection d
                 case BasicType::Float:
                 case BasicType::Double:
                 case BasicType::LongDouble:
-                    return baseType;  // Pass by value
+                    writeHeader(baseType);  // Pass by value
+                    return;
                 default:
                     break;
             }
         }
         // Complex types: pass by const reference
-        return "const " + baseType + "&";
+        writeHeader("const ", baseType, "&");
+        return;
     }
-    
+
     // For 'out' and 'inout' parameters, use reference
-    return baseType + "&";
+    writeHeader(baseType, "&");
 }
 
-std::string Cpp11Generator::mapTypeForReturn(TypeNode* node) {
+const std::string& Cpp11Generator::mapTypeForReturn(TypeNode* node) {
     return mapType(node);
 }
 
+void Cpp11Generator::useStandardHeaders(const TypeNode* node) {
+    if (auto* basic = dyn_cast<BasicTypeNode>(node)) {
+        switch (basic->type) {
+            case BasicType::Octet:
+            case BasicType::Short:
+            case BasicType::UShort:
+            case BasicType::Long:
+            case BasicType::ULong:
+            case BasicType::LongLong:
+            case BasicType::ULongLong:
+                useStandardHeader(kCstdint);
+                break;
+            case BasicType::Any:
+                useStandardHeader(kAny);
+                break;
+            default:
+                break;
+        }
+    } else if (auto* sequence = dyn_cast<SequenceTypeNode>(node)) {
+        useStandardHeader(kVector);
+        if (sequence->elementType) {
+            useStandardHeaders(sequence->elementType);
+        }
+    } else if (auto* array = dyn_cast<ArrayTypeNode>(node)) {
+        useStandardHeader(kArray);
+        if (array->elementType) {
+            useStandardHeaders(array->elementType);
+        }
+    } else if (isa<StringTypeNode>(node)) {
+        useStandardHeader(kString);
+    }
+    // Named types are defined in generated code, which has its own includes
+}
+
+void Cpp11Generator::useStandardHeader(StandardHeader header) {
+    (typeHeader_ ? typeHeader_->standardHeaders : standardHeaders_) |= header;
+}
+
 // ============================================================================
 // Code Generation Helpers
 // ============================================================================
 
 void Cpp11Generator::generateIncludeGuardBegin(const std::string& filename) {
     std::string guard = makeIncludeGuard(filename);
-    writeHeaderLine("#ifndef " + guard);
-    writeHeaderLine("#define " + guard);
+    writeHeaderLine("#ifndef ", guard);
+    writeHeaderLine("#define ", guard);
     writeHeaderLine();
 }
 
@@ -314,24 +454,27 @@ void Cpp11Generator::generateIncludeGuardEnd() {
     writeHeaderLine("#endif // Include guard");
 }
 
-void Cpp11Generator::generateIncludes() {
-    writeHeaderLine("#include <cstdint>");
-    writeHeaderLine("#include <string>");
-    writeHeaderLine("#include <vector>");
-    writeHeaderLine("#include <array>");
-    writeHeaderLine("#include <memory>");
-    writeHeaderLine("#include <stdexcept>");
+void Cpp11Generator::generateStandardIncludes(unsigned headers) {
+    static constexpr std::pair<StandardHeader, std::string_view> kIncludes[] = {
+        {kCstdint, "<cstdint>"}, {kString, "<string>"}, {kVector, "<vector>"}, {kArray, "<array>"},
+        {kMemory, "<memory>"}, {kException, "<exception>"}, {kAny, "<any>"},
+    };
+    for (const auto& [header, include] : kIncludes) {
+        if (headers & header) {
+            writeHeaderLine("#include ", include);
+        }
+    }
 }
 
 void Cpp11Generator::generateNamespaceBegin(const std::string& name) {
     writeHeaderLine();
-    writeHeaderLine("namespace " + name + " {");
+    writeHeaderLine("namespace ", name, " {");
     writeHeaderLine();
     namespaceStack_.push_back(name);
     
     if (config_.generateImplementation) {
         writeSourceLine();
-        writeSourceLine("namespace " + name + " {");
+        writeSourceLine("namespace ", name, " {");
         writeSourceLine();
     }
 }
@@ -339,11 +482,11 @@ void Cpp11Generator::generateNamespaceBegin(const std::string& name) {
 void Cpp11Generator::generateNamespaceEnd() {
     if (!namespaceStack_.empty()) {
         writeHeaderLine();
-        writeHeaderLine("} // namespace " + namespaceStack_.back());
+        writeHeaderLine("} // namespace ", namespaceStack_.back());
         
         if (config_.generateImplementation) {
             writeSourceLine();
-            writeSourceLine("} // namespace " + namespaceStack_.back());
+            writeSourceLine("} // namespace ", namespaceStack_.back());
         }
         
         namespaceStack_.pop_back();
@@ -353,46 +496,58 @@ void Cpp11Generator::generateNamespaceEnd() {
 void Cpp11Generator::generateStruct(StructNode& node) {
     if (config_.addDoxygen) {
         writeHeaderLine("/**");
-        writeHeaderLine(" * @brief IDL struct " + node.name);
-        std::string srcLoc = formatSourceLocation(node.location);
+        writeHeaderLine(" * @brief IDL struct ", node.name.str());
+        const std::string& srcLoc = formatSourceLocation(node.location);
         if (!srcLoc.empty()) {
-            writeHeaderLine(" * @idlsource " + srcLoc);
+            writeHeaderLine(" * @idlsource ", srcLoc);
         }
         writeHeaderLine(" */");
     }
     
-    writeHeaderLine("struct " + node.name + " {");
+    defineNamedType(node, qualifiedName(node.name));
+    writeHeaderLine("struct ", node.name.str(), " {");
     indent();
 
     for (const auto& member : node.members) {
-        std::string type = mapType(member->type.get());
-        writeHeaderLine(type + " " + member->name + ";");
+        writeHeaderLine(mapType(member->type), " ", member->name.str(), ";");
+        requireDefinition(member->type);
+        instantiateSequences(member->type);
     }
 
     // Generate equality operator
     writeHeaderLine();
-    writeHeaderLine("bool operator==(const " + node.name + "& other) const {");
-    indent();
-    if (node.members.empty()) {
-        writeHeaderLine("(void)other;");
-        writeHeaderLine("return true;");
-    } else {
-        std::string comparison;
-        for (size_t i = 0; i < node.members.size(); ++i) {
-            if (i > 0) comparison += " && ";
-            comparison += node.members[i]->name + " == other." + node.members[i]->name;
+    if (outOfLine()) {
+        writeHeaderLine("bool operator==(const ", node.name.str(), "& other) const;");
+        writeHeaderLine("bool operator!=(const ", node.name.str(), "& other) const;");
+
+        // The output of the included file defines its structs' operators;
+        // defining them here too would clash when both are linked
+        if (!isIncluded(node)) {
+            std::string qualified = inInterfaceDecl_ ? interfaceName_.str() + "::" + node.name.str()
+                                                     : node.name.str();
+            source_.line(0, "bool ", qualified, "::operator==(const ", node.name.str(), "& other) const {");
+            writeEqualityBody(source_, 1, node);
+            source_.line(0, "}");
+            source_.line(0);
+            source_.line(0, "bool ", qualified, "::operator!=(const ", node.name.str(), "& other) const {");
+            source_.line(1, "return !(*this == other);");
+            source_.line(0, "}");
+            source_.line(0);
         }
-        writeHeaderLine("return " + comparison + ";");
-    }
-    outdent();
-    writeHeaderLine("}");
+    } else {
+        writeHeaderLine("bool operator==(const ", node.name.str(), "& other) const {");
+        indent();
+        writeEqualityBody(*headerOut_, indentLevel_, node);
+        outdent();
+        writeHeaderLine("}");
 
-    writeHeaderLine();
-    writeHeaderLine("bool operator!=(const " + node.name + "& other) const {");
-    indent();
-    writeHeaderLine("return !(*this == other);");
-    outdent();
-    writeHeaderLine("}");
+        writeHeaderLine();
+        writeHeaderLine("bool operator!=(const ", node.name.str(), "& other) const {");
+        indent();
+        writeHeaderLine("return !(*this == other);");
+        outdent();
+        writeHeaderLine("}");
+    }
 
     outdent();
     writeHeaderLine("};");
@@ -402,99 +557,95 @@ void Cpp11Generator::generateStruct(StructNode& node) {
 void Cpp11Generator::generateInterface(InterfaceNode& node) {
     if (config_.addDoxygen) {
         writeHeaderLine("/**");
-        writeHeaderLine(" * @brief IDL interface " + node.name);
+        writeHeaderLine(" * @brief IDL interface ", node.name.str());
         if (node.isAbstract) {
             writeHeaderLine(" * @note This is an abstract interface");
         }
-        std::string srcLoc = formatSourceLocation(node.location);
+        const std::string& srcLoc = formatSourceLocation(node.location);
         if (!srcLoc.empty()) {
-            writeHeaderLine(" * @idlsource " + srcLoc);
+            writeHeaderLine(" * @idlsource ", srcLoc);
         }
         writeHeaderLine(" */");
     }
 
-    // Build class declaration
-    std::string decl = "class " + node.name;
-    if (!node.baseInterfaces.empty()) {
-        decl += " : ";
-        for (size_t i = 0; i < node.baseInterfaces.size(); ++i) {
-            if (i > 0) decl += ", ";
-            decl += "public virtual " + node.baseInterfaces[i];
-        }
+    // Class declaration
+    headerOut_->appendIndent(indentLevel_);
+    writeHeader("class ", node.name.str());
+    for (size_t i = 0; i < node.baseInterfaces.size(); ++i) {
+        writeHeader(i > 0 ? ", " : " : ", "public virtual ", node.baseInterfaces[i]);
+        requireBaseInterface(node.baseInterfaces[i]);
     }
-    
-    writeHeaderLine(decl + " {");
+    writeHeader(" {\n");
     writeHeaderLine("public:");
     indent();
 
     // Virtual destructor
-    writeHeaderLine("virtual ~" + node.name + "() = default;");
+    writeHeaderLine("virtual ~", node.name.str(), "() = default;");
     writeHeaderLine();
 
     inInterfaceDecl_ = true;
+    interfaceName_ = node.name;
 
     // Generate operations and attributes
     for (const auto& content : node.contents) {
-        if (auto* op = dynamic_cast<OperationNode*>(content.get())) {
-            // Generate operation signature
-            std::string returnType = mapTypeForReturn(op->returnType.get());
-            std::string sig = "virtual " + returnType + " " + op->name + "(";
-
-            for (size_t i = 0; i < op->parameters.size(); ++i) {
-                if (i > 0) sig += ", ";
-                auto& param = op->parameters[i];
-                sig += mapTypeForParameter(param->type.get(), param->direction);
-                sig += " " + param->name;
-            }
-            sig += ") = 0;";
-
+        if (auto* op = dyn_cast<OperationNode>(content)) {
             if (config_.addDoxygen && !op->parameters.empty()) {
                 writeHeaderLine("/**");
-                writeHeaderLine(" * @brief " + op->name + " operation");
+                writeHeaderLine(" * @brief ", op->name.str(), " operation");
                 for (const auto& param : op->parameters) {
-                    std::string dirStr;
+                    std::string_view dirStr;
                     switch (param->direction) {
                         case ParamDirection::In: dirStr = "[in]"; break;
                         case ParamDirection::Out: dirStr = "[out]"; break;
                         case ParamDirection::InOut: dirStr = "[in,out]"; break;
                     }
-                    writeHeaderLine(" * @param " + param->name + " " + dirStr);
+                    writeHeaderLine(" * @param ", param->name.str(), " ", dirStr);
                 }
                 writeHeaderLine(" */");
             }
-            writeHeaderLine(sig);
+
+            // Operation signature
+            headerOut_->appendIndent(indentLevel_);
+            writeHeader("virtual ", mapTypeForReturn(op->returnType), " ", op->name.str(), "(");
+            for (size_t i = 0; i < op->parameters.size(); ++i) {
+                if (i > 0) writeHeader(", ");
+                auto& param = op->parameters[i];
+                writeParameterType(param->type, param->direction);
+                writeHeader(" ", param->name.str());
+            }
+            writeHeader(") = 0;\n");
             writeHeaderLine();
         }
-        else if (auto* attr = dynamic_cast<AttributeNode*>(content.get())) {
+        else if (auto* attr = dyn_cast<AttributeNode>(content)) {
             // Generate getter
-            std::string type = mapType(attr->type.get());
-            
+            const std::string& type = mapType(attr->type);
+
             if (config_.addDoxygen) {
                 writeHeaderLine("/**");
-                writeHeaderLine(" * @brief Get " + attr->name + " attribute");
+                writeHeaderLine(" * @brief Get ", attr->name.str(), " attribute");
                 writeHeaderLine(" */");
             }
-            writeHeaderLine("virtual " + type + " " + attr->name + "() const = 0;");
+            writeHeaderLine("virtual ", type, " ", attr->name.str(), "() const = 0;");
 
             // Generate setter if not readonly
             if (!attr->isReadonly) {
                 if (config_.addDoxygen) {
                     writeHeaderLine("/**");
-                    writeHeaderLine(" * @brief Set " + attr->name + " attribute");
+                    writeHeaderLine(" * @brief Set ", attr->name.str(), " attribute");
                     writeHeaderLine(" */");
                 }
-                writeHeaderLine("virtual void " + attr->name + "(const " + type + "& value) = 0;");
+                writeHeaderLine("virtual void ", attr->name.str(), "(const ", type, "& value) = 0;");
             }
             writeHeaderLine();
         }
-        else if (auto* nestedStruct = dynamic_cast<StructNode*>(content.get())) {
+        else if (auto* nestedStruct = dyn_cast<StructNode>(content)) {
             // Nested type
             outdent();
             writeHeaderLine();
             generateStruct(*nestedStruct);
             indent();
         }
-        else if (auto* nestedEnum = dynamic_cast<EnumNode*>(content.get())) {
+        else if (auto* nestedEnum = dyn_cast<EnumNode>(content)) {
             outdent();
             writeHeaderLine();
             generateEnum(*nestedEnum);
@@ -508,9 +659,10 @@ void Cpp11Generator::generateInterface(InterfaceNode& node) {
     writeHeaderLine("};");
     writeHeaderLine();
 
-    // Generate smart pointer typedef
-    if (config_.useSmartPointers) {
-        writeHeaderLine("using " + node.name + "Ptr = std::shared_ptr<" + node.name + ">;");
+    // Generate smart pointer typedef; split headers have it in the forward header
+    if (config_.useSmartPointers && !config_.splitHeaders) {
+        useStandardHeader(kMemory);
+        writeHeaderLine("using ", node.name.str(), "Ptr = std::shared_ptr<", node.name.str(), ">;");
         writeHeaderLine();
     }
 }
@@ -518,23 +670,20 @@ void Cpp11Generator::generateInterface(InterfaceNode& node) {
 void Cpp11Generator::generateEnum(EnumNode& node) {
     if (config_.addDoxygen) {
         writeHeaderLine("/**");
-        writeHeaderLine(" * @brief IDL enum " + node.name);
-        std::string srcLoc = formatSourceLocation(node.location);
+        writeHeaderLine(" * @brief IDL enum ", node.name.str());
+        const std::string& srcLoc = formatSourceLocation(node.location);
         if (!srcLoc.empty()) {
-            writeHeaderLine(" * @idlsource " + srcLoc);
+            writeHeaderLine(" * @idlsource ", srcLoc);
         }
         writeHeaderLine(" */");
     }
     
-    writeHeaderLine("enum class " + node.name + " {");
+    defineNamedType(node, qualifiedName(node.name));
+    writeHeaderLine("enum class ", node.name.str(), " {");
     indent();
 
     for (size_t i = 0; i < node.enumerators.size(); ++i) {
-        std::string line = node.enumerators[i];
-        if (i < node.enumerators.size() - 1) {
-            line += ",";
-        }
-        writeHeaderLine(line);
+        writeHeaderLine(node.enumerators[i].str(), i < node.enumerators.size() - 1 ? "," : "");
     }
 
     outdent();
@@ -543,59 +692,94 @@ void Cpp11Generator::generateEnum(EnumNode& node) {
 }
 
 void Cpp11Generator::generateTypedef(TypedefNode& node) {
-    std::string baseType = mapType(node.originalType.get());
+    const std::string& baseType = mapType(node.originalType);
+
+    // A typedef can be an element like the type it aliases. It is spelled
+    // as that type, so that an instantiation is only named one way.
+    std::string aliased;
+    bool userDefined = false;
+    bool instantiable = outOfLine() && spellGlobal(node.originalType, aliased, userDefined);
+    std::vector<std::string> sequences;
+    if (instantiable) {
+        collectSequences(node.originalType, sequences);
+    }
 
     for (const auto& decl : node.declarators) {
-        std::string finalType = baseType;
-        
-        // Handle array dimensions: typedef octet UUID[16] -> std::array<uint8_t, 16>
-        if (!decl.arrayDimensions.empty()) {
-            // Build nested std::array from innermost to outermost
+        if (config_.splitHeaders) {
+            typedefs_.emplace(qualifiedName(decl.name).view(), node.originalType);
+        }
+        if (instantiable) {
+            NamedType alias;
+            alias.userDefined = userDefined;
+            alias.included = elementIncluded(node.originalType);
+            alias.sequences = sequences;
+            for (size_t i = 0; i < decl.arrayDimensions.size(); ++i) {
+                alias.spelling += "std::array<";
+            }
+            alias.spelling += aliased;
             for (auto it = decl.arrayDimensions.rbegin(); it != decl.arrayDimensions.rend(); ++it) {
-                finalType = "std::array<" + finalType + ", " + std::to_string(*it) + ">";
+                alias.spelling.append(", ").append(std::to_string(*it)).append(">");
             }
+            defineNamedType(qualifiedName(decl.name), std::move(alias));
+        }
+        if (!decl.arrayDimensions.empty()) {
+            useStandardHeader(kArray);
         }
-        
         if (config_.addDoxygen) {
-            writeHeaderLine("/** @brief IDL typedef " + decl.name + " @idlsource " + 
-                           formatSourceLocation(node.location) + " */");
+            writeHeaderLine("/** @brief IDL typedef ", decl.name.str(), " @idlsource ",
+                            formatSourceLocation(node.location), " */");
+        }
+
+        // Array dimensions nest std::array, outermost first:
+        // typedef octet M[2][16] -> std::array<std::array<uint8_t, 16>, 2>
+        headerOut_->appendIndent(indentLevel_);
+        writeHeader("using ", decl.name.str(), " = ");
+        for (size_t i = 0; i < decl.arrayDimensions.size(); ++i) {
+            writeHeader("std::array<");
+        }
+        writeHeader(baseType);
+        for (auto it = decl.arrayDimensions.rbegin(); it != decl.arrayDimensions.rend(); ++it) {
+            writeHeader(", ", *it, ">");
         }
-        writeHeaderLine("using " + decl.name + " = " + finalType + ";");
+        writeHeader(";\n");
     }
     writeHeaderLine();
 }
 
 void Cpp11Generator::generateConst(ConstNode& node) {
-    std::string type = mapType(node.type.get());
-    std::string value = constValueToString(node.value);
-
     if (config_.addDoxygen) {
-        writeHeaderLine("/** @brief IDL const " + node.name + " @idlsource " + 
-                       formatSourceLocation(node.location) + " */");
+        writeHeaderLine("/** @brief IDL const ", node.name.str(), " @idlsource ",
+                        formatSourceLocation(node.location), " */");
     }
-    writeHeaderLine("constexpr " + type + " " + node.name + " = " + value + ";");
+    headerOut_->appendIndent(indentLevel_);
+    writeHeader("constexpr ", mapType(node.type), " ", node.name.str(), " = ");
+    writeConstValue(node.value);
+    writeHeader(";\n");
     writeHeaderLine();
 }
 
 void Cpp11Generator::generateException(ExceptionNode& node) {
     if (config_.addDoxygen) {
         writeHeaderLine("/**");
-        writeHeaderLine(" * @brief IDL exception " + node.name);
-        std::string srcLoc = formatSourceLocation(node.location);
+        writeHeaderLine(" * @brief IDL exception ", node.name.str());
+        const std::string& srcLoc = formatSourceLocation(node.location);
         if (!srcLoc.empty()) {
-            writeHeaderLine(" * @idlsource " + srcLoc);
+            writeHeaderLine(" * @idlsource ", srcLoc);
         }
         writeHeaderLine(" */");
     }
     
-    writeHeaderLine("class " + node.name + " : public std::exception {");
+    useStandardHeader(kException);
+    defineNamedType(node, qualifiedName(node.name));
+    writeHeaderLine("class ", node.name.str(), " : public std::exception {");
     writeHeaderLine("public:");
     indent();
 
     // Members
     for (const auto& member : node.members) {
-        std::string type = mapType(member->type.get());
-        writeHeaderLine(type + " " + member->name + ";");
+        writeHeaderLine(mapType(member->type), " ", member->name.str(), ";");
+        requireDefinition(member->type);
+        instantiateSequences(member->type);
     }
 
     if (!node.members.empty()) {
@@ -604,30 +788,32 @@ void Cpp11Generator::generateException(ExceptionNode& node) {
 
     // Constructor
     if (!node.members.empty()) {
-        std::string params;
-        std::string inits;
+        headerOut_->appendIndent(indentLevel_);
+        writeHeader(node.name.str(), "(");
         for (size_t i = 0; i < node.members.size(); ++i) {
-            if (i > 0) {
-                params += ", ";
-                inits += ", ";
-            }
-            std::string type = mapType(node.members[i]->type.get());
-            params += "const " + type + "& " + node.members[i]->name + "_";
-            inits += node.members[i]->name + "(" + node.members[i]->name + "_)";
+            const auto& member = node.members[i];
+            writeHeader(i > 0 ? ", " : "", "const ", mapType(member->type), "& ", member->name.str(), "_");
         }
-        writeHeaderLine(node.name + "(" + params + ")");
-        writeHeaderLine("    : " + inits + " {}");
+        writeHeader(")\n");
+
+        headerOut_->appendIndent(indentLevel_);
+        writeHeader("    : ");
+        for (size_t i = 0; i < node.members.size(); ++i) {
+            const auto& member = node.members[i];
+            writeHeader(i > 0 ? ", " : "", member->name.str(), "(", member->name.str(), "_)");
+        }
+        writeHeader(" {}\n");
         writeHeaderLine();
     }
 
     // Default constructor
-    writeHeaderLine(node.name + "() = default;");
+    writeHeaderLine(node.name.str(), "() = default;");
     writeHeaderLine();
 
     // what() method
     writeHeaderLine("const char* what() const noexcept override {");
     indent();
-    writeHeaderLine("return \"" + node.name + "\";");
+    writeHeaderLine("return \"", node.name.str(), "\";");
     outdent();
     writeHeaderLine("}");
 
@@ -639,46 +825,49 @@ void Cpp11Generator::generateException(ExceptionNode& node) {
 void Cpp11Generator::generateUnion(UnionNode& node) {
     if (config_.addDoxygen) {
         writeHeaderLine("/**");
-        writeHeaderLine(" * @brief IDL union " + node.name);
-        std::string srcLoc = formatSourceLocation(node.location);
+        writeHeaderLine(" * @brief IDL union ", node.name.str());
+        const std::string& srcLoc = formatSourceLocation(node.location);
         if (!srcLoc.empty()) {
-            writeHeaderLine(" * @idlsource " + srcLoc);
+            writeHeaderLine(" * @idlsource ", srcLoc);
         }
         writeHeaderLine(" */");
     }
 
-    std::string discType = mapType(node.discriminatorType.get());
+    const std::string& discType = mapType(node.discriminatorType);
+    requireDefinition(node.discriminatorType);
 
-    writeHeaderLine("class " + node.name + " {");
+    defineNamedType(node, qualifiedName(node.name));
+    writeHeaderLine("class ", node.name.str(), " {");
     writeHeaderLine("public:");
     indent();
 
     // Discriminator getter/setter
-    writeHeaderLine(discType + " _d() const { return discriminator_; }");
-    writeHeaderLine("void _d(" + discType + " d) { discriminator_ = d; }");
+    writeHeaderLine(discType, " _d() const { return discriminator_; }");
+    writeHeaderLine("void _d(", discType, " d) { discriminator_ = d; }");
     writeHeaderLine();
 
     // Generate accessors for each case
     for (const auto& caseNode : node.cases) {
-        std::string type = mapType(caseNode->type.get());
-        std::string memberName = caseNode->name;
+        const std::string& type = mapType(caseNode->type);
+        const std::string& memberName = caseNode->name.str();
 
         // Getter
-        writeHeaderLine(type + " " + memberName + "() const { return " + memberName + "_; }");
+        writeHeaderLine(type, " ", memberName, "() const { return ", memberName, "_; }");
         // Setter
-        writeHeaderLine("void " + memberName + "(const " + type + "& value) { " + 
-                       memberName + "_ = value; }");
+        writeHeaderLine("void ", memberName, "(const ", type, "& value) { ",
+                        memberName, "_ = value; }");
         writeHeaderLine();
     }
 
     writeHeaderLine("private:");
     indent();
-    writeHeaderLine(discType + " discriminator_;");
+    writeHeaderLine(discType, " discriminator_;");
 
     // Member storage (using std::variant would be more type-safe)
     for (const auto& caseNode : node.cases) {
-        std::string type = mapType(caseNode->type.get());
-        writeHeaderLine(type + " " + caseNode->name + "_;");
+        writeHeaderLine(mapType(caseNode->type), " ", caseNode->name.str(), "_;");
+        requireDefinition(caseNode->type);
+        instantiateSequences(caseNode->type);
     }
 
     outdent();
@@ -687,6 +876,336 @@ void Cpp11Generator::generateUnion(UnionNode& node) {
     writeHeaderLine();
 }
 
+// ============================================================================
+// Split Headers
+// ============================================================================
+
+void Cpp11Generator::beginTypeHeader(const DefinitionNode& node, std::string_view keyword) {
+    if (!config_.splitHeaders) {
+        return;
+    }
+
+    // Code that only names the type needs no more than the forward header
+    writeHeaderLine(keyword, node.name.str(), ";");
+    if (isa<InterfaceNode>(&node) && config_.useSmartPointers) {
+        useStandardHeader(kMemory);
+        writeHeaderLine("using ", node.name.str(), "Ptr = std::shared_ptr<", node.name.str(), ">;");
+    }
+    writeHeaderLine();
+
+    // Qualified, as modules may define types of the same name
+    Name qualified = qualifiedName(node.name);
+    std::string_view name = qualified.view();
+    std::string filename = baseName_ + "_";
+    for (size_t i = 0; i < name.size(); ++i) {
+        if (name.compare(i, 2, "::") == 0) {
+            filename += '_';
+            ++i;
+        } else {
+            filename += name[i];
+        }
+    }
+    filename += config_.headerExtension;
+
+    typeHeaderIndex_.emplace(name, typeHeaders_.size());
+    typeHeaders_.push_back(std::make_unique<TypeHeader>(std::move(filename), config_.indent));
+    typeHeader_ = typeHeaders_.back().get();
+    headerOut_ = &typeHeader_->code;
+
+    for (const auto& scope : namespaceStack_) {
+        writeHeaderLine("namespace ", scope, " {");
+    }
+    if (!namespaceStack_.empty()) {
+        writeHeaderLine();
+    }
+}
+
+void Cpp11Generator::endTypeHeader() {
+    if (!typeHeader_) {
+        return;
+    }
+
+    TypeHeader& type = *typeHeader_;
+    for (auto it = namespaceStack_.rbegin(); it != namespaceStack_.rend(); ++it) {
+        writeHeaderLine("} // namespace ", *it);
+    }
+    generateExternTemplates(type.externTemplates);
+    if (config_.addIncludeGuards) {
+        generateIncludeGuardEnd();
+    }
+
+    // Now that the code is generated, its includes are known
+    headerOut_ = &type.prologue;
+    if (config_.addIncludeGuards) {
+        generateIncludeGuardBegin(std::filesystem::path(type.filename).stem().string());
+    }
+    generateStandardIncludes(type.standardHeaders);
+    writeHeaderLine("#include \"", forwardHeaderName(), "\"");
+    std::sort(type.requiredTypes.begin(), type.requiredTypes.end());
+    type.requiredTypes.erase(std::unique(type.requiredTypes.begin(), type.requiredTypes.end()),
+                             type.requiredTypes.end());
+    for (size_t index : type.requiredTypes) {
+        writeHeaderLine("#include \"", typeHeaders_[index]->filename, "\"");
+    }
+    writeHeaderLine();
+
+    headerOut_ = &header_;
+    typeHeader_ = nullptr;
+}
+
+void Cpp11Generator::requireDefinition(const TypeNode* type) {
+    if (!typeHeader_ || !type) {
+        return;
+    }
+    if (auto* sequence = dyn_cast<SequenceTypeNode>(type)) {
+        requireDefinition(sequence->elementType);
+    } else if (auto* array = dyn_cast<ArrayTypeNode>(type)) {
+        requireDefinition(array->elementType);
+    } else if (isa<ScopedNameNode>(type)) {
+        requireDefinition(type->typeId.view());
+    }
+}
+
+void Cpp11Generator::requireDefinition(std::string_view qualifiedName) {
+    auto type = typeHeaderIndex_.find(qualifiedName);
+    if (type != typeHeaderIndex_.end()) {
+        // A struct holding a sequence of itself is defined by its own header
+        if (typeHeaders_[type->second].get() != typeHeader_) {
+            typeHeader_->requiredTypes.push_back(type->second);
+        }
+        return;
+    }
+
+    // A typedef needs the definition of what it aliases
+    auto alias = typedefs_.find(qualifiedName);
+    if (alias != typedefs_.end()) {
+        requireDefinition(alias->second);
+        return;
+    }
+
+    // A type nested in an interface is defined by the interface's header
+    size_t scope = qualifiedName.rfind("::");
+    if (scope != std::string_view::npos) {
+        type = typeHeaderIndex_.find(qualifiedName.substr(0, scope));
+        if (type != typeHeaderIndex_.end() && typeHeaders_[type->second].get() != typeHeader_) {
+            typeHeader_->requiredTypes.push_back(type->second);
+        }
+    }
+}
+
+void Cpp11Generator::requireBaseInterface(const std::string& name) {
+    if (!typeHeader_) {
+        return;
+    }
+    if (name.compare(0, 2, "::") == 0) {
+        requireDefinition(std::string_view(name).substr(2));
+        return;
+    }
+
+    // Spelled as in IDL, so look in the enclosing modules from the innermost out
+    std::string candidate;
+    for (size_t depth = namespaceStack_.size() + 1; depth-- > 0;) {
+        candidate.clear();
+        for (size_t i = 0; i < depth; ++i) {
+            candidate.append(namespaceStack_[i]).append("::");
+        }
+        candidate += name;
+        if (typeHeaderIndex_.count(candidate) > 0) {
+            requireDefinition(candidate);
+            return;
+        }
+    }
+}
+
+void Cpp11Generator::generateSplitHeaders() {
+    headerOut_ = &prologue_;
+    if (config_.addIncludeGuards) {
+        generateIncludeGuardBegin(baseName_ + "_fwd");
+    }
+    generateStandardIncludes(standardHeaders_);
+
+    headerOut_ = &umbrella_;
+    if (config_.addIncludeGuards) {
+        generateIncludeGuardBegin(baseName_);
+    }
+    writeHeaderLine("#include \"", forwardHeaderName(), "\"");
+    for (const auto& type : typeHeaders_) {
+        writeHeaderLine("#include \"", type->filename, "\"");
+    }
+    if (config_.addIncludeGuards) {
+        generateIncludeGuardEnd();
+    }
+
+    headerOut_ = &header_;
+}
+
+std::string Cpp11Generator::forwardHeaderName() const {
+    return baseName_ + "_fwd" + config_.headerExtension;
+}
+
+Name Cpp11Generator::qualifiedName(Name name) const {
+    if (namespaceStack_.empty() && !inInterfaceDecl_) {
+        return name;
+    }
+    std::string qualified;
+    for (const auto& scope : namespaceStack_) {
+        qualified.append(scope).append("::");
+    }
+    if (inInterfaceDecl_) {
+        qualified.append(interfaceName_.view()).append("::");
+    }
+    qualified.append(name.view());
+    return Name::intern(qualified);
+}
+
+// ============================================================================
+// Extern Templates
+// ============================================================================
+
+bool Cpp11Generator::isIncluded(const DefinitionNode& node) const {
+    if (imported_) {
+        return true;
+    }
+    // Buffer 1 is the input itself; line markers name the files it includes
+    return sourceManager_ &&
+           sourceManager_->getFilename(node.location) != sourceManager_->getFilename(SourceLocation{1, 0});
+}
+
+void Cpp11Generator::writeEqualityBody(CodeBuffer& out, int level, const StructNode& node) {
+    if (node.members.empty()) {
+        out.line(level, "(void)other;");
+        out.line(level, "return true;");
+        return;
+    }
+    out.appendIndent(level);
+    out.append("return ");
+    for (size_t i = 0; i < node.members.size(); ++i) {
+        if (i > 0) out.append(" && ");
+        out.append(node.members[i]->name.str(), " == other.", node.members[i]->name.str());
+    }
+    out.append(";\n");
+}
+
+void Cpp11Generator::defineNamedType(const DefinitionNode& node, Name name) {
+    NamedType type;
+    type.spelling.append("::").append(name.view());
+    type.userDefined = true;
+    type.included = isIncluded(node);
+    defineNamedType(name, std::move(type));
+}
+
+void Cpp11Generator::defineNamedType(Name name, NamedType type) {
+    if (!outOfLine()) {
+        return;
+    }
+    namedTypes_[name.view()] = std::move(type);
+}
+
+bool Cpp11Generator::elementIncluded(const TypeNode* type) const {
+    if (auto* sequence = dyn_cast<SequenceTypeNode>(type)) {
+        return elementIncluded(sequence->elementType);
+    }
+    if (auto* array = dyn_cast<ArrayTypeNode>(type)) {
+        return elementIncluded(array->elementType);
+    }
+    if (type && isa<ScopedNameNode>(type)) {
+        auto named = namedTypes_.find(type->typeId.view());
+        return named != namedTypes_.end() && named->second.included;
+    }
+    return false;
+}
+
+void Cpp11Generator::collectSequences(const TypeNode* type, std::vector<std::string>& sequences) const {
+    if (auto* sequence = dyn_cast<SequenceTypeNode>(type)) {
+        // Elements first, as a sequence of sequences needs both
+        collectSequences(sequence->elementType, sequences);
+        std::string spelling;
+        bool userDefined = false;
+        // The output of the file declaring the element type instantiates it
+        if (spellGlobal(type, spelling, userDefined) && userDefined && !elementIncluded(type)) {
+            sequences.push_back(std::move(spelling));
+        }
+    } else if (auto* array = dyn_cast<ArrayTypeNode>(type)) {
+        collectSequences(array->elementType, sequences);
+    } else if (type && isa<ScopedNameNode>(type)) {
+        auto named = namedTypes_.find(type->typeId.view());
+        if (named != namedTypes_.end()) {
+            sequences.insert(sequences.end(), named->second.sequences.begin(),
+                             named->second.sequences.end());
+        }
+    }
+}
+
+void Cpp11Generator::instantiateSequences(const TypeNode* type) {
+    if (!outOfLine()) {
+        return;
+    }
+    std::vector<std::string> sequences;
+    collectSequences(type, sequences);
+    for (auto& spelling : sequences) {
+        if (typeHeader_ && std::find(typeHeader_->externTemplates.begin(), typeHeader_->externTemplates.end(),
+                                     spelling) == typeHeader_->externTemplates.end()) {
+            typeHeader_->externTemplates.push_back(spelling);
+        }
+        if (instantiated_.insert(spelling).second) {
+            instantiations_.push_back(std::move(spelling));
+        }
+    }
+}
+
+bool Cpp11Generator::spellGlobal(const TypeNode* type, std::string& spelling, bool& userDefined) const {
+    if (!type) {
+        return false;
+    }
+    if (auto* sequence = dyn_cast<SequenceTypeNode>(type)) {
+        spelling += "std::vector<";
+        if (!spellGlobal(sequence->elementType, spelling, userDefined)) {
+            return false;
+        }
+        spelling += '>';
+        return true;
+    }
+    if (auto* array = dyn_cast<ArrayTypeNode>(type)) {
+        for (size_t i = 0; i < array->dimensions.size(); ++i) {
+            spelling += "std::array<";
+        }
+        if (!spellGlobal(array->elementType, spelling, userDefined)) {
+            return false;
+        }
+        for (auto it = array->dimensions.rbegin(); it != array->dimensions.rend(); ++it) {
+            spelling.append(", ").append(std::to_string(*it)).append(">");
+        }
+        return true;
+    }
+    if (auto* basic = dyn_cast<BasicTypeNode>(type)) {
+        // Object has no mapping yet
+        if (basic->type == BasicType::Object || basic->type == BasicType::Void) {
+            return false;
+        }
+    } else if (isa<ScopedNameNode>(type)) {
+        // Interfaces, which are abstract, and unknown names are not recorded
+        auto named = namedTypes_.find(type->typeId.view());
+        if (named == namedTypes_.end()) {
+            return false;
+        }
+        userDefined = userDefined || named->second.userDefined;
+        spelling += named->second.spelling;
+        return true;
+    }
+    spelling += type->resolvedCppType.view();
+    return true;
+}
+
+void Cpp11Generator::generateExternTemplates(const std::vector<std::string>& types) {
+    if (types.empty()) {
+        return;
+    }
+    writeHeaderLine();
+    for (const auto& type : types) {
+        writeHeaderLine("extern template class ", type, ";");
+    }
+}
+
 // ============================================================================
 // Utility
 // ============================================================================
@@ -732,25 +1251,23 @@ std::string Cpp11Generator::sanitizeIdentifier(const std::string& name) const {
     return name;
 }
 
-std::string Cpp11Generator::constValueToString(const ConstValue& value) const {
+void Cpp11Generator::writeConstValue(const ConstValue& value) {
     if (auto* i = std::get_if<int64_t>(&value)) {
-        return std::to_string(*i);
-    }
-    if (auto* u = std::get_if<uint64_t>(&value)) {
-        return std::to_string(*u) + "ULL";
-    }
-    if (auto* d = std::get_if<double>(&value)) {
-        std::ostringstream oss;
-        oss << std::setprecision(17) << *d;
-        return oss.str();
-    }
-    if (auto* s = std::get_if<std::string>(&value)) {
-        return "\"" + *s + "\"";
-    }
-    if (auto* b = std::get_if<bool>(&value)) {
-        return *b ? "true" : "false";
+        writeHeader(*i);
+    } else if (auto* u = std::get_if<uint64_t>(&value)) {
+        writeHeader(*u, "ULL");
+    } else if (auto* d = std::get_if<double>(&value)) {
+        // Same as an ostream with precision 17
+        char digits[32];
+        int length = std::snprintf(digits, sizeof(digits), "%.17g", *d);
+        writeHeader(std::string_view(digits, static_cast<size_t>(length)));
+    } else if (auto* s = std::get_if<std::string>(&value)) {
+        writeHeader("\"", *s, "\"");
+    } else if (auto* b = std::get_if<bool>(&value)) {
+        writeHeader(*b ? "true" : "false");
+    } else {
+        writeHeader("0");
     }
-    return "0";
 }
 
 std::string Cpp11Generator::makeIncludeGuard(const std::string& filename) const {
@@ -775,11 +1292,15 @@ std::string Cpp11Generator::makeIncludeGuard(const std::string& filename) const
     return guard;
 }
 
-std::string Cpp11Generator::formatSourceLocation(const SourceLocation& loc) const {
-    if (loc.filename.empty()) {
-        return "";
+const std::string& Cpp11Generator::formatSourceLocation(const SourceLocation& loc) {
+    location_.clear();
+    if (sourceManager_ && loc.isValid()) {
+        auto presumed = sourceManager_->getPresumedLocation(loc);
+        char line[24];
+        auto result = std::to_chars(line, line + sizeof(line), presumed.line);
+        location_.append(presumed.filename).append(1, ':').append(line, result.ptr);
     }
-    return loc.filename + ":" + std::to_string(loc.line);
+    return location_;
 }
 
 void Cpp11Generator::addError(const std::string& message) {
@@ -2,16 +2,23 @@
 #define IBORB_IDL_CPP11_GENERATOR_HPP
 
 #include <string>
-#include <sstream>
-#include <fstream>
 #include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include "ast/ast.hpp"
+#include "ast/static_visitor.hpp"
+#include "generator/code_buffer.hpp"
 #include "semantic/symbol_table.hpp"
+#include "source/source_manager.hpp"
 
 namespace iborb::generator {
 
+class OutputFile;
+
 /**
  * @brief Configuration options for code generation
  */
@@ -24,21 +31,25 @@ struct GeneratorConfig {
     bool useSmartPointers = true;
     bool addIncludeGuards = true;
     bool addDoxygen = true;
+    bool deferWrite = false;  // Leave writing the files to writeFiles()
+    bool splitHeaders = false;  // One header per type, plus <name>_fwd.hpp (see generate())
+    bool externTemplates = false;  // Instantiate sequences and struct equality once, in the source file
     std::string indent = "    ";  // 4 spaces
 };
 
 /**
  * @brief C++11 Code Generator
  * 
- * Implements the Visitor pattern to traverse the AST and generate
- * C++ code following the IDL to C++11 Language Mapping standard.
+ * Traverses the AST with a StaticVisitor and generates C++ code
+ * following the IDL to C++11 Language Mapping standard.
  */
-class Cpp11Generator : public ast::ASTVisitor {
+class Cpp11Generator : public ast::StaticVisitor<Cpp11Generator> {
 public:
     /**
      * @brief Construct generator with configuration
      */
     explicit Cpp11Generator(GeneratorConfig config = {});
+    ~Cpp11Generator();
 
     /**
      * @brief Set the symbol table for type resolution
@@ -47,80 +58,236 @@ public:
 
     /**
      * @brief Generate code from a translation unit
-     * @param unit The parsed AST
+     * @param unit The parsed AST, with types resolved by semantic::TypeResolver
      * @return true if generation succeeded
+     *
+     * With GeneratorConfig::splitHeaders, every struct, union, exception
+     * and interface outside an interface gets a header of its own,
+     * `<name>_<qualified type name>.hpp`. Enums, typedefs and constants,
+     * which everything else names, go into `<name>_fwd.hpp` with forward
+     * declarations of the other types and the `...Ptr` aliases. A type's
+     * header includes the forward header, the standard headers its code
+     * needs, and the headers of the types it holds by value or derives
+     * from, so a file that only passes a type around can include the
+     * forward header alone. `<name>.hpp` includes all of them.
+     *
+     * With GeneratorConfig::externTemplates, the source file includes the
+     * header and defines the equality operators of structs, which the
+     * header only declares. Sequences of generated types held by a
+     * struct, union or exception are instantiated explicitly in the
+     * source file, and declared `extern template` at the end of the
+     * header that holds them, where their elements are complete, so that
+     * files including it do not instantiate them again. Sequences of
+     * standard types only are left alone: the standard library does not
+     * allow programs to instantiate those.
      */
     bool generate(const ast::TranslationUnit& unit);
 
+    /**
+     * @brief Write the generated files into the output directory
+     * @return true if all files were written
+     *
+     * Called by generate() unless the configuration defers writing.
+     * Files whose content is unchanged are not rewritten, and changed
+     * files are replaced atomically.
+     */
+    bool writeFiles();
+
+    /**
+     * @brief Start generating a unit that arrives one definition at a time
+     *
+     * Unlike generate(), the header is written while it is generated:
+     * streamDefinition() hands it to the output file whenever a few
+     * chunks have accumulated, so only the tail of it is ever in memory.
+     * endStream() puts the files in place, unless the configuration
+     * defers writing, in which case the header waits in its temporary
+     * file for writeFiles(). getHeader() only holds the part not yet
+     * written. Headers are not split.
+     */
+    void beginStream(const std::string& filename);
+
+    /**
+     * @brief Open the namespace of a module of the streamed unit
+     */
+    void beginModule(ast::Name name);
+
+    /**
+     * @brief Close the namespace opened last
+     */
+    void endModule();
+
+    /**
+     * @brief Generate one definition of the streamed unit
+     * @param sourceManager Resolves the definition's locations
+     * @param imported The definition comes from an imported unit
+     */
+    void streamDefinition(ast::DefinitionNode& definition,
+                          const source::SourceManager* sourceManager, bool imported = false);
+
+    /**
+     * @brief Finish the streamed unit
+     * @param commit Keep the files; false discards everything written
+     * @return true if generation and writing succeeded
+     */
+    bool endStream(bool commit);
+
+    /**
+     * @brief Number of files writeFiles() left untouched because they were up to date
+     */
+    size_t getUnchangedFileCount() const { return unchangedFiles_; }
+
+    /**
+     * @brief Get the paths of the files written by writeFiles() or endStream(),
+     * including those that were already up to date
+     */
+    const std::vector<std::string>& getOutputFiles() const { return outputFiles_; }
+
     /**
      * @brief Get the generated header content
+     *
+     * Unless streamed, the include guard and includes are not part of it:
+     * they are generated last, from the types the code uses.
      */
-    const std::string& getHeaderContent() const { return headerContent_; }
+    const CodeBuffer& getHeader() const { return header_; }
 
     /**
      * @brief Get the generated source content
      */
-    const std::string& getSourceContent() const { return sourceContent_; }
+    const CodeBuffer& getSource() const { return source_; }
 
     /**
      * @brief Get any generation errors
      */
     const std::vector<std::string>& getErrors() const { return errors_; }
 
-    // Visitor interface implementation
-    void visit(ast::ModuleNode& node) override;
-    void visit(ast::InterfaceNode& node) override;
-    void visit(ast::OperationNode& node) override;
-    void visit(ast::ParameterNode& node) override;
-    void visit(ast::AttributeNode& node) override;
-    void visit(ast::StructNode& node) override;
-    void visit(ast::StructMemberNode& node) override;
-    void visit(ast::TypedefNode& node) override;
-    void visit(ast::EnumNode& node) override;
-    void visit(ast::ConstNode& node) override;
-    void visit(ast::ExceptionNode& node) override;
-    void visit(ast::UnionNode& node) override;
-    void visit(ast::UnionCaseNode& node) override;
-    void visit(ast::BasicTypeNode& node) override;
-    void visit(ast::SequenceTypeNode& node) override;
-    void visit(ast::StringTypeNode& node) override;
-    void visit(ast::ScopedNameNode& node) override;
-    void visit(ast::ArrayTypeNode& node) override;
+    // Called through dispatch()
+    void visit(ast::ModuleNode& node);
+    void visit(ast::InterfaceNode& node);
+    void visit(ast::OperationNode& node);
+    void visit(ast::ParameterNode& node);
+    void visit(ast::AttributeNode& node);
+    void visit(ast::StructNode& node);
+    void visit(ast::StructMemberNode& node);
+    void visit(ast::TypedefNode& node);
+    void visit(ast::EnumNode& node);
+    void visit(ast::ConstNode& node);
+    void visit(ast::ExceptionNode& node);
+    void visit(ast::UnionNode& node);
+    void visit(ast::UnionCaseNode& node);
+    void visit(ast::BasicTypeNode& node);
+    void visit(ast::SequenceTypeNode& node);
+    void visit(ast::StringTypeNode& node);
+    void visit(ast::ScopedNameNode& node);
+    void visit(ast::ArrayTypeNode& node);
 
 private:
+    // Header bytes buffered before streamDefinition() writes them out
+    static constexpr size_t kStreamFlushSize = 256 * 1024;
+
+    /**
+     * @brief Standard headers that generated code may need, as bits of a mask
+     */
+    enum StandardHeader : unsigned {
+        kCstdint = 1u << 0,
+        kString = 1u << 1,
+        kVector = 1u << 2,
+        kArray = 1u << 3,
+        kMemory = 1u << 4,
+        kException = 1u << 5,
+        kAny = 1u << 6,
+        kAllStandardHeaders = (1u << 7) - 1
+    };
+
+    /**
+     * @brief The header of one type, when headers are split
+     */
+    struct TypeHeader {
+        std::string filename;  // In the output directory
+        CodeBuffer prologue;   // Include guard and includes
+        CodeBuffer code;
+        unsigned standardHeaders = 0;  // StandardHeader bits the code needs
+        std::vector<size_t> requiredTypes;  // Headers it includes, as indices into typeHeaders_
+        std::vector<std::string> externTemplates;  // Sequences it holds, spelled from the global scope
+
+        TypeHeader(std::string file, std::string_view indentUnit)
+            : filename(std::move(file)), prologue(indentUnit), code(indentUnit) {}
+    };
+
     GeneratorConfig config_;
     const semantic::SymbolTable* symbolTable_ = nullptr;
-    std::ostringstream header_;
-    std::ostringstream source_;
-    std::string headerContent_;
-    std::string sourceContent_;
+    const source::SourceManager* sourceManager_ = nullptr;
+    CodeBuffer header_;
+    CodeBuffer source_;
+    CodeBuffer prologue_;  // Include guard and includes, written before header_
+    CodeBuffer* headerOut_;  // header_, or the code of the type header being generated
+    unsigned standardHeaders_ = 0;  // StandardHeader bits the code in header_ needs
+    std::string baseName_;
+    std::unique_ptr<OutputFile> streamedHeader_;
+    std::string location_;  // Reused by formatSourceLocation()
+    size_t unchangedFiles_ = 0;
+    std::vector<std::string> outputFiles_;
     std::vector<std::string> errors_;
     
     // State tracking
     int indentLevel_ = 0;
     std::vector<std::string> namespaceStack_;
-    std::string currentTypeName_;
     bool inInterfaceDecl_ = false;
+    bool imported_ = false;  // The definition comes from an imported unit
+    ast::Name interfaceName_;  // Of the interface whose contents are generated
+
+    /**
+     * @brief A generated type that may be the element of an instantiated sequence
+     */
+    struct NamedType {
+        std::string spelling;  // From the global scope; typedefs are spelled as what they alias
+        bool userDefined = false;  // Not a typedef of standard types only
+        std::vector<std::string> sequences;  // For a typedef, those it aliases
+        bool included = false;  // Declared by an included file, or aliasing such a type
+    };
+
+    // Extern templates; sequences are spelled from the global scope
+    std::vector<std::string> instantiations_;  // At the end of source_ and, unsplit, of header_
+    std::unordered_set<std::string> instantiated_;
+    std::unordered_map<std::string_view, NamedType> namedTypes_;  // By qualified name
 
-    // Output helpers
+    // Split headers; header_ and prologue_ hold the forward header
+    CodeBuffer umbrella_;  // <name>.hpp, including all the others
+    std::vector<std::unique_ptr<TypeHeader>> typeHeaders_;
+    TypeHeader* typeHeader_ = nullptr;  // Being generated
+    std::unordered_map<std::string_view, size_t> typeHeaderIndex_;  // By qualified type name
+    std::unordered_map<std::string_view, const ast::TypeNode*> typedefs_;  // Aliased types, likewise
+
+    // Output helpers, taking the pieces of the text (see CodeBuffer)
     void indent();
     void outdent();
-    std::string getIndent() const;
-    void writeHeader(const std::string& text);
-    void writeHeaderLine(const std::string& line = "");
-    void writeSource(const std::string& text);
-    void writeSourceLine(const std::string& line = "");
-
-    // Type mapping
-    std::string mapBasicType(ast::BasicType type) const;
-    std::string mapType(ast::TypeNode* node);
-    std::string mapTypeForParameter(ast::TypeNode* node, ast::ParamDirection dir);
-    std::string mapTypeForReturn(ast::TypeNode* node);
+
+    template<typename... Parts>
+    void writeHeader(const Parts&... parts) { headerOut_->append(parts...); }
+
+    template<typename... Parts>
+    void writeHeaderLine(const Parts&... parts) { headerOut_->line(indentLevel_, parts...); }
+
+    template<typename... Parts>
+    void writeSource(const Parts&... parts) { source_.append(parts...); }
+
+    template<typename... Parts>
+    void writeSourceLine(const Parts&... parts) { source_.line(indentLevel_, parts...); }
+
+    // Type mapping, from the spelling cached on resolved type nodes. The
+    // standard headers a mapped type needs are noted for the header written.
+    const std::string& mapType(ast::TypeNode* node);
+    void writeParameterType(ast::TypeNode* node, ast::ParamDirection dir);
+    const std::string& mapTypeForReturn(ast::TypeNode* node);
+    void useStandardHeaders(const ast::TypeNode* node);
+    void useStandardHeader(StandardHeader header);
 
     // Code generation helpers
+    void beginUnit(const std::string& filename);
+    void endUnit();
     void generateIncludeGuardBegin(const std::string& filename);
     void generateIncludeGuardEnd();
-    void generateIncludes();
+    void generatePrologues();
+    void generateStandardIncludes(unsigned headers);
     void generateNamespaceBegin(const std::string& name);
     void generateNamespaceEnd();
     void generateStruct(ast::StructNode& node);
@@ -131,11 +298,36 @@ private:
     void generateException(ast::ExceptionNode& node);
     void generateUnion(ast::UnionNode& node);
 
+    // Split headers
+    void beginTypeHeader(const ast::DefinitionNode& node, std::string_view keyword);
+    void endTypeHeader();
+    void requireDefinition(const ast::TypeNode* type);
+    void requireDefinition(std::string_view qualifiedName);
+    void requireBaseInterface(const std::string& name);
+    void generateSplitHeaders();
+    std::string forwardHeaderName() const;
+    ast::Name qualifiedName(ast::Name name) const;
+
+    // Extern templates
+    bool outOfLine() const { return config_.externTemplates && config_.generateImplementation; }
+    bool isIncluded(const ast::DefinitionNode& node) const;
+    void writeEqualityBody(CodeBuffer& out, int level, const ast::StructNode& node);
+    void defineNamedType(const ast::DefinitionNode& node, ast::Name name);
+    void defineNamedType(ast::Name name, NamedType type);
+    bool elementIncluded(const ast::TypeNode* type) const;
+    void collectSequences(const ast::TypeNode* type, std::vector<std::string>& sequences) const;
+    void instantiateSequences(const ast::TypeNode* type);
+    bool spellGlobal(const ast::TypeNode* type, std::string& spelling, bool& userDefined) const;
+    void generateExternTemplates(const std::vector<std::string>& types);
+
     // Utility
     std::string sanitizeIdentifier(const std::string& name) const;
-    std::string constValueToString(const ast::ConstValue& value) const;
+    void writeConstValue(const ast::ConstValue& value);
     std::string makeIncludeGuard(const std::string& filename) const;
-    std::string formatSourceLocation(const ast::SourceLocation& loc) const;
+    const std::string& formatSourceLocation(const ast::SourceLocation& loc);
+    std::string outputPath(const std::string& extension) const;
+    void writeSourceFile();
+    bool writeFileIfChanged(const std::string& path, std::initializer_list<const CodeBuffer*> parts);
     void addError(const std::string& message);
 };
 
@@ -0,0 +1,209 @@
+#include "generator/output_file.hpp"
+#include "generator/code_buffer.hpp"
+#include "source/source_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <climits>
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace iborb::generator {
+
+namespace {
+
+#ifndef _WIN32
+#ifdef IOV_MAX
+constexpr size_t kMaxIov = IOV_MAX;
+#else
+constexpr size_t kMaxIov = 16;
+#endif
+
+/**
+ * @brief Write all of the given buffers, resuming after partial writes
+ */
+bool writeAll(int fd, std::vector<iovec>& iov) {
+    size_t first = 0;
+    while (first < iov.size()) {
+        size_t count = std::min(iov.size() - first, kMaxIov);
+        ssize_t written = ::writev(fd, &iov[first], static_cast<int>(count));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // Skip the buffers that were written completely
+        auto remaining = static_cast<size_t>(written);
+        while (first < iov.size() && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+#endif
+
+} // anonymous namespace
+
+OutputFile::OutputFile(std::string path)
+    : path_(std::move(path)) {
+    try {
+        existing_ = source::SourceBuffer::fromFile(path_);
+        std::error_code ec;
+        existingTime_ = std::filesystem::last_write_time(path_, ec);
+    } catch (const std::exception&) {
+        // No file to compare against; the output is written from the start
+    }
+}
+
+OutputFile::~OutputFile() {
+    if (diverged_) {
+        close();
+        std::error_code ec;
+        std::filesystem::remove(tempPath_, ec);
+    }
+}
+
+void OutputFile::write(const CodeBuffer& content) {
+    // Once a chunk differs, everything after it is written as is; later
+    // chunks must not be compared against the old file at a stale offset
+    std::vector<std::string_view> parts;
+    bool mismatched = diverged_;
+    content.forEachChunk([&](std::string_view chunk) {
+        if (mismatched || !matches(chunk)) {
+            mismatched = true;
+            parts.push_back(chunk);
+        }
+    });
+    if (!parts.empty()) {
+        writeThrough(parts.data(), parts.size());
+    }
+}
+
+void OutputFile::write(std::string_view text) {
+    if (!text.empty() && (diverged_ || !matches(text))) {
+        writeThrough(&text, 1);
+    }
+}
+
+bool OutputFile::commit() {
+    if (!diverged_) {
+        if (existing_ && matched_ == existing_->data().size() && !replaced()) {
+            unchanged_ = true;
+            existing_.reset();
+            return true;
+        }
+        // The output is a prefix of the existing file, or the file was
+        // replaced since it was compared; the mapping still holds the output
+        diverge();
+    }
+
+    close();
+    bool ok = !failed_;
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(tempPath_, path_, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        std::filesystem::remove(tempPath_, ec);
+    }
+    diverged_ = false;
+    return ok;
+}
+
+bool OutputFile::matches(std::string_view text) {
+    if (!existing_) {
+        return false;
+    }
+    std::string_view rest = existing_->data().substr(matched_);
+    if (rest.size() < text.size() || std::memcmp(rest.data(), text.data(), text.size()) != 0) {
+        return false;
+    }
+    matched_ += text.size();
+    return true;
+}
+
+bool OutputFile::replaced() const {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path_, ec);
+    if (ec || size != existing_->data().size()) {
+        return true;
+    }
+    return std::filesystem::last_write_time(path_, ec) != existingTime_ || ec;
+}
+
+void OutputFile::diverge() {
+    diverged_ = true;
+    tempPath_ = path_ + ".tmp" + std::to_string(std::random_device{}());
+#ifdef _WIN32
+    file_ = std::fopen(tempPath_.c_str(), "wb");
+    failed_ = file_ == nullptr;
+#else
+    fd_ = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    failed_ = fd_ < 0;
+#endif
+
+    // Copy what the output had in common with the old file, then let the
+    // mapping go so the file can be replaced
+    if (existing_) {
+        std::string_view prefix = existing_->data().substr(0, matched_);
+        if (!prefix.empty()) {
+            writeThrough(&prefix, 1);
+        }
+        existing_.reset();
+    }
+}
+
+void OutputFile::writeThrough(const std::string_view* parts, size_t count) {
+    if (!diverged_) {
+        diverge();
+    }
+    if (failed_) {
+        return;
+    }
+#ifdef _WIN32
+    for (size_t i = 0; i < count; ++i) {
+        if (std::fwrite(parts[i].data(), 1, parts[i].size(), file_) != parts[i].size()) {
+            failed_ = true;
+            return;
+        }
+    }
+#else
+    std::vector<iovec> iov;
+    iov.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        iov.push_back({const_cast<char*>(parts[i].data()), parts[i].size()});
+    }
+    failed_ = !writeAll(fd_, iov);
+#endif
+}
+
+void OutputFile::close() {
+#ifdef _WIN32
+    if (file_ && std::fclose(file_) != 0) {
+        failed_ = true;
+    }
+    file_ = nullptr;
+#else
+    if (fd_ >= 0 && ::close(fd_) != 0) {
+        failed_ = true;
+    }
+    fd_ = -1;
+#endif
+}
+
+} // namespace iborb::generator
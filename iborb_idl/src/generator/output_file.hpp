@@ -0,0 +1,96 @@
+#ifndef IBORB_IDL_OUTPUT_FILE_HPP
+#define IBORB_IDL_OUTPUT_FILE_HPP
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace iborb::source {
+class SourceBuffer;
+}
+
+namespace iborb::generator {
+
+class CodeBuffer;
+
+/**
+ * @brief A generated file that is written piece by piece and replaced only if changed
+ *
+ * The output is compared against the existing file while it is written.
+ * As long as it matches, nothing is written at all; at the first
+ * difference a temporary file is created next to the target, the part
+ * that matched is copied into it, and the rest of the output goes
+ * straight to disk. commit() renames the temporary file into place, so
+ * readers never see a partially written file, and an identical file
+ * keeps its timestamp, so it does not trigger rebuilds of everything
+ * that includes it.
+ *
+ * Destroying a file that was not committed discards the temporary file
+ * and leaves the target untouched. A file may be committed long after
+ * it was written; if the target was replaced in between, an output
+ * that matched the old file is written out after all.
+ */
+class OutputFile {
+public:
+    explicit OutputFile(std::string path);
+    ~OutputFile();
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    /**
+     * @brief Append the contents of a buffer
+     */
+    void write(const CodeBuffer& content);
+
+    /**
+     * @brief Append text
+     */
+    void write(std::string_view text);
+
+    /**
+     * @brief Finish the file
+     * @return true if the file is in place, whether it was rewritten or not
+     */
+    bool commit();
+
+    /**
+     * @brief Check whether commit() found the existing file up to date
+     */
+    bool isUnchanged() const { return unchanged_; }
+
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+    std::string tempPath_;
+    std::unique_ptr<source::SourceBuffer> existing_;  // Null once the output differs
+    size_t matched_ = 0;  // Bytes of existing_ the output has matched so far
+    std::filesystem::file_time_type existingTime_;  // Of the file existing_ maps
+    bool diverged_ = false;
+    bool failed_ = false;
+    bool unchanged_ = false;
+#ifdef _WIN32
+    std::FILE* file_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+
+    // Compare text against the existing file at the current position
+    bool matches(std::string_view text);
+
+    // Check whether the target is no longer the file existing_ maps
+    bool replaced() const;
+
+    // Create the temporary file and copy the matched prefix into it
+    void diverge();
+
+    void writeThrough(const std::string_view* parts, size_t count);
+    void close();
+};
+
+} // namespace iborb::generator
+
+#endif // IBORB_IDL_OUTPUT_FILE_HPP
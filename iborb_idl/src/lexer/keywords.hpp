@@ -0,0 +1,231 @@
+#ifndef IBORB_IDL_KEYWORDS_HPP
+#define IBORB_IDL_KEYWORDS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "lexer/lexer.hpp"
+
+namespace iborb::lexer {
+
+/**
+ * @brief Keyword spelling and the token it produces
+ */
+struct Keyword {
+    std::string_view spelling;
+    TokenType type = TokenType::Identifier;
+};
+
+/**
+ * @brief CORBA 3.x IDL keywords
+ */
+inline constexpr Keyword kCorbaKeywords[] = {
+    {"module", TokenType::KwModule},
+    {"interface", TokenType::KwInterface},
+    {"struct", TokenType::KwStruct},
+    {"union", TokenType::KwUnion},
+    {"switch", TokenType::KwSwitch},
+    {"case", TokenType::KwCase},
+    {"default", TokenType::KwDefault},
+    {"enum", TokenType::KwEnum},
+    {"const", TokenType::KwConst},
+    {"typedef", TokenType::KwTypedef},
+    {"exception", TokenType::KwException},
+    {"attribute", TokenType::KwAttribute},
+    {"readonly", TokenType::KwReadonly},
+    {"in", TokenType::KwIn},
+    {"out", TokenType::KwOut},
+    {"inout", TokenType::KwInout},
+    {"oneway", TokenType::KwOneway},
+    {"raises", TokenType::KwRaises},
+    {"context", TokenType::KwContext},
+    {"sequence", TokenType::KwSequence},
+    {"string", TokenType::KwString},
+    {"wstring", TokenType::KwWstring},
+    {"fixed", TokenType::KwFixed},
+    {"abstract", TokenType::KwAbstract},
+    {"local", TokenType::KwLocal},
+    {"native", TokenType::KwNative},
+    {"valuetype", TokenType::KwValuetype},
+    {"truncatable", TokenType::KwTruncatable},
+    {"supports", TokenType::KwSupports},
+    {"public", TokenType::KwPublic},
+    {"private", TokenType::KwPrivate},
+    {"factory", TokenType::KwFactory},
+    {"custom", TokenType::KwCustom},
+    {"void", TokenType::KwVoid},
+    {"boolean", TokenType::KwBoolean},
+    {"char", TokenType::KwChar},
+    {"wchar", TokenType::KwWchar},
+    {"octet", TokenType::KwOctet},
+    {"short", TokenType::KwShort},
+    {"long", TokenType::KwLong},
+    {"float", TokenType::KwFloat},
+    {"double", TokenType::KwDouble},
+    {"unsigned", TokenType::KwUnsigned},
+    {"any", TokenType::KwAny},
+    {"Object", TokenType::KwObject},
+    {"TRUE", TokenType::KwTrue},
+    {"FALSE", TokenType::KwFalse},
+    {"true", TokenType::KwTrue},
+    {"false", TokenType::KwFalse}
+};
+
+/**
+ * @brief Perfect hash table over keyword spellings
+ *
+ * Keywords are keyed by (length, first character, last character) and
+ * placed with hash-and-displace: the key picks a bucket, and each bucket
+ * stores a displacement, found at compile time, that sends all of its
+ * keys to distinct free slots. A lookup is therefore two integer hashes,
+ * two table loads and at most one length-checked comparison, with no
+ * allocation and no probing.
+ *
+ * @tparam Size Slot count, must be a power of two
+ */
+template<size_t Size>
+class KeywordTable {
+    static_assert((Size & (Size - 1)) == 0, "keyword table size must be a power of two");
+    static constexpr size_t kBuckets = Size / 4;
+
+public:
+    constexpr KeywordTable() = default;
+
+    /**
+     * @brief Classify an identifier, returning TokenType::Identifier for non-keywords
+     */
+    constexpr TokenType lookup(std::string_view name) const {
+        if (name.size() < minLength_ || name.size() > maxLength_) {
+            return TokenType::Identifier;
+        }
+        uint32_t key = keyOf(name);
+        const Keyword& slot = slots_[slotFor(key, displacement_[bucketOf(key)])];
+        return slot.spelling == name ? slot.type : TokenType::Identifier;
+    }
+
+    /**
+     * @brief Whether every keyword was placed in its own slot
+     */
+    constexpr bool isPerfect() const { return perfect_; }
+
+    /**
+     * @brief Build a table from one or more keyword lists
+     *
+     * Extra grammar (for example IDL4 building-block keywords) is plugged
+     * in by passing its list alongside kCorbaKeywords; placement re-runs
+     * at compile time, so lookup cost does not grow with the keyword set.
+     */
+    template<size_t... N>
+    static constexpr KeywordTable build(const Keyword (&... lists)[N]) {
+        constexpr size_t total = (N + ...);
+        static_assert(total <= Size, "keyword table is too small");
+
+        std::array<Keyword, total> all{};
+        size_t count = 0;
+        (append(all, count, lists), ...);
+
+        KeywordTable table;
+        table.perfect_ = table.place(all);
+        return table;
+    }
+
+private:
+    std::array<Keyword, Size> slots_{};
+    std::array<uint16_t, kBuckets> displacement_{};
+    size_t minLength_ = SIZE_MAX;
+    size_t maxLength_ = 0;
+    bool perfect_ = false;
+
+    static constexpr uint32_t keyOf(std::string_view name) {
+        return static_cast<uint32_t>(name.size()) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(name.front())) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(name.back()));
+    }
+
+    static constexpr uint32_t mix(uint32_t k) {
+        k ^= k >> 16;
+        k *= 0x7FEB352Du;
+        k ^= k >> 15;
+        k *= 0x846CA68Bu;
+        k ^= k >> 16;
+        return k;
+    }
+
+    static constexpr size_t bucketOf(uint32_t key) {
+        return mix(key) & (kBuckets - 1);
+    }
+
+    static constexpr size_t slotFor(uint32_t key, uint16_t displacement) {
+        return mix(key ^ (displacement * 0x9E3779B9u)) & (Size - 1);
+    }
+
+    template<size_t Total, size_t N>
+    static constexpr void append(std::array<Keyword, Total>& all, size_t& count,
+                                 const Keyword (&list)[N]) {
+        for (const auto& kw : list) {
+            all[count++] = kw;
+        }
+    }
+
+    template<size_t Total>
+    constexpr bool place(const std::array<Keyword, Total>& all) {
+        std::array<size_t, kBuckets> bucketSize{};
+        for (const auto& kw : all) {
+            ++bucketSize[bucketOf(keyOf(kw.spelling))];
+            minLength_ = kw.spelling.size() < minLength_ ? kw.spelling.size() : minLength_;
+            maxLength_ = kw.spelling.size() > maxLength_ ? kw.spelling.size() : maxLength_;
+        }
+
+        // Place the fullest buckets first, while most slots are still free
+        for (size_t size = Total; size > 0; --size) {
+            for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+                if (bucketSize[bucket] == size && !placeBucket(all, bucket)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template<size_t Total>
+    constexpr bool placeBucket(const std::array<Keyword, Total>& all, size_t bucket) {
+        for (uint32_t d = 0; d < 65536; ++d) {
+            auto displacement = static_cast<uint16_t>(d);
+            std::array<bool, Size> taken{};
+            bool fits = true;
+            for (const auto& kw : all) {
+                uint32_t key = keyOf(kw.spelling);
+                if (bucketOf(key) != bucket) continue;
+                size_t slot = slotFor(key, displacement);
+                if (!slots_[slot].spelling.empty() || taken[slot]) {
+                    fits = false;
+                    break;
+                }
+                taken[slot] = true;
+            }
+            if (fits) {
+                displacement_[bucket] = displacement;
+                for (const auto& kw : all) {
+                    uint32_t key = keyOf(kw.spelling);
+                    if (bucketOf(key) == bucket) {
+                        slots_[slotFor(key, displacement)] = kw;
+                    }
+                }
+                return true;
+            }
+        }
+        return false;  // Two keywords share length, first and last character
+    }
+};
+
+/**
+ * @brief Keyword table used by the lexer
+ */
+inline constexpr auto kKeywordTable = KeywordTable<128>::build(kCorbaKeywords);
+
+static_assert(kKeywordTable.isPerfect(), "keyword table has colliding keys");
+
+} // namespace iborb::lexer
+
+#endif // IBORB_IDL_KEYWORDS_HPP
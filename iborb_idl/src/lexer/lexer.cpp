@@ -1,8 +1,9 @@
 #include "lexer/lexer.hpp"
-#include <unordered_map>
+#include "lexer/keywords.hpp"
 #include <cctype>
 #include <cstdlib>
 #include <charconv>
+#include <stdexcept>
 
 namespace iborb::lexer {
 
@@ -22,72 +23,18 @@ bool Token::isOperator() const {
     return type >= TokenType::Plus && type <= TokenType::RightShift;
 }
 
-std::string_view Token::typeName() const {
-    return tokenTypeToString(type);
+std::string_view Token::stringValue() const {
+    if (auto* view = std::get_if<std::string_view>(&value)) {
+        return *view;
+    }
+    if (auto* str = std::get_if<std::string>(&value)) {
+        return *str;
+    }
+    return {};
 }
 
-// ============================================================================
-// Keyword Lookup Table
-// ============================================================================
-
-static const std::unordered_map<std::string, TokenType> keywords = {
-    {"module", TokenType::KwModule},
-    {"interface", TokenType::KwInterface},
-    {"struct", TokenType::KwStruct},
-    {"union", TokenType::KwUnion},
-    {"switch", TokenType::KwSwitch},
-    {"case", TokenType::KwCase},
-    {"default", TokenType::KwDefault},
-    {"enum", TokenType::KwEnum},
-    {"const", TokenType::KwConst},
-    {"typedef", TokenType::KwTypedef},
-    {"exception", TokenType::KwException},
-    {"attribute", TokenType::KwAttribute},
-    {"readonly", TokenType::KwReadonly},
-    {"in", TokenType::KwIn},
-    {"out", TokenType::KwOut},
-    {"inout", TokenType::KwInout},
-    {"oneway", TokenType::KwOneway},
-    {"raises", TokenType::KwRaises},
-    {"context", TokenType::KwContext},
-    {"sequence", TokenType::KwSequence},
-    {"string", TokenType::KwString},
-    {"wstring", TokenType::KwWstring},
-    {"fixed", TokenType::KwFixed},
-    {"abstract", TokenType::KwAbstract},
-    {"local", TokenType::KwLocal},
-    {"native", TokenType::KwNative},
-    {"valuetype", TokenType::KwValuetype},
-    {"truncatable", TokenType::KwTruncatable},
-    {"supports", TokenType::KwSupports},
-    {"public", TokenType::KwPublic},
-    {"private", TokenType::KwPrivate},
-    {"factory", TokenType::KwFactory},
-    {"custom", TokenType::KwCustom},
-    {"void", TokenType::KwVoid},
-    {"boolean", TokenType::KwBoolean},
-    {"char", TokenType::KwChar},
-    {"wchar", TokenType::KwWchar},
-    {"octet", TokenType::KwOctet},
-    {"short", TokenType::KwShort},
-    {"long", TokenType::KwLong},
-    {"float", TokenType::KwFloat},
-    {"double", TokenType::KwDouble},
-    {"unsigned", TokenType::KwUnsigned},
-    {"any", TokenType::KwAny},
-    {"Object", TokenType::KwObject},
-    {"TRUE", TokenType::KwTrue},
-    {"FALSE", TokenType::KwFalse},
-    {"true", TokenType::KwTrue},
-    {"false", TokenType::KwFalse}
-};
-
-std::optional<TokenType> Lexer::lookupKeyword(const std::string& name) {
-    auto it = keywords.find(name);
-    if (it != keywords.end()) {
-        return it->second;
-    }
-    return std::nullopt;
+std::string_view Token::typeName() const {
+    return tokenTypeToString(type);
 }
 
 // ============================================================================
@@ -95,7 +42,17 @@ std::optional<TokenType> Lexer::lookupKeyword(const std::string& name) {
 // ============================================================================
 
 Lexer::Lexer(std::string source, std::string filename)
-    : source_(std::move(source)), filename_(std::move(filename)) {
+    : sourceManager_(std::make_shared<source::SourceManager>()),
+      kernels_(scanKernels()) {
+    fileId_ = sourceManager_->addBuffer(std::move(source), filename);
+    source_ = sourceManager_->getBufferData(fileId_);
+}
+
+Lexer::Lexer(std::unique_ptr<source::SourceBuffer> buffer, std::string filename)
+    : sourceManager_(std::make_shared<source::SourceManager>()),
+      kernels_(scanKernels()) {
+    fileId_ = sourceManager_->addBuffer(std::move(buffer), filename);
+    source_ = sourceManager_->getBufferData(fileId_);
 }
 
 char Lexer::peek() const {
@@ -109,14 +66,7 @@ char Lexer::peek(size_t n) const {
 }
 
 char Lexer::advance() {
-    char c = source_[pos_++];
-    if (c == '\n') {
-        ++line_;
-        column_ = 1;
-    } else {
-        ++column_;
-    }
-    return c;
+    return source_[pos_++];
 }
 
 bool Lexer::isAtEnd() const {
@@ -131,32 +81,44 @@ bool Lexer::match(char expected) {
     return true;
 }
 
+static_assert((Lexer::kMaxLookahead & (Lexer::kMaxLookahead - 1)) == 0,
+              "lookahead capacity must be a power of two");
+
 Token Lexer::nextToken() {
-    if (!lookahead_.empty()) {
-        Token tok = std::move(lookahead_.front());
-        lookahead_.erase(lookahead_.begin());
+    if (lookaheadCount_ > 0) {
+        Token tok = std::move(lookahead_[lookaheadHead_]);
+        lookaheadHead_ = (lookaheadHead_ + 1) & (kMaxLookahead - 1);
+        --lookaheadCount_;
         return tok;
     }
     return scanToken();
 }
 
-Token Lexer::peekToken() {
+const Token& Lexer::peekToken() {
     return peekToken(0);
 }
 
-Token Lexer::peekToken(size_t n) {
-    while (lookahead_.size() <= n) {
-        lookahead_.push_back(scanToken());
+const Token& Lexer::peekToken(size_t n) {
+    if (n >= kMaxLookahead) {
+        throw std::out_of_range("Lexer lookahead exceeds " + std::to_string(kMaxLookahead) + " tokens");
     }
-    return lookahead_[n];
+    while (lookaheadCount_ <= n) {
+        lookahead_[(lookaheadHead_ + lookaheadCount_) & (kMaxLookahead - 1)] = scanToken();
+        ++lookaheadCount_;
+    }
+    return lookahead_[(lookaheadHead_ + n) & (kMaxLookahead - 1)];
 }
 
 bool Lexer::hasMore() const {
-    return !isAtEnd() || !lookahead_.empty();
+    return !isAtEnd() || lookaheadCount_ > 0;
 }
 
 ast::SourceLocation Lexer::currentLocation() const {
-    return {filename_, line_, column_};
+    return {fileId_, static_cast<uint32_t>(pos_)};
+}
+
+std::string_view Lexer::sliceFrom(size_t start) const {
+    return std::string_view(source_).substr(start, pos_ - start);
 }
 
 void Lexer::skipWhitespaceAndComments() {
@@ -167,7 +129,7 @@ void Lexer::skipWhitespaceAndComments() {
             case '\t':
             case '\r':
             case '\n':
-                advance();
+                pos_ = kernels_.skipBlanks(source_.data(), pos_, source_.size());
                 break;
             case '/':
                 if (peek(1) == '/') {
@@ -186,25 +148,19 @@ void Lexer::skipWhitespaceAndComments() {
 
 void Lexer::skipLineComment() {
     // Skip the //
-    advance();
-    advance();
-    while (!isAtEnd() && peek() != '\n') {
-        advance();
-    }
+    pos_ += 2;
+    pos_ = kernels_.findNewline(source_.data(), pos_, source_.size());
 }
 
 void Lexer::skipBlockComment() {
     // Skip the /*
-    advance();
-    advance();
-    while (!isAtEnd()) {
-        if (peek() == '*' && peek(1) == '/') {
-            advance();
-            advance();
-            return;
-        }
-        advance();
+    pos_ += 2;
+    size_t end = kernels_.findBlockCommentEnd(source_.data(), pos_, source_.size());
+    if (end < source_.size()) {
+        pos_ = end + 2;
+        return;
     }
+    pos_ = source_.size();
     addError("Unterminated block comment");
 }
 
@@ -216,6 +172,7 @@ Token Lexer::scanToken() {
     }
 
     auto loc = currentLocation();
+    size_t start = pos_;
     char c = peek();
 
     // Check for preprocessor directive
@@ -228,9 +185,7 @@ Token Lexer::scanToken() {
             return scanPragma();
         }
         // Skip other preprocessor directives
-        while (!isAtEnd() && peek() != '\n') {
-            advance();
-        }
+        pos_ = kernels_.findNewline(source_.data(), pos_, source_.size());
         return scanToken();
     }
 
@@ -267,81 +222,77 @@ Token Lexer::scanToken() {
     // Operators and punctuation
     advance();
     switch (c) {
-        case ';': return Token(TokenType::Semicolon, ";", loc);
-        case ',': return Token(TokenType::Comma, ",", loc);
-        case '{': return Token(TokenType::LeftBrace, "{", loc);
-        case '}': return Token(TokenType::RightBrace, "}", loc);
-        case '(': return Token(TokenType::LeftParen, "(", loc);
-        case ')': return Token(TokenType::RightParen, ")", loc);
-        case '[': return Token(TokenType::LeftBracket, "[", loc);
-        case ']': return Token(TokenType::RightBracket, "]", loc);
-        case '=': return Token(TokenType::Equals, "=", loc);
-        case '+': return Token(TokenType::Plus, "+", loc);
-        case '-': return Token(TokenType::Minus, "-", loc);
-        case '*': return Token(TokenType::Star, "*", loc);
-        case '/': return Token(TokenType::Slash, "/", loc);
-        case '%': return Token(TokenType::Percent, "%", loc);
-        case '&': return Token(TokenType::Ampersand, "&", loc);
-        case '|': return Token(TokenType::Pipe, "|", loc);
-        case '^': return Token(TokenType::Caret, "^", loc);
-        case '~': return Token(TokenType::Tilde, "~", loc);
+        case ';': return Token(TokenType::Semicolon, sliceFrom(start), loc);
+        case ',': return Token(TokenType::Comma, sliceFrom(start), loc);
+        case '{': return Token(TokenType::LeftBrace, sliceFrom(start), loc);
+        case '}': return Token(TokenType::RightBrace, sliceFrom(start), loc);
+        case '(': return Token(TokenType::LeftParen, sliceFrom(start), loc);
+        case ')': return Token(TokenType::RightParen, sliceFrom(start), loc);
+        case '[': return Token(TokenType::LeftBracket, sliceFrom(start), loc);
+        case ']': return Token(TokenType::RightBracket, sliceFrom(start), loc);
+        case '=': return Token(TokenType::Equals, sliceFrom(start), loc);
+        case '+': return Token(TokenType::Plus, sliceFrom(start), loc);
+        case '-': return Token(TokenType::Minus, sliceFrom(start), loc);
+        case '*': return Token(TokenType::Star, sliceFrom(start), loc);
+        case '/': return Token(TokenType::Slash, sliceFrom(start), loc);
+        case '%': return Token(TokenType::Percent, sliceFrom(start), loc);
+        case '&': return Token(TokenType::Ampersand, sliceFrom(start), loc);
+        case '|': return Token(TokenType::Pipe, sliceFrom(start), loc);
+        case '^': return Token(TokenType::Caret, sliceFrom(start), loc);
+        case '~': return Token(TokenType::Tilde, sliceFrom(start), loc);
         case ':':
             if (match(':')) {
-                return Token(TokenType::DoubleColon, "::", loc);
+                return Token(TokenType::DoubleColon, sliceFrom(start), loc);
             }
-            return Token(TokenType::Colon, ":", loc);
+            return Token(TokenType::Colon, sliceFrom(start), loc);
         case '<':
             if (match('<')) {
-                return Token(TokenType::LeftShift, "<<", loc);
+                return Token(TokenType::LeftShift, sliceFrom(start), loc);
             }
-            return Token(TokenType::LeftAngle, "<", loc);
+            return Token(TokenType::LeftAngle, sliceFrom(start), loc);
         case '>':
             if (match('>')) {
-                return Token(TokenType::RightShift, ">>", loc);
+                return Token(TokenType::RightShift, sliceFrom(start), loc);
             }
-            return Token(TokenType::RightAngle, ">", loc);
+            return Token(TokenType::RightAngle, sliceFrom(start), loc);
         default:
             addError("Unexpected character: " + std::string(1, c));
-            return Token(TokenType::Unknown, std::string(1, c), loc);
+            return Token(TokenType::Unknown, sliceFrom(start), loc);
     }
 }
 
 Token Lexer::scanIdentifierOrKeyword() {
     auto loc = currentLocation();
-    std::string text;
+    size_t start = pos_;
 
-    while (!isAtEnd() && isIdentifierChar(peek())) {
-        text += advance();
-    }
+    pos_ = kernels_.skipIdentifierChars(source_.data(), pos_, source_.size());
+    std::string_view text = sliceFrom(start);
 
-    // Check if it's a keyword
-    if (auto kw = lookupKeyword(text)) {
-        return Token(*kw, text, loc);
-    }
-
-    return Token(TokenType::Identifier, text, text, loc);
+    // Keywords and identifiers share the same path; the table returns
+    // TokenType::Identifier for anything that is not a keyword
+    return Token(kKeywordTable.lookup(text), text, loc);
 }
 
 Token Lexer::scanNumber() {
     auto loc = currentLocation();
-    std::string text;
+    size_t start = pos_;
     bool isFloat = false;
     bool isHex = false;
     bool isOctal = false;
 
     // Check for hex or octal prefix
     if (peek() == '0') {
-        text += advance();
+        advance();
         if (peek() == 'x' || peek() == 'X') {
             isHex = true;
-            text += advance();
+            advance();
             while (!isAtEnd() && isHexDigit(peek())) {
-                text += advance();
+                advance();
             }
         } else if (isOctalDigit(peek())) {
             isOctal = true;
             while (!isAtEnd() && isOctalDigit(peek())) {
-                text += advance();
+                advance();
             }
         }
     }
@@ -349,124 +300,147 @@ Token Lexer::scanNumber() {
     if (!isHex && !isOctal) {
         // Decimal number
         while (!isAtEnd() && isDigit(peek())) {
-            text += advance();
+            advance();
         }
 
         // Check for fractional part
         if (peek() == '.' && isDigit(peek(1))) {
             isFloat = true;
-            text += advance(); // consume '.'
+            advance(); // consume '.'
             while (!isAtEnd() && isDigit(peek())) {
-                text += advance();
+                advance();
             }
         }
 
         // Check for exponent
         if (peek() == 'e' || peek() == 'E') {
             isFloat = true;
-            text += advance();
+            advance();
             if (peek() == '+' || peek() == '-') {
-                text += advance();
+                advance();
             }
             while (!isAtEnd() && isDigit(peek())) {
-                text += advance();
+                advance();
             }
         }
 
         // Check for float suffix
         if (peek() == 'f' || peek() == 'F' || peek() == 'd' || peek() == 'D') {
             isFloat = true;
-            text += advance();
+            advance();
         }
     }
 
+    std::string_view text = sliceFrom(start);
+
     if (isFloat) {
-        double value = std::stod(text);
+        // The source may be a mapped file with no terminating NUL, so
+        // strtod reads a terminated copy of the lexeme
+        std::string lexeme(text);
+        double value = std::strtod(lexeme.c_str(), nullptr);
         return Token(TokenType::FloatLiteral, value, text, loc);
-    } else {
-        int64_t value = 0;
-        if (isHex) {
-            value = std::stoll(text, nullptr, 16);
-        } else if (isOctal) {
-            value = std::stoll(text, nullptr, 8);
-        } else {
-            value = std::stoll(text);
-        }
-        return Token(TokenType::IntegerLiteral, value, text, loc);
     }
+
+    int64_t value = 0;
+    std::string_view digits = text;
+    int base = 10;
+    if (isHex) {
+        digits.remove_prefix(2);
+        base = 16;
+    } else if (isOctal) {
+        base = 8;
+    }
+    auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value, base);
+    (void)ptr;
+    if (ec == std::errc::result_out_of_range) {
+        addError("Integer literal out of range: " + std::string(text));
+    }
+    return Token(TokenType::IntegerLiteral, value, text, loc);
 }
 
 Token Lexer::scanString(bool isWide) {
     auto loc = currentLocation();
-    std::string text;
-    std::string value;
+    size_t start = pos_;
 
     advance(); // consume opening quote
-    text += '"';
+    size_t contentStart = pos_;
 
-    while (!isAtEnd() && peek() != '"') {
-        if (peek() == '\n') {
-            addError("Unterminated string literal");
-            break;
-        }
-        if (peek() == '\\') {
-            text += advance();
-            if (isAtEnd()) break;
-            char escaped = advance();
-            text += escaped;
-            switch (escaped) {
-                case 'n': value += '\n'; break;
-                case 't': value += '\t'; break;
-                case 'r': value += '\r'; break;
-                case '\\': value += '\\'; break;
-                case '"': value += '"'; break;
-                case '\'': value += '\''; break;
-                case '0': value += '\0'; break;
-                case 'x': {
-                    // Hex escape
-                    std::string hex;
-                    while (hex.size() < 2 && !isAtEnd() && isHexDigit(peek())) {
-                        hex += advance();
-                        text += hex.back();
-                    }
-                    if (!hex.empty()) {
-                        value += static_cast<char>(std::stoi(hex, nullptr, 16));
+    // Fast path: literals without escapes are referenced in place
+    while (!isAtEnd() && peek() != '"' && peek() != '\\' && peek() != '\n') {
+        advance();
+    }
+
+    TokenValue value;
+    if (peek() == '\\') {
+        std::string decoded(source_, contentStart, pos_ - contentStart);
+
+        while (!isAtEnd() && peek() != '"') {
+            if (peek() == '\n') {
+                break;
+            }
+            if (peek() == '\\') {
+                advance();
+                if (isAtEnd()) break;
+                char escaped = advance();
+                switch (escaped) {
+                    case 'n': decoded += '\n'; break;
+                    case 't': decoded += '\t'; break;
+                    case 'r': decoded += '\r'; break;
+                    case '\\': decoded += '\\'; break;
+                    case '"': decoded += '"'; break;
+                    case '\'': decoded += '\''; break;
+                    case '0': decoded += '\0'; break;
+                    case 'x': {
+                        // Hex escape
+                        int hex = 0;
+                        int digits = 0;
+                        while (digits < 2 && !isAtEnd() && isHexDigit(peek())) {
+                            char h = advance();
+                            hex = hex * 16 + (isDigit(h) ? h - '0' : (h | 0x20) - 'a' + 10);
+                            ++digits;
+                        }
+                        if (digits > 0) {
+                            decoded += static_cast<char>(hex);
+                        }
+                        break;
                     }
-                    break;
+                    default:
+                        decoded += escaped;
+                        break;
                 }
-                default:
-                    value += escaped;
-                    break;
+            } else {
+                decoded += advance();
             }
-        } else {
-            char c = advance();
-            text += c;
-            value += c;
         }
+        value = std::move(decoded);
+    } else {
+        value = std::string_view(source_).substr(contentStart, pos_ - contentStart);
+    }
+
+    if (peek() == '\n') {
+        addError("Unterminated string literal");
     }
 
     if (!isAtEnd()) {
-        text += advance(); // consume closing quote
+        advance(); // consume closing quote
     }
 
     TokenType type = isWide ? TokenType::WideStringLiteral : TokenType::StringLiteral;
-    return Token(type, value, text, loc);
+    return Token(type, std::move(value), sliceFrom(start), loc);
 }
 
 Token Lexer::scanChar(bool isWide) {
     auto loc = currentLocation();
-    std::string text;
+    size_t start = pos_;
     char value = '\0';
 
     advance(); // consume opening quote
-    text += '\'';
 
     if (!isAtEnd() && peek() != '\'') {
         if (peek() == '\\') {
-            text += advance();
+            advance();
             if (!isAtEnd()) {
                 char escaped = advance();
-                text += escaped;
                 switch (escaped) {
                     case 'n': value = '\n'; break;
                     case 't': value = '\t'; break;
@@ -480,59 +454,64 @@ Token Lexer::scanChar(bool isWide) {
             }
         } else {
             value = advance();
-            text += value;
         }
     }
 
     if (!isAtEnd() && peek() == '\'') {
-        text += advance();
+        advance();
     } else {
         addError("Unterminated character literal");
     }
 
     TokenType type = isWide ? TokenType::WideCharLiteral : TokenType::CharLiteral;
-    return Token(type, value, text, loc);
+    return Token(type, value, sliceFrom(start), loc);
 }
 
 Token Lexer::scanPragma() {
     auto loc = currentLocation();
-    std::string text;
+    size_t start = pos_;
 
-    while (!isAtEnd() && peek() != '\n') {
-        text += advance();
-    }
+    pos_ = kernels_.findNewline(source_.data(), pos_, source_.size());
 
-    return Token(TokenType::Pragma, text, text, loc);
+    return Token(TokenType::Pragma, sliceFrom(start), loc);
 }
 
 Token Lexer::scanLineDirective() {
     auto loc = currentLocation();
-    std::string text;
+    size_t start = pos_;
 
     // Skip #line or # 
-    while (!isAtEnd() && peek() != '\n') {
-        text += advance();
-    }
+    pos_ = kernels_.findNewline(source_.data(), pos_, source_.size());
+    std::string_view text = sliceFrom(start);
 
     // Parse line number and filename from the directive
     // Format: #line <number> "<filename>" or # <number> "<filename>"
-    size_t start = text.find_first_of("0123456789");
-    if (start != std::string::npos) {
-        size_t end = text.find_first_not_of("0123456789", start);
-        std::string lineNumStr = text.substr(start, end - start);
-        line_ = std::stoull(lineNumStr);
+    size_t numStart = text.find_first_of("0123456789");
+    if (numStart != std::string_view::npos) {
+        size_t numEnd = text.find_first_not_of("0123456789", numStart);
+        if (numEnd == std::string_view::npos) {
+            numEnd = text.size();
+        }
+        uint32_t lineNum = 0;
+        std::from_chars(text.data() + numStart, text.data() + numEnd, lineNum);
 
         // Look for filename
-        size_t fnStart = text.find('"', end);
-        if (fnStart != std::string::npos) {
+        std::string_view filename = sourceManager_->getFilename(currentLocation());
+        size_t fnStart = text.find('"', numEnd);
+        if (fnStart != std::string_view::npos) {
             size_t fnEnd = text.find('"', fnStart + 1);
-            if (fnEnd != std::string::npos) {
-                filename_ = text.substr(fnStart + 1, fnEnd - fnStart - 1);
+            if (fnEnd != std::string_view::npos) {
+                filename = text.substr(fnStart + 1, fnEnd - fnStart - 1);
             }
         }
+
+        // The marker names the line that follows it
+        size_t nextLine = isAtEnd() ? pos_ : pos_ + 1;
+        fileId_ = sourceManager_->addLineMarker(fileId_, filename,
+                                                static_cast<uint32_t>(nextLine), lineNum);
     }
 
-    return Token(TokenType::LineDirective, text, text, loc);
+    return Token(TokenType::LineDirective, text, loc);
 }
 
 void Lexer::addError(const std::string& message) {
@@ -567,7 +546,7 @@ bool Lexer::isIdentifierChar(char c) {
     return isAlphaNumeric(c) || c == '_';
 }
 
-std::string tokenTypeToString(TokenType type) {
+std::string_view tokenTypeToString(TokenType type) {
     switch (type) {
         case TokenType::Eof: return "EOF";
         case TokenType::Identifier: return "identifier";
@@ -1,12 +1,17 @@
 #ifndef IBORB_IDL_LEXER_HPP
 #define IBORB_IDL_LEXER_HPP
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <optional>
 #include <variant>
 #include "ast/ast.hpp"
+#include "source/source_manager.hpp"
+#include "lexer/simd_scan.hpp"
 
 namespace iborb::lexer {
 
@@ -117,26 +122,30 @@ using TokenValue = std::variant<
     int64_t,            // Integer value
     uint64_t,           // Unsigned integer value
     double,             // Float value
-    std::string,        // String/identifier value
+    std::string_view,   // String literal without escapes (slice of the source)
+    std::string,        // String literal with escapes (decoded copy)
     char                // Character value
 >;
 
 /**
  * @brief Token structure
+ *
+ * The token text is a view into the lexer's source buffer and is only
+ * valid while the lexer that produced it is alive.
  */
 struct Token {
     TokenType type = TokenType::Unknown;
     TokenValue value;
-    std::string text;  // Original text
+    std::string_view text;  // Original text
     ast::SourceLocation location;
 
     Token() = default;
     Token(TokenType t, ast::SourceLocation loc)
-        : type(t), location(std::move(loc)) {}
-    Token(TokenType t, std::string txt, ast::SourceLocation loc)
-        : type(t), text(std::move(txt)), location(std::move(loc)) {}
-    Token(TokenType t, TokenValue val, std::string txt, ast::SourceLocation loc)
-        : type(t), value(std::move(val)), text(std::move(txt)), location(std::move(loc)) {}
+        : type(t), location(loc) {}
+    Token(TokenType t, std::string_view txt, ast::SourceLocation loc)
+        : type(t), text(txt), location(loc) {}
+    Token(TokenType t, TokenValue val, std::string_view txt, ast::SourceLocation loc)
+        : type(t), value(std::move(val)), text(txt), location(loc) {}
 
     bool is(TokenType t) const { return type == t; }
     bool isNot(TokenType t) const { return type != t; }
@@ -144,6 +153,11 @@ struct Token {
     bool isLiteral() const;
     bool isOperator() const;
 
+    /**
+     * @brief Decoded contents of a string literal token
+     */
+    std::string_view stringValue() const;
+
     std::string_view typeName() const;
 };
 
@@ -169,6 +183,18 @@ public:
      */
     Lexer(std::string source, std::string filename = "<input>");
 
+    /**
+     * @brief Construct lexer over a mapped or owning source buffer
+     * @param buffer Source buffer, lexed in place without copying
+     * @param filename Filename for error reporting
+     */
+    Lexer(std::unique_ptr<source::SourceBuffer> buffer, std::string filename = "<input>");
+
+    /**
+     * @brief Maximum number of tokens that can be buffered by peekToken()
+     */
+    static constexpr size_t kMaxLookahead = 8;
+
     /**
      * @brief Get the next token
      */
@@ -177,12 +203,14 @@ public:
     /**
      * @brief Peek at the next token without consuming it
      */
-    Token peekToken();
+    const Token& peekToken();
 
     /**
      * @brief Peek at a token N positions ahead
+     * @param n Distance from the next token, must be less than kMaxLookahead
+     * @return Reference valid until the token is consumed by nextToken()
      */
-    Token peekToken(size_t n);
+    const Token& peekToken(size_t n);
 
     /**
      * @brief Check if there are more tokens
@@ -204,13 +232,25 @@ public:
      */
     ast::SourceLocation currentLocation() const;
 
+    /**
+     * @brief Get the source manager that resolves token locations
+     */
+    const std::shared_ptr<source::SourceManager>& getSourceManager() const {
+        return sourceManager_;
+    }
+
 private:
-    std::string source_;
-    std::string filename_;
+    std::shared_ptr<source::SourceManager> sourceManager_;
+    std::string_view source_;  // Owned by sourceManager_
+    const ScanKernels& kernels_;  // Bulk scanning for whitespace, comments, identifiers
+    uint32_t fileId_ = 0;      // Current file entry, advanced by line markers
     size_t pos_ = 0;
-    size_t line_ = 1;
-    size_t column_ = 1;
-    std::vector<Token> lookahead_;
+
+    // Lookahead ring buffer (kMaxLookahead is a power of two)
+    std::array<Token, kMaxLookahead> lookahead_;
+    size_t lookaheadHead_ = 0;
+    size_t lookaheadCount_ = 0;
+
     std::vector<LexerError> errors_;
 
     // Character helpers
@@ -220,6 +260,9 @@ private:
     bool isAtEnd() const;
     bool match(char expected);
 
+    // Slice of the source from start to the current position
+    std::string_view sliceFrom(size_t start) const;
+
     // Scanning methods
     Token scanToken();
     void skipWhitespaceAndComments();
@@ -244,15 +287,12 @@ private:
     static bool isAlphaNumeric(char c);
     static bool isIdentifierStart(char c);
     static bool isIdentifierChar(char c);
-
-    // Keyword lookup
-    static std::optional<TokenType> lookupKeyword(const std::string& name);
 };
 
 /**
  * @brief Convert token type to string for debugging
  */
-std::string tokenTypeToString(TokenType type);
+std::string_view tokenTypeToString(TokenType type);
 
 } // namespace iborb::lexer
 
@@ -0,0 +1,304 @@
+#include "lexer/simd_scan.hpp"
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IBORB_HAVE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#if IBORB_HAVE_SSE2 && (defined(__GNUC__) || defined(__clang__))
+    // AVX2 kernels are compiled with a target attribute and only selected
+    // after a runtime CPU check
+    #define IBORB_HAVE_AVX2 1
+    #include <immintrin.h>
+    #define IBORB_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace iborb::lexer {
+
+namespace {
+
+// Index of the lowest set bit (mask must be non-zero)
+inline unsigned lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ============================================================================
+// Scalar Kernels
+// ============================================================================
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool isIdentChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+size_t skipBlanksScalar(const char* data, size_t pos, size_t size) {
+    while (pos < size && isBlank(data[pos])) ++pos;
+    return pos;
+}
+
+size_t skipIdentifierCharsScalar(const char* data, size_t pos, size_t size) {
+    while (pos < size && isIdentChar(data[pos])) ++pos;
+    return pos;
+}
+
+size_t findNewlineScalar(const char* data, size_t pos, size_t size) {
+    if (pos >= size) return size;
+    const void* hit = std::memchr(data + pos, '\n', size - pos);
+    return hit ? static_cast<size_t>(static_cast<const char*>(hit) - data) : size;
+}
+
+size_t findBlockCommentEndScalar(const char* data, size_t pos, size_t size) {
+    while (pos + 1 < size) {
+        if (data[pos] == '*' && data[pos + 1] == '/') return pos;
+        ++pos;
+    }
+    return size;
+}
+
+// ============================================================================
+// SSE2 Kernels
+// ============================================================================
+
+#if IBORB_HAVE_SSE2
+
+// Bytes of x within [lo, hi], using signed compares on biased values
+inline __m128i inRange128(__m128i x, char lo, char hi) {
+    __m128i biased = _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(0x80 + (hi - lo + 1))));
+}
+
+inline __m128i blankMask128(__m128i x) {
+    __m128i sp = _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+    __m128i tab = _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'));
+    __m128i cr = _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'));
+    __m128i nl = _mm_cmpeq_epi8(x, _mm_set1_epi8('\n'));
+    return _mm_or_si128(_mm_or_si128(sp, tab), _mm_or_si128(cr, nl));
+}
+
+inline __m128i identMask128(__m128i x) {
+    __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    __m128i alpha = inRange128(lower, 'a', 'z');
+    __m128i digit = inRange128(x, '0', '9');
+    __m128i under = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+}
+
+size_t skipBlanksSSE2(const char* data, size_t pos, size_t size) {
+    while (pos + 16 <= size) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto stop = static_cast<unsigned>(~_mm_movemask_epi8(blankMask128(x))) & 0xFFFFu;
+        if (stop) return pos + lowestBit(stop);
+        pos += 16;
+    }
+    return skipBlanksScalar(data, pos, size);
+}
+
+size_t skipIdentifierCharsSSE2(const char* data, size_t pos, size_t size) {
+    while (pos + 16 <= size) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto stop = static_cast<unsigned>(~_mm_movemask_epi8(identMask128(x))) & 0xFFFFu;
+        if (stop) return pos + lowestBit(stop);
+        pos += 16;
+    }
+    return skipIdentifierCharsScalar(data, pos, size);
+}
+
+size_t findNewlineSSE2(const char* data, size_t pos, size_t size) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (pos + 16 <= size) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto hit = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, nl)));
+        if (hit) return pos + lowestBit(hit);
+        pos += 16;
+    }
+    return findNewlineScalar(data, pos, size);
+}
+
+size_t findBlockCommentEndSSE2(const char* data, size_t pos, size_t size) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    while (pos + 17 <= size) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1));
+        __m128i both = _mm_and_si128(_mm_cmpeq_epi8(a, star), _mm_cmpeq_epi8(b, slash));
+        auto hit = static_cast<unsigned>(_mm_movemask_epi8(both));
+        if (hit) return pos + lowestBit(hit);
+        pos += 16;
+    }
+    return findBlockCommentEndScalar(data, pos, size);
+}
+
+#endif // IBORB_HAVE_SSE2
+
+// ============================================================================
+// AVX2 Kernels
+// ============================================================================
+
+#if IBORB_HAVE_AVX2
+
+IBORB_TARGET_AVX2 inline __m256i inRange256(__m256i x, char lo, char hi) {
+    __m256i biased = _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + (hi - lo + 1))), biased);
+}
+
+IBORB_TARGET_AVX2 size_t skipBlanksAVX2(const char* data, size_t pos, size_t size) {
+    while (pos + 32 <= size) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i sp = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '));
+        __m256i tab = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'));
+        __m256i cr = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'));
+        __m256i nl = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'));
+        __m256i blank = _mm256_or_si256(_mm256_or_si256(sp, tab), _mm256_or_si256(cr, nl));
+        auto stop = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+        if (stop) return pos + lowestBit(stop);
+        pos += 32;
+    }
+    return skipBlanksSSE2(data, pos, size);
+}
+
+IBORB_TARGET_AVX2 size_t skipIdentifierCharsAVX2(const char* data, size_t pos, size_t size) {
+    while (pos + 32 <= size) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i alpha = inRange256(lower, 'a', 'z');
+        __m256i digit = inRange256(x, '0', '9');
+        __m256i under = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_'));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+        auto stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+        if (stop) return pos + lowestBit(stop);
+        pos += 32;
+    }
+    return skipIdentifierCharsSSE2(data, pos, size);
+}
+
+IBORB_TARGET_AVX2 size_t findNewlineAVX2(const char* data, size_t pos, size_t size) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    while (pos + 32 <= size) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        auto hit = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, nl)));
+        if (hit) return pos + lowestBit(hit);
+        pos += 32;
+    }
+    return findNewlineSSE2(data, pos, size);
+}
+
+IBORB_TARGET_AVX2 size_t findBlockCommentEndAVX2(const char* data, size_t pos, size_t size) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    while (pos + 33 <= size) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 1));
+        __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(a, star), _mm256_cmpeq_epi8(b, slash));
+        auto hit = static_cast<unsigned>(_mm256_movemask_epi8(both));
+        if (hit) return pos + lowestBit(hit);
+        pos += 32;
+    }
+    return findBlockCommentEndSSE2(data, pos, size);
+}
+
+#endif // IBORB_HAVE_AVX2
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+constexpr ScanKernels kScalarKernels = {
+    SimdLevel::Scalar,
+    skipBlanksScalar,
+    skipIdentifierCharsScalar,
+    findNewlineScalar,
+    findBlockCommentEndScalar
+};
+
+#if IBORB_HAVE_SSE2
+constexpr ScanKernels kSSE2Kernels = {
+    SimdLevel::SSE2,
+    skipBlanksSSE2,
+    skipIdentifierCharsSSE2,
+    findNewlineSSE2,
+    findBlockCommentEndSSE2
+};
+#endif
+
+#if IBORB_HAVE_AVX2
+constexpr ScanKernels kAVX2Kernels = {
+    SimdLevel::AVX2,
+    skipBlanksAVX2,
+    skipIdentifierCharsAVX2,
+    findNewlineAVX2,
+    findBlockCommentEndAVX2
+};
+#endif
+
+const ScanKernels* kernelsFor(SimdLevel level) {
+    switch (level) {
+#if IBORB_HAVE_AVX2
+        case SimdLevel::AVX2: return &kAVX2Kernels;
+#endif
+#if IBORB_HAVE_SSE2
+        case SimdLevel::SSE2: return &kSSE2Kernels;
+#endif
+        default: return &kScalarKernels;
+    }
+}
+
+std::atomic<const ScanKernels*> activeKernels{nullptr};
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#if IBORB_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+#if IBORB_HAVE_SSE2
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const ScanKernels& scanKernels() {
+    const ScanKernels* kernels = activeKernels.load(std::memory_order_acquire);
+    if (!kernels) {
+        kernels = kernelsFor(detectSimdLevel());
+        activeKernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+void setSimdLevel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detectSimdLevel())) {
+        level = detectSimdLevel();
+    }
+    activeKernels.store(kernelsFor(level), std::memory_order_release);
+}
+
+std::string_view simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2: return "sse2";
+        case SimdLevel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace iborb::lexer
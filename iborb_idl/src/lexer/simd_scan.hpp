@@ -0,0 +1,66 @@
+#ifndef IBORB_IDL_SIMD_SCAN_HPP
+#define IBORB_IDL_SIMD_SCAN_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace iborb::lexer {
+
+/**
+ * @brief Instruction set used by the scanning kernels
+ */
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/**
+ * @brief Bulk scanning kernels used by the lexer hot loops
+ *
+ * Every kernel takes the buffer, a start position and the buffer size,
+ * and returns the position of the first byte that stops the scan (or
+ * size if none does). Vector kernels examine 16 (SSE2) or 32 (AVX2)
+ * bytes per step and never read past size.
+ */
+struct ScanKernels {
+    SimdLevel level;
+
+    // First byte that is not ' ', '\t', '\r' or '\n'
+    size_t (*skipBlanks)(const char* data, size_t pos, size_t size);
+
+    // First byte that is not [A-Za-z0-9_]
+    size_t (*skipIdentifierChars)(const char* data, size_t pos, size_t size);
+
+    // First '\n'
+    size_t (*findNewline)(const char* data, size_t pos, size_t size);
+
+    // First '*' that is immediately followed by '/'
+    size_t (*findBlockCommentEnd)(const char* data, size_t pos, size_t size);
+};
+
+/**
+ * @brief Best instruction set supported by the running CPU
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief Kernels for the active SIMD level (detected on first use)
+ */
+const ScanKernels& scanKernels();
+
+/**
+ * @brief Force a SIMD level (clamped to what the CPU supports)
+ *
+ * Intended for benchmarks and debugging; affects lexers created afterwards.
+ */
+void setSimdLevel(SimdLevel level);
+
+/**
+ * @brief Name of a SIMD level for diagnostics
+ */
+std::string_view simdLevelName(SimdLevel level);
+
+} // namespace iborb::lexer
+
+#endif // IBORB_IDL_SIMD_SCAN_HPP
@@ -8,17 +8,31 @@
  * @copyright (c) 2024 ibORB Project
  */
 
+#include <charconv>
 #include <iostream>
-#include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <filesystem>
 
+#include "cache/manifest.hpp"
+#include "cache/unit_cache.hpp"
+#include "driver/compile_server.hpp"
+#include "driver/definition_pipeline.hpp"
+#include "driver/dependency_file.hpp"
+#include "driver/worker_pool.hpp"
 #include "preprocessor/preprocessor.hpp"
+#include "preprocessor/builtin_preprocessor.hpp"
+#include "source/source_buffer.hpp"
 #include "lexer/lexer.hpp"
 #include "parser/parser.hpp"
+#include "parser/include_cache.hpp"
+#include "semantic/analyzer.hpp"
 #include "generator/cpp11_generator.hpp"
+#include "generator/output_file.hpp"
 
 namespace fs = std::filesystem;
 
@@ -31,17 +45,29 @@ struct Options {
     std::vector<std::string> includePaths;
     std::vector<std::pair<std::string, std::string>> defines;
     bool usePreprocessor = true;
+    bool externalPreprocessor = false;  // Use gcc/clang instead of the built-in one
+    bool includeCache = true;  // Parse shared headers once per invocation
+    std::string cacheDir;  // Analyzed units kept across runs (empty: none)
+    unsigned jobs = 0;  // Worker threads (0: one per hardware thread)
     bool verbose = false;
     bool help = false;
     bool version = false;
     bool parseOnly = false;  // Don't generate code
+    bool stream = false;  // Generate each definition as soon as it is parsed
+    bool splitHeaders = false;  // A header per type, plus <name>_fwd.hpp
+    bool externTemplates = false;  // Instantiate sequences and struct equality in the source file
+    bool writeDepfile = false;  // Write Make rules for the generated files
+    std::string depfilePath;    // All rules in this file (empty: <header>.d per input)
+    bool incremental = false;   // Skip the inputs the output directory's manifest shows up to date
+    std::string serverSocket;   // Serve compile requests on this socket
+    std::string connectSocket;  // Have the server on this socket compile instead
 };
 
 /**
  * @brief Print usage information
  */
-void printUsage(const char* program) {
-    std::cout << "Usage: " << program << " [options] <idl-files...>\n"
+void printUsage(const char* program, std::ostream& out) {
+    out << "Usage: " << program << " [options] <idl-files...>\n"
               << "\n"
               << "Options:\n"
               << "  -h, --help            Show this help message\n"
@@ -50,7 +76,33 @@ void printUsage(const char* program) {
               << "  -I, --include <path>  Add include search path\n"
               << "  -D, --define <name>[=<value>]  Define preprocessor macro\n"
               << "  -E, --no-preprocess   Skip preprocessor (process raw IDL)\n"
+              << "  --preprocessor <builtin|external>\n"
+              << "                        Preprocessor to run (default: builtin; falls back\n"
+              << "                        to external for input it cannot handle)\n"
+              << "  --no-include-cache    Re-read shared headers for every input file\n"
+              << "  --cache-dir <dir>     Load analyzed units stored by earlier runs from <dir>\n"
+              << "                        instead of parsing them, and store new ones there\n"
+              << "  -j, --jobs <n>        Process up to n files in parallel (default: one per core)\n"
               << "  -p, --parse-only      Parse only, don't generate code\n"
+              << "  -MD                   Write a Make rule listing the files each input read\n"
+              << "                        to <output dir>/<name>.d\n"
+              << "  -MF <file>            Write the Make rules of all inputs to <file> (implies -MD)\n"
+              << "  --incremental         Skip inputs that, like every file they include, did\n"
+              << "                        not change since the last run with the same options\n"
+              << "  --stream              Generate each definition as soon as it is parsed,\n"
+              << "                        keeping only a few in memory at a time\n"
+              << "  --split-headers       Write a header per struct, union, exception and\n"
+              << "                        interface, and <name>_fwd.hpp with the forward\n"
+              << "                        declarations, enums, typedefs and constants\n"
+              << "                        (not with --stream)\n"
+              << "  --extern-templates    Define struct equality and instantiate sequences of\n"
+              << "                        generated types in the source file, declaring them\n"
+              << "                        extern in the header\n"
+              << "  --server <socket>     Keep running and compile the requests of clients\n"
+              << "                        started with --connect <socket>\n"
+              << "  --connect <socket>    Have the server on <socket> compile, keeping shared\n"
+              << "                        headers parsed between invocations (compiles in this\n"
+              << "                        process if no server is running)\n"
               << "  --verbose             Enable verbose output\n"
               << "\n"
               << "Examples:\n"
@@ -62,8 +114,8 @@ void printUsage(const char* program) {
 /**
  * @brief Print version information
  */
-void printVersion() {
-    std::cout << "iborb_idl version 1.0.0\n"
+void printVersion(std::ostream& out) {
+    out << "iborb_idl version 1.0.0\n"
               << "CORBA IDL to C++11 Compiler\n"
               << "Part of the ibORB project\n";
 }
@@ -71,11 +123,11 @@ void printVersion() {
 /**
  * @brief Parse command line arguments
  */
-Options parseArguments(int argc, char* argv[]) {
+Options parseArguments(const std::vector<std::string>& args, std::ostream& err) {
     Options opts;
 
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
 
         if (arg == "-h" || arg == "--help") {
             opts.help = true;
@@ -84,22 +136,22 @@ Options parseArguments(int argc, char* argv[]) {
             opts.version = true;
         }
         else if (arg == "-o" || arg == "--output") {
-            if (i + 1 < argc) {
-                opts.outputDir = argv[++i];
+            if (i + 1 < args.size()) {
+                opts.outputDir = args[++i];
             } else {
-                std::cerr << "Error: -o requires an argument\n";
+                err << "Error: -o requires an argument\n";
             }
         }
         else if (arg == "-I" || arg == "--include") {
-            if (i + 1 < argc) {
-                opts.includePaths.push_back(argv[++i]);
+            if (i + 1 < args.size()) {
+                opts.includePaths.push_back(args[++i]);
             } else {
-                std::cerr << "Error: -I requires an argument\n";
+                err << "Error: -I requires an argument\n";
             }
         }
         else if (arg == "-D" || arg == "--define") {
-            if (i + 1 < argc) {
-                std::string def = argv[++i];
+            if (i + 1 < args.size()) {
+                std::string def = args[++i];
                 size_t eq = def.find('=');
                 if (eq != std::string::npos) {
                     opts.defines.emplace_back(def.substr(0, eq), def.substr(eq + 1));
@@ -107,20 +159,91 @@ Options parseArguments(int argc, char* argv[]) {
                     opts.defines.emplace_back(def, "1");
                 }
             } else {
-                std::cerr << "Error: -D requires an argument\n";
+                err << "Error: -D requires an argument\n";
             }
         }
         else if (arg == "-E" || arg == "--no-preprocess") {
             opts.usePreprocessor = false;
         }
+        else if (arg == "--preprocessor") {
+            if (i + 1 < args.size()) {
+                std::string kind = args[++i];
+                if (kind == "builtin") {
+                    opts.externalPreprocessor = false;
+                } else if (kind == "external") {
+                    opts.externalPreprocessor = true;
+                } else {
+                    err << "Error: --preprocessor must be 'builtin' or 'external'\n";
+                }
+            } else {
+                err << "Error: --preprocessor requires an argument\n";
+            }
+        }
+        else if (arg == "--no-include-cache") {
+            opts.includeCache = false;
+        }
+        else if (arg == "--cache-dir") {
+            if (i + 1 < args.size()) {
+                opts.cacheDir = args[++i];
+            } else {
+                err << "Error: --cache-dir requires an argument\n";
+            }
+        }
+        else if (arg == "-j" || arg == "--jobs" || (arg.size() > 2 && arg.compare(0, 2, "-j") == 0)) {
+            std::string value;
+            if (arg.size() > 2 && arg[1] == 'j') {
+                value = arg.substr(2);
+            } else if (i + 1 < args.size()) {
+                value = args[++i];
+            }
+            // Signs, trailing characters and values that overflow are all rejected
+            unsigned jobs = 0;
+            const char* end = value.data() + value.size();
+            auto [ptr, ec] = std::from_chars(value.data(), end, jobs);
+            if (ec == std::errc() && ptr == end && jobs > 0) {
+                opts.jobs = jobs;
+            } else {
+                err << "Error: -j requires a positive number\n";
+            }
+        }
         else if (arg == "-p" || arg == "--parse-only") {
             opts.parseOnly = true;
         }
+        else if (arg == "-MD") {
+            opts.writeDepfile = true;
+        }
+        else if (arg == "-MF") {
+            if (i + 1 < args.size()) {
+                opts.depfilePath = args[++i];
+                opts.writeDepfile = true;
+            } else {
+                err << "Error: -MF requires an argument\n";
+            }
+        }
+        else if (arg == "--incremental") {
+            opts.incremental = true;
+        }
+        else if (arg == "--stream") {
+            opts.stream = true;
+        }
+        else if (arg == "--split-headers") {
+            opts.splitHeaders = true;
+        }
+        else if (arg == "--extern-templates") {
+            opts.externTemplates = true;
+        }
+        else if (arg == "--server" || arg == "--connect") {
+            if (i + 1 < args.size()) {
+                (arg == "--server" ? opts.serverSocket : opts.connectSocket) = args[++i];
+            } else {
+                err << "Error: " << arg << " requires an argument\n";
+            }
+        }
         else if (arg == "--verbose") {
             opts.verbose = true;
         }
         else if (arg[0] == '-') {
-            std::cerr << "Warning: Unknown option: " << arg << "\n";
+            err << "Warning: Unknown option: " << arg << "\n";
         }
         else {
             opts.inputFiles.push_back(arg);
@@ -132,145 +255,485 @@ Options parseArguments(int argc, char* argv[]) {
 
 /**
  * @brief Read file contents
+ *
+ * The file is memory-mapped where possible, so the lexer scans it in
+ * place without an intermediate copy.
+ */
+std::unique_ptr<iborb::source::SourceBuffer> readFile(const std::string& path) {
+    return iborb::source::SourceBuffer::fromFile(path);
+}
+
+/**
+ * @brief Run the system C preprocessor on a file
+ */
+iborb::preprocessor::PreprocessResult runExternalPreprocessor(const std::string& inputFile,
+                                                              const Options& opts,
+                                                              std::ostream& out) {
+    if (opts.verbose) {
+        out << "  Running external preprocessor...\n";
+    }
+
+    iborb::preprocessor::Preprocessor pp;
+    if (!pp.isAvailable()) {
+        // No preprocessor found on system
+        if (opts.verbose) {
+            out << "  No C preprocessor found...\n";
+        }
+        iborb::preprocessor::PreprocessResult result;
+        result.errorMessage = "No suitable C preprocessor found";
+        return result;
+    }
+
+    for (const auto& path : opts.includePaths) {
+        pp.addIncludePath(path);
+    }
+    for (const auto& [name, value] : opts.defines) {
+        pp.addDefine(name, value);
+    }
+    return pp.preprocessFile(inputFile);
+}
+
+/**
+ * @brief Create a built-in preprocessor configured from the options
+ */
+iborb::preprocessor::BuiltinPreprocessor makeBuiltinPreprocessor(const Options& opts) {
+    iborb::preprocessor::BuiltinPreprocessor pp;
+    for (const auto& path : opts.includePaths) {
+        pp.addIncludePath(path);
+    }
+    for (const auto& [name, value] : opts.defines) {
+        pp.addDefine(name, value);
+    }
+    return pp;
+}
+
+/**
+ * @brief Preprocessor settings that take part in unit cache keys
  */
-std::string readFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file) {
-        throw std::runtime_error("Cannot open file: " + path);
-    }
-    std::ostringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
+std::string cacheSettings(const Options& opts) {
+    std::string settings = opts.usePreprocessor ? (opts.externalPreprocessor ? "external" : "builtin")
+                                                : "none";
+    for (const auto& path : opts.includePaths) {
+        settings += "\n-I" + path;
+    }
+    for (const auto& [name, value] : opts.defines) {
+        settings += "\n-D" + name + "=" + value;
+    }
+    return settings;
+}
+
+/**
+ * @brief Outcome of one input file, published in input order
+ */
+struct FileResult {
+    std::string inputFile;
+    bool success = false;
+    std::ostringstream out;  // Progress messages for stdout
+    std::ostringstream err;  // Diagnostics for stderr
+    std::unique_ptr<iborb::generator::Cpp11Generator> generator;  // Files not yet written
+    bool upToDate = false;  // Skipped, as recorded in the manifest
+    std::vector<std::string> outputs;  // Files written
+    std::vector<std::string> dependencies;  // Files read, with -MD or --incremental
+    std::vector<iborb::cache::FileHash> fileHashes;  // Content of the files as they were read
+};
+
+/**
+ * @brief Print the parser's errors and warnings
+ * @return true if there were errors
+ */
+bool reportParseErrors(const iborb::parser::Parser& parser, std::ostream& err) {
+    bool hasErrors = false;
+    for (const auto& error : parser.getErrors()) {
+        err << error.message << "\n";
+        if (!error.isWarning) {
+            hasErrors = true;
+        }
+    }
+    return hasErrors;
+}
+
+/**
+ * @brief Parse, analyze and generate a file one definition at a time
+ *
+ * The header is written to a temporary file while it is generated.
+ * Like the files of generateUnit(), it is put in place by
+ * publishResult(), in input order, and only if the whole file was
+ * processed without errors.
+ */
+bool streamFile(iborb::parser::Parser& parser, const std::string& inputFile, const Options& opts,
+                FileResult& result) {
+    std::ostream& out = result.out;
+    std::ostream& err = result.err;
+
+    if (opts.verbose) {
+        out << "  Generating C++11 code while parsing...\n";
+    }
+
+    iborb::generator::GeneratorConfig genConfig;
+    genConfig.outputDir = opts.outputDir;
+    genConfig.generateImplementation = true;
+    genConfig.deferWrite = true;  // Put in place in input order by publishResult()
+    genConfig.externTemplates = opts.externTemplates;
+
+    iborb::driver::DefinitionPipeline pipeline(genConfig);
+    parser.parse(pipeline);
+
+    if (reportParseErrors(parser, err)) {
+        pipeline.finish(false);
+        err << "Parsing failed with errors.\n";
+        return false;
+    }
+
+    bool generated = pipeline.finish(true);
+
+    for (const auto& diagnostic : pipeline.getDiagnostics()) {
+        err << diagnostic.message << "\n";
+    }
+
+    if (pipeline.hasAnalysisErrors()) {
+        err << "Semantic analysis failed with errors.\n";
+        return false;
+    }
+
+    if (opts.verbose) {
+        out << "  Parsed " << pipeline.getDefinitionCount() << " top-level definitions.\n";
+    }
+
+    if (!generated) {
+        for (const auto& error : pipeline.getGeneratorErrors()) {
+            err << "Generator error: " << error << "\n";
+        }
+        return false;
+    }
+
+    result.generator = pipeline.takeGenerator();
+    result.dependencies = pipeline.getDependencies().getFiles();
+
+    if (opts.verbose) {
+        std::string baseName = fs::path(inputFile).stem().string();
+        out << "  Generated: " << (fs::path(opts.outputDir) / (baseName + ".hpp")).string() << "\n";
+    }
+    return true;
+}
+
+/**
+ * @brief Generate the code of an analyzed unit
+ * @param result Receives the messages and the generator, whose files are not yet written
+ */
+bool generateUnit(const iborb::ast::TranslationUnit& ast,
+                  const iborb::semantic::SymbolTable& symbols, const std::string& inputFile,
+                  const Options& opts, FileResult& result) {
+    std::ostream& out = result.out;
+    std::ostream& err = result.err;
+
+    if (opts.verbose) {
+        out << "  Generating C++11 code...\n";
+    }
+
+    iborb::generator::GeneratorConfig genConfig;
+    genConfig.outputDir = opts.outputDir;
+    genConfig.generateImplementation = true;
+    genConfig.deferWrite = true;  // Written in input order by publishResult()
+    genConfig.splitHeaders = opts.splitHeaders;
+    genConfig.externTemplates = opts.externTemplates;
+
+    result.generator = std::make_unique<iborb::generator::Cpp11Generator>(genConfig);
+    result.generator->setSymbolTable(&symbols);
+    if (opts.writeDepfile || opts.incremental) {
+        iborb::driver::DependencyList dependencies;
+        dependencies.add(ast);
+        result.dependencies = dependencies.getFiles();
+    }
+
+    if (!result.generator->generate(ast)) {
+        for (const auto& error : result.generator->getErrors()) {
+            err << "Generator error: " << error << "\n";
+        }
+        return false;
+    }
+
+    // Get output filename
+    fs::path inputPath(inputFile);
+    std::string baseName = inputPath.stem().string();
+    fs::path outputPath(opts.outputDir);
+
+    if (opts.verbose) {
+        out << "  Generated: " << (outputPath / (baseName + ".hpp")).string() << "\n";
+    }
+    return true;
 }
 
 /**
  * @brief Process a single IDL file
+ * @param includeCache Headers shared between input files (may be nullptr)
+ * @param unitCache Analyzed units kept across runs (may be nullptr)
+ * @param manifest What earlier runs generated into the output directory (may be nullptr)
+ * @param analysisPool Workers for analyzing the file's definitions in parallel (may be nullptr)
+ * @param result Receives the messages and generated files
+ *
+ * Runs on a worker thread, so all output goes to the result.
  */
-bool processFile(const std::string& inputFile, const Options& opts) {
+bool processFile(const std::string& inputFile, const Options& opts,
+                 iborb::parser::IncludeCache* includeCache, iborb::cache::UnitCache* unitCache,
+                 iborb::cache::Manifest* manifest, const iborb::driver::WorkerPool* analysisPool,
+                 FileResult& result) {
+    std::ostream& out = result.out;
+    std::ostream& err = result.err;
+
+    // Nothing to do if neither the input, nor anything it includes, nor its outputs changed
+    if (manifest && manifest->isUpToDate(inputFile, result.dependencies, result.outputs)) {
+        if (opts.verbose) {
+            out << "Up to date: " << inputFile << "\n";
+        }
+        result.upToDate = true;
+        return true;
+    }
+
     if (opts.verbose) {
-        std::cout << "Processing: " << inputFile << "\n";
+        out << "Processing: " << inputFile << "\n";
     }
 
-    std::string source;
+    std::unique_ptr<iborb::source::SourceBuffer> source;
     std::string filename = fs::path(inputFile).filename().string();
 
     // Step 1: Preprocessing
     if (opts.usePreprocessor) {
-        if (opts.verbose) {
-            std::cout << "  Running preprocessor...\n";
-        }
+        iborb::preprocessor::PreprocessResult preprocessed;
 
-        iborb::preprocessor::Preprocessor pp;
-        
-        if (!pp.isAvailable()) {
-            // No preprocessor found on system - use raw IDL
+        if (!opts.externalPreprocessor) {
             if (opts.verbose) {
-                std::cout << "  No C preprocessor found, using raw IDL...\n";
+                out << "  Running built-in preprocessor...\n";
             }
-            source = readFile(inputFile);
-        } else {
-            for (const auto& path : opts.includePaths) {
-                pp.addIncludePath(path);
-            }
-            for (const auto& [name, value] : opts.defines) {
-                pp.addDefine(name, value);
+
+            auto pp = makeBuiltinPreprocessor(opts);
+            pp.setIncludeHandler(includeCache);
+            preprocessed = pp.preprocessFile(inputFile);
+            if (!preprocessed.success && opts.verbose) {
+                out << "  Built-in preprocessor failed: " << preprocessed.errorMessage << "\n";
             }
+        }
 
-            auto result = pp.preprocessFile(inputFile);
-            if (!result.success) {
-                // Preprocessor failed - fall back to raw IDL
-                if (opts.verbose) {
-                    std::cout << "  Preprocessor failed, using raw IDL...\n";
-                }
-                source = readFile(inputFile);
-            } else {
-                source = std::move(result.output);
+        if (!preprocessed.success) {
+            preprocessed = runExternalPreprocessor(inputFile, opts, out);
+        }
+
+        for (const auto& warning : preprocessed.warnings) {
+            err << warning << "\n";
+        }
+        result.fileHashes = std::move(preprocessed.fileHashes);
+
+        if (!preprocessed.success) {
+            // Preprocessor failed - fall back to raw IDL
+            if (opts.verbose) {
+                out << "  Preprocessor failed, using raw IDL...\n";
             }
+            source = readFile(inputFile);
+            result.fileHashes = {{inputFile, iborb::cache::hashFileContent(source->data())}};
+        } else {
+            source = iborb::source::SourceBuffer::fromString(std::move(preprocessed.output));
         }
     } else {
         source = readFile(inputFile);
+        result.fileHashes = {{inputFile, iborb::cache::hashFileContent(source->data())}};
+    }
+
+    // Step 2: Parsing, unless an earlier run stored the analyzed unit
+    uint64_t cacheKey = 0;
+    size_t sourceSize = source->data().size();
+    if (unitCache) {
+        cacheKey = unitCache->computeKey(inputFile, source->data());
+        if (auto cached = unitCache->load(cacheKey, source)) {
+            if (opts.verbose) {
+                out << "  Loaded " << cached->unit.definitions.size()
+                    << " top-level definitions from the unit cache.\n";
+            }
+            return opts.parseOnly ||
+                   generateUnit(cached->unit, cached->symbols, inputFile, opts, result);
+        }
     }
 
-    // Step 2: Parsing
     if (opts.verbose) {
-        std::cout << "  Parsing...\n";
+        out << "  Parsing...\n";
     }
 
-    iborb::parser::Parser parser(source, inputFile);
+    iborb::parser::Parser parser(std::move(source), inputFile);
+    parser.setIncludeCache(includeCache);
+    if (opts.stream && !opts.parseOnly && !opts.splitHeaders && !unitCache) {
+        return streamFile(parser, inputFile, opts, result);
+    }
     auto ast = parser.parse();
 
     // Report errors
-    bool hasErrors = false;
-    for (const auto& error : parser.getErrors()) {
-        if (error.isWarning) {
-            std::cerr << error.message << "\n";
-        } else {
-            std::cerr << error.message << "\n";
-            hasErrors = true;
-        }
+    if (reportParseErrors(parser, err)) {
+        err << "Parsing failed with errors.\n";
+        return false;
+    }
+
+    // Step 3: Semantic analysis
+    iborb::semantic::Analyzer analyzer(analysisPool);
+    analyzer.analyze(ast, parser.getImportedSymbols());
+
+    for (const auto& diagnostic : analyzer.getDiagnostics()) {
+        err << diagnostic.message << "\n";
     }
 
-    if (hasErrors) {
-        std::cerr << "Parsing failed with errors.\n";
+    if (analyzer.hasErrors()) {
+        err << "Semantic analysis failed with errors.\n";
         return false;
     }
 
     if (opts.verbose) {
-        std::cout << "  Parsed " << ast.definitions.size() << " top-level definitions.\n";
+        size_t definitions = 0;  // Including those of imported headers
+        ast.forEachDefinition([&](const auto&, const auto&) { ++definitions; });
+        out << "  Parsed " << definitions << " top-level definitions.\n";
     }
 
-    // Step 3: Code Generation
-    if (!opts.parseOnly) {
-        if (opts.verbose) {
-            std::cout << "  Generating C++11 code...\n";
-        }
-
-        iborb::generator::GeneratorConfig genConfig;
-        genConfig.outputDir = opts.outputDir;
-        genConfig.generateImplementation = true;
+    // Units with diagnostics are not stored, so that a later run reports them again
+    if (unitCache && parser.getErrors().empty() && analyzer.getDiagnostics().empty() &&
+        unitCache->store(cacheKey, ast, analyzer.getSymbolTable(), sourceSize) && opts.verbose) {
+        out << "  Stored in the unit cache.\n";
+    }
 
-        iborb::generator::Cpp11Generator generator(genConfig);
-        generator.setSymbolTable(&parser.getSymbolTable());
+    // Step 4: Code Generation
+    return opts.parseOnly ||
+           generateUnit(ast, analyzer.getSymbolTable(), inputFile, opts, result);
+}
 
-        if (!generator.generate(ast)) {
-            for (const auto& err : generator.getErrors()) {
-                std::cerr << "Generator error: " << err << "\n";
+/**
+ * @brief Write a file's generated output and print its messages
+ * @return true if the file was processed successfully
+ */
+bool publishResult(FileResult& result, const Options& opts, std::ostream& out, std::ostream& err) {
+    if (result.success && result.generator) {
+        try {
+            if (!result.generator->writeFiles()) {
+                for (const auto& error : result.generator->getErrors()) {
+                    result.err << "Generator error: " << error << "\n";
+                }
+                result.success = false;
+            } else {
+                result.outputs = result.generator->getOutputFiles();
+                if (opts.verbose && result.generator->getUnchangedFileCount() > 0) {
+                    result.out << "  " << result.generator->getUnchangedFileCount()
+                               << " output file(s) already up to date\n";
+                }
             }
-            return false;
+        } catch (const std::exception& e) {
+            result.err << "Error processing " << result.inputFile << ": " << e.what() << "\n";
+            result.success = false;
         }
+    }
 
-        // Get output filename
-        fs::path inputPath(inputFile);
-        std::string baseName = inputPath.stem().string();
-        fs::path outputPath(opts.outputDir);
+    out << result.out.str();
+    err << result.err.str();
+    return result.success;
+}
 
-        if (opts.verbose) {
-            std::cout << "  Generated: " << (outputPath / (baseName + ".hpp")).string() << "\n";
-        }
+/**
+ * @brief Write a Make rule, leaving an up-to-date file untouched
+ */
+bool writeDepfile(const std::string& path, const std::string& rules, std::ostream& err) {
+    iborb::generator::OutputFile file(path);
+    file.write(rules);
+    if (!file.commit()) {
+        err << "Error: cannot write dependency file " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Write the Make rule of a published file, or add it to rules with -MF
+ *
+ * The targets are the generated files and the dependencies every file
+ * the input was read from, so a build system regenerates exactly the
+ * outputs of the inputs whose includes changed.
+ */
+bool writeDependencies(FileResult& result, const Options& opts, std::string& rules,
+                       std::ostream& err) {
+    if (!opts.writeDepfile || !result.success || result.outputs.empty()) {
+        return true;
+    }
+    std::string rule = iborb::driver::formatMakeRule(result.outputs, result.dependencies);
+    if (!opts.depfilePath.empty()) {
+        rules += rule;
+        return true;
     }
 
+    // The manifest lists the rule of a skipped input among its outputs
+    if (result.upToDate) {
+        return true;
+    }
+    std::string path = fs::path(result.outputs.front()).replace_extension(".d").string();
+    if (!writeDepfile(path, rule, err)) {
+        return false;
+    }
+    result.outputs.push_back(path);
     return true;
 }
 
 /**
- * @brief Main entry point
+ * @brief Settings the outputs depend on besides the files read, for the manifest
  */
-int main(int argc, char* argv[]) {
-    Options opts = parseArguments(argc, argv);
+std::string manifestSettings(const Options& opts, const char* program) {
+    // A rebuilt compiler may generate different code
+    std::error_code ec;
+    fs::path self = fs::read_symlink("/proc/self/exe", ec);
+    if (ec) {
+        self = program;
+    }
+    auto size = fs::file_size(self, ec);
+    auto modified = fs::last_write_time(self, ec).time_since_epoch().count();
+
+    std::string settings = cacheSettings(opts);
+    settings += "\ncompiler " + std::to_string(size) + " " + std::to_string(modified);
+    settings += "\ncwd " + fs::current_path(ec).string();
+    if (opts.writeDepfile && opts.depfilePath.empty()) {
+        settings += "\n-MD";
+    }
+    if (opts.splitHeaders) {
+        settings += "\n--split-headers";
+    }
+    if (opts.externTemplates) {
+        settings += "\n--extern-templates";
+    }
+    if (opts.stream) {
+        settings += "\n--stream";
+    }
+    return settings;
+}
+
+/**
+ * @brief Check whether headers shared between input files are parsed once
+ *
+ * Units that are kept across runs are parsed from textually included
+ * headers instead, because imports refer to headers of this run only.
+ */
+bool usesIncludeCache(const Options& opts) {
+    return opts.usePreprocessor && !opts.externalPreprocessor && opts.includeCache &&
+           opts.cacheDir.empty();
+}
 
+/**
+ * @brief Run one compiler invocation
+ * @param includeCache Headers shared between input files, if usesIncludeCache(opts)
+ * @return The exit code
+ */
+int compile(const Options& opts, const char* program, iborb::parser::IncludeCache* includeCache,
+            std::ostream& out, std::ostream& err) {
     if (opts.help) {
-        printUsage(argv[0]);
+        printUsage(program, out);
         return 0;
     }
 
     if (opts.version) {
-        printVersion();
+        printVersion(out);
         return 0;
     }
 
     if (opts.inputFiles.empty()) {
-        std::cerr << "Error: No input files specified.\n";
-        printUsage(argv[0]);
+        err << "Error: No input files specified.\n";
+        printUsage(program, out);
         return 1;
     }
 
@@ -279,32 +742,197 @@ int main(int argc, char* argv[]) {
         try {
             fs::create_directories(opts.outputDir);
         } catch (const std::exception& e) {
-            std::cerr << "Error creating output directory: " << e.what() << "\n";
+            err << "Error creating output directory: " << e.what() << "\n";
             return 1;
         }
     }
 
-    // Process each input file
+    std::unique_ptr<iborb::cache::UnitCache> unitCache;
+    if (!opts.cacheDir.empty()) {
+        unitCache = std::make_unique<iborb::cache::UnitCache>(opts.cacheDir, cacheSettings(opts));
+    }
+
+    std::unique_ptr<iborb::cache::Manifest> manifest;
+    if (opts.incremental && !opts.parseOnly) {
+        manifest = std::make_unique<iborb::cache::Manifest>(opts.outputDir,
+                                                            manifestSettings(opts, program));
+    }
+
+    // Process the input files in parallel. Each file's output is written
+    // and its messages printed once all earlier files are done, so the
+    // result does not depend on scheduling.
+    size_t count = opts.inputFiles.size();
+    std::vector<std::unique_ptr<FileResult>> results(count);
+    std::mutex publishMutex;
+    size_t nextToPublish = 0;
     int failures = 0;
-    for (const auto& inputFile : opts.inputFiles) {
+    std::string depfileRules;  // Of all inputs, with -MF
+
+    // A single file has its top-level definitions analyzed in parallel instead
+    iborb::driver::WorkerPool pool(opts.jobs);
+    const iborb::driver::WorkerPool* analysisPool = count == 1 ? &pool : nullptr;
+    pool.run(count, [&](size_t index) {
+        auto result = std::make_unique<FileResult>();
+        result->inputFile = opts.inputFiles[index];
         try {
-            if (!processFile(inputFile, opts)) {
+            result->success = processFile(result->inputFile, opts, includeCache, unitCache.get(),
+                                          manifest.get(), analysisPool, *result);
+        } catch (const std::exception& e) {
+            result->err << "Error processing " << result->inputFile << ": " << e.what() << "\n";
+            result->success = false;
+        }
+
+        std::lock_guard<std::mutex> lock(publishMutex);
+        results[index] = std::move(result);
+        for (; nextToPublish < count && results[nextToPublish]; ++nextToPublish) {
+            FileResult& published = *results[nextToPublish];
+            bool succeeded = publishResult(published, opts, out, err) &&
+                             writeDependencies(published, opts, depfileRules, err);
+            if (!succeeded) {
                 ++failures;
             }
-        } catch (const std::exception& e) {
-            std::cerr << "Error processing " << inputFile << ": " << e.what() << "\n";
-            ++failures;
+            if (manifest && !published.upToDate) {
+                if (succeeded) {
+                    manifest->record(published.inputFile, published.dependencies,
+                                     published.fileHashes, published.outputs);
+                } else {
+                    manifest->forget(published.inputFile);
+                }
+            }
+            results[nextToPublish].reset();
         }
+    });
+
+    if (manifest && !manifest->save()) {
+        err << "Warning: cannot write " << iborb::cache::Manifest::kFilename << " in "
+            << opts.outputDir << "\n";
     }
 
     if (failures > 0) {
-        std::cerr << failures << " file(s) failed to process.\n";
+        err << failures << " file(s) failed to process.\n";
+        return 1;
+    }
+
+    if (!opts.depfilePath.empty() && !writeDepfile(opts.depfilePath, depfileRules, err)) {
         return 1;
     }
 
+    if (opts.verbose && manifest) {
+        out << "Manifest: " << manifest->skipped() << " file(s) up to date, skipped.\n";
+    }
+
+    if (opts.verbose && unitCache) {
+        out << "Unit cache: " << unitCache->hits() << " unit(s) loaded, "
+            << unitCache->stores() << " stored.\n";
+    }
+
+    if (opts.verbose && includeCache) {
+        out << "Include cache: " << includeCache->size() << " header(s) parsed, "
+            << includeCache->hits() << " cache hit(s).\n";
+    }
+
     if (opts.verbose) {
-        std::cout << "Successfully processed " << opts.inputFiles.size() << " file(s).\n";
+        out << "Successfully processed " << opts.inputFiles.size() << " file(s).\n";
     }
 
     return 0;
 }
+
+/**
+ * @brief Serve compile requests from clients started with --connect
+ *
+ * Shared headers stay parsed between requests, with one include cache
+ * per working directory and preprocessor settings. Before each request,
+ * the headers whose files changed since they were parsed are dropped.
+ */
+int runServer(const Options& opts, const char* program) {
+    std::unordered_map<std::string, std::unique_ptr<iborb::parser::IncludeCache>> includeCaches;
+
+    try {
+        iborb::driver::CompileServer server(opts.serverSocket);
+        if (opts.verbose) {
+            std::cout << "Listening on " << server.getSocketPath() << "\n" << std::flush;
+        }
+
+        server.run([&](const iborb::driver::CompileRequest& request) {
+            std::ostringstream out;
+            std::ostringstream err;
+            iborb::driver::CompileResponse response;
+
+            std::error_code ec;
+            fs::current_path(request.workingDirectory, ec);
+            if (ec) {
+                response.err = "Error: cannot enter " + request.workingDirectory + ": " +
+                               ec.message() + "\n";
+                return response;
+            }
+
+            Options requestOpts = parseArguments(request.arguments, err);
+            iborb::parser::IncludeCache* includeCache = nullptr;
+            if (usesIncludeCache(requestOpts)) {
+                auto& cache = includeCaches[request.workingDirectory + '\n' + cacheSettings(requestOpts)];
+                if (!cache) {
+                    cache = std::make_unique<iborb::parser::IncludeCache>(
+                        makeBuiltinPreprocessor(requestOpts));
+                } else if (size_t dropped = cache->invalidateChanged();
+                           dropped > 0 && requestOpts.verbose) {
+                    out << "Include cache: " << dropped << " changed header(s) dropped.\n";
+                }
+                includeCache = cache.get();
+            }
+
+            response.exitCode = compile(requestOpts, program, includeCache, out, err);
+            response.out = out.str();
+            response.err = err.str();
+            return response;
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Main entry point
+ */
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::ostringstream argumentErrors;
+    Options opts = parseArguments(args, argumentErrors);
+
+    if (!opts.serverSocket.empty()) {
+        std::cerr << argumentErrors.str();
+        return runServer(opts, argv[0]);
+    }
+
+    // Forward everything but --connect to the server, which reports
+    // argument errors itself
+    if (!opts.connectSocket.empty()) {
+        iborb::driver::CompileRequest request;
+        request.workingDirectory = fs::current_path().string();
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i] == "--connect") {
+                ++i;
+            } else {
+                request.arguments.push_back(args[i]);
+            }
+        }
+
+        if (auto response = iborb::driver::sendRequest(opts.connectSocket, request)) {
+            std::cout << response->out;
+            std::cerr << response->err;
+            return response->exitCode;
+        }
+        if (opts.verbose) {
+            std::cout << "No server on " << opts.connectSocket << ", compiling in this process.\n";
+        }
+    }
+
+    std::cerr << argumentErrors.str();
+    std::unique_ptr<iborb::parser::IncludeCache> includeCache;
+    if (usesIncludeCache(opts)) {
+        includeCache = std::make_unique<iborb::parser::IncludeCache>(makeBuiltinPreprocessor(opts));
+    }
+    return compile(opts, argv[0], includeCache.get(), std::cout, std::cerr);
+}
@@ -0,0 +1,60 @@
+#ifndef IBORB_IDL_DEFINITION_SINK_HPP
+#define IBORB_IDL_DEFINITION_SINK_HPP
+
+#include <memory>
+#include <string>
+#include "ast/ast.hpp"
+
+namespace iborb::source {
+class SourceManager;
+}
+
+namespace iborb::semantic {
+class SymbolTable;
+}
+
+namespace iborb::parser {
+
+/**
+ * @brief Receives a unit from Parser::parse(DefinitionSink&) as it is parsed
+ *
+ * Modules are not delivered as nodes. They are opened and closed around
+ * their definitions, so even a file that is one large module arrives
+ * one definition at a time. Every other definition comes with the arena
+ * that holds it. The receiver owns that arena and may release it as
+ * soon as it is done with the definition.
+ *
+ * The events arrive in source order: beginUnit() first, then imports,
+ * modules and definitions as they appear.
+ */
+class DefinitionSink {
+public:
+    virtual ~DefinitionSink() = default;
+
+    /**
+     * @param filename Name the outputs are derived from
+     * @param sourceManager Resolves the locations of every definition
+     */
+    virtual void beginUnit(const std::string& filename,
+                           std::shared_ptr<const source::SourceManager> sourceManager) = 0;
+
+    /**
+     * @brief A header parsed once and shared through the include cache
+     * @param symbols Symbols declared by the header and its imports
+     */
+    virtual void importUnit(std::shared_ptr<const ast::TranslationUnit> unit,
+                            const semantic::SymbolTable& symbols) = 0;
+
+    virtual void beginModule(ast::Name name, ast::SourceLocation location) = 0;
+    virtual void endModule() = 0;
+
+    /**
+     * @brief A definition other than a module
+     * @param arena Owns the definition and all of its nodes
+     */
+    virtual void definition(ast::Arena arena, ast::DefinitionNode& definition) = 0;
+};
+
+} // namespace iborb::parser
+
+#endif // IBORB_IDL_DEFINITION_SINK_HPP
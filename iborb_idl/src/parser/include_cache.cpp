@@ -0,0 +1,146 @@
+#include "parser/include_cache.hpp"
+#include "parser/parser.hpp"
+#include "semantic/analyzer.hpp"
+#include "source/source_buffer.hpp"
+
+namespace iborb::parser {
+
+IncludeCache::IncludeCache(preprocessor::BuiltinPreprocessor preprocessor)
+    : preprocessor_(std::move(preprocessor)) {
+    preprocessor_.setIncludeHandler(this);
+}
+
+std::optional<preprocessor::HeaderImport> IncludeCache::findHeader(const std::string& path,
+                                                                   const std::string& canonical) {
+    // Locations in the unit are spelled as in its first inclusion, so a
+    // header reached through differently spelled paths is parsed per spelling
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry = &entries_[canonical + '\n' + path];
+        if (entry->built) {
+            if (!entry->id) {
+                return std::nullopt;
+            }
+            ++hits_;
+            return preprocessor::HeaderImport{*entry->id, headers_[*entry->id]->macros};
+        }
+
+        // A header included once is cheaper to read in place than to parse
+        // separately, so only build it once it is included again. One that
+        // is being parsed, by this thread or another, is read in place too.
+        if (++entry->requests < 2 || building_.count(canonical) != 0) {
+            return std::nullopt;
+        }
+        building_.insert(canonical);
+    }
+
+    // The header is stamped before it is read, so that an edit made while
+    // it is being built is seen by the next invalidateChanged()
+    std::vector<FileStamp> files{FileStamp(canonical)};
+    std::vector<std::string> includes;
+    auto header = build(path, includes);
+    if (header) {
+        for (auto& file : includes) {
+            files.emplace_back(std::move(file));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    building_.erase(canonical);
+    entry->built = true;
+    entry->files = std::move(files);
+    if (!header) {
+        return std::nullopt;
+    }
+    entry->id = static_cast<uint32_t>(headers_.size());
+    headers_.push_back(std::move(header));
+    ++size_;
+    return preprocessor::HeaderImport{*entry->id, headers_.back()->macros};
+}
+
+const HeaderUnit* IncludeCache::getHeader(uint32_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return id < headers_.size() ? headers_[id].get() : nullptr;
+}
+
+size_t IncludeCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t IncludeCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+size_t IncludeCache::invalidateChanged() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // A header's files include those of the headers it imports, so the
+    // importers of a changed header are dropped along with it. Ids stay
+    // allocated; the dropped units are released.
+    size_t dropped = 0;
+    for (auto& [key, entry] : entries_) {
+        bool changed = false;
+        for (const auto& file : entry.files) {
+            if (file.changed()) {
+                changed = true;
+                break;
+            }
+        }
+        if (!changed) {
+            continue;
+        }
+        if (entry.id && headers_[*entry.id]) {
+            headers_[*entry.id].reset();
+            ++dropped;
+        }
+        entry = Entry();
+    }
+    size_ -= dropped;
+    return dropped;
+}
+
+IncludeCache::FileStamp::FileStamp(std::string file)
+    : path(std::move(file)) {
+    std::error_code ec;
+    modified = std::filesystem::last_write_time(path, ec);
+    size = std::filesystem::file_size(path, ec);
+}
+
+bool IncludeCache::FileStamp::changed() const {
+    FileStamp now(path);
+    return now.modified != modified || now.size != size;
+}
+
+std::unique_ptr<HeaderUnit> IncludeCache::build(const std::string& path,
+                                                std::vector<std::string>& includes) {
+    auto result = preprocessor_.preprocessFile(path);
+    if (!result.success || !result.warnings.empty() || !result.macroState ||
+        !preprocessor::isShareableHeader(*result.macroState)) {
+        return nullptr;
+    }
+
+    Parser parser(source::SourceBuffer::fromString(std::move(result.output)), path);
+    parser.setIncludeCache(this);
+    auto unit = std::make_shared<ast::TranslationUnit>(parser.parse());
+    if (!parser.getErrors().empty()) {
+        return nullptr;
+    }
+
+    semantic::Analyzer analyzer;
+    if (!analyzer.analyze(*unit, parser.getImportedSymbols()) ||
+        !analyzer.getDiagnostics().empty()) {
+        return nullptr;
+    }
+
+    auto header = std::make_unique<HeaderUnit>();
+    header->unit = std::move(unit);
+    header->symbols = std::move(analyzer.getSymbolTable());
+    includes = preprocessor::includedFiles(*result.macroState);
+    header->macros = std::move(result.macroState);
+    return header;
+}
+
+} // namespace iborb::parser
@@ -0,0 +1,118 @@
+#ifndef IBORB_IDL_INCLUDE_CACHE_HPP
+#define IBORB_IDL_INCLUDE_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ast/ast.hpp"
+#include "preprocessor/builtin_preprocessor.hpp"
+#include "semantic/symbol_table.hpp"
+
+namespace iborb::parser {
+
+/**
+ * @brief A header parsed once and shared by every file that includes it
+ */
+struct HeaderUnit {
+    std::shared_ptr<const ast::TranslationUnit> unit;
+    semantic::SymbolTable symbols;  // Symbols declared by the header and its imports
+    std::shared_ptr<const preprocessor::MacroState> macros;
+};
+
+/**
+ * @brief Parses guarded headers once per compiler invocation
+ *
+ * The second time a header is included, it is preprocessed and parsed
+ * on its own with the same include paths and defines as the including
+ * file. That and later includes that the preprocessor can prove equivalent are
+ * replaced by an import of the parsed unit, so common headers are
+ * lexed and parsed once no matter how many inputs include them.
+ *
+ * Headers that are not include-once, that end inside a definition, or
+ * that produce diagnostics are never cached; they are included
+ * textually so their diagnostics are reported in context.
+ *
+ * The cache is shared by all worker threads. A header is built by the
+ * first thread that needs it; other threads include it textually in
+ * the meantime rather than wait, which gives the same output.
+ *
+ * A cache that outlives one compilation (see the --server option) is
+ * brought up to date with invalidateChanged() before each one.
+ */
+class IncludeCache : public preprocessor::IncludeHandler {
+public:
+    /**
+     * @brief Create a cache that builds headers with the given settings
+     * @param preprocessor Preprocessor configured like the one for the inputs
+     */
+    explicit IncludeCache(preprocessor::BuiltinPreprocessor preprocessor);
+
+    std::optional<preprocessor::HeaderImport> findHeader(const std::string& path,
+                                                         const std::string& canonical) override;
+
+    /**
+     * @brief Get a header by the id carried in its import pragma
+     * @return The header, or nullptr for an unknown id
+     */
+    const HeaderUnit* getHeader(uint32_t id) const;
+
+    /**
+     * @brief Number of includes answered from the cache
+     */
+    size_t hits() const;
+
+    /**
+     * @brief Number of headers parsed into the cache
+     */
+    size_t size() const;
+
+    /**
+     * @brief Forget the headers whose files changed since they were built
+     * @return Number of headers dropped
+     *
+     * A header is rebuilt the next time it is included twice. Must not be
+     * called while files are being parsed with the cache.
+     */
+    size_t invalidateChanged();
+
+private:
+    /**
+     * @brief Modification time and size of a file a header was built from
+     */
+    struct FileStamp {
+        std::string path;
+        std::filesystem::file_time_type modified;
+        uintmax_t size = 0;
+
+        explicit FileStamp(std::string file);
+        bool changed() const;
+    };
+
+    struct Entry {
+        unsigned requests = 0;
+        bool built = false;
+        std::optional<uint32_t> id;  // Empty if the header cannot be shared
+        std::vector<FileStamp> files;  // The header and, if shared, all it includes
+    };
+
+    preprocessor::BuiltinPreprocessor preprocessor_;
+    mutable std::mutex mutex_;  // Guards everything below
+    std::vector<std::unique_ptr<HeaderUnit>> headers_;
+    std::unordered_map<std::string, Entry> entries_;  // Canonical path and spelling -> entry
+    std::unordered_set<std::string> building_;  // Headers being parsed, to break cycles
+    size_t hits_ = 0;
+    size_t size_ = 0;  // Headers not invalidated
+
+    std::unique_ptr<HeaderUnit> build(const std::string& path,
+                                      std::vector<std::string>& includes);
+};
+
+} // namespace iborb::parser
+
+#endif // IBORB_IDL_INCLUDE_CACHE_HPP
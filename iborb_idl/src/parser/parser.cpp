@@ -1,22 +1,32 @@
 #include "parser/parser.hpp"
+#include "parser/include_cache.hpp"
 #include <stdexcept>
 #include <sstream>
+#include <cstdlib>
 
 namespace iborb::parser {
 
 using namespace ast;
 using namespace lexer;
-using namespace semantic;
 
-Parser::Parser(const std::string& source, const std::string& filename)
-    : lexer_(source, filename) {
+Parser::Parser(std::string source, const std::string& filename)
+    : lexer_(std::move(source), filename) {
+    advance(); // Prime the first token
+}
+
+Parser::Parser(std::unique_ptr<source::SourceBuffer> buffer, const std::string& filename)
+    : lexer_(std::move(buffer), filename) {
     advance(); // Prime the first token
 }
 
 TranslationUnit Parser::parse() {
     TranslationUnit unit;
-    unit.filename = currentToken_.location.filename;
+    arena_ = &unit.arena;
+    // Buffer 1 is the input; the first token may come from a file it includes
+    unit.filename = std::string(lexer_.getSourceManager()->getFilename(SourceLocation{1, 0}));
+    unit.sourceManager = lexer_.getSourceManager();
 
+    std::vector<DefinitionNode*> definitions;
     while (!check(TokenType::Eof)) {
         // Skip any line directives at top level
         if (check(TokenType::LineDirective)) {
@@ -24,17 +34,117 @@ TranslationUnit Parser::parse() {
             continue;
         }
 
+        if (check(TokenType::Pragma) &&
+            parseImport(unit.imports, definitions.size())) {
+            continue;
+        }
+
         if (auto def = parseDefinition()) {
-            unit.definitions.push_back(std::move(def));
+            definitions.push_back(def);
         } else {
             // Error recovery - skip to next definition
             synchronize();
         }
     }
 
+    unit.definitions = unit.arena.copyArray(definitions);
+    arena_ = nullptr;
+    integerLiterals_.clear();
     return unit;
 }
 
+void Parser::parse(DefinitionSink& sink) {
+    sink.beginUnit(std::string(lexer_.getSourceManager()->getFilename(SourceLocation{1, 0})),
+                   lexer_.getSourceManager());
+    std::vector<ImportedUnit> imports;
+    size_t definitions = 0;  // Top-level definitions parsed so far
+
+    while (!check(TokenType::Eof)) {
+        if (check(TokenType::LineDirective)) {
+            advance();
+            continue;
+        }
+
+        size_t known = imports.size();
+        if (check(TokenType::Pragma) && parseImport(imports, definitions)) {
+            if (imports.size() > known) {
+                sink.importUnit(imports.back().unit, *importedSymbols_.back());
+            }
+            continue;
+        }
+
+        streamDefinition(sink);
+        ++definitions;
+    }
+}
+
+void Parser::streamDefinition(DefinitionSink& sink) {
+    if (check(TokenType::KwModule)) {
+        streamModule(sink);
+        return;
+    }
+
+    Arena arena;
+    arena_ = &arena;
+    auto def = parseDefinition();
+    arena_ = nullptr;
+    integerLiterals_.clear();
+
+    if (def) {
+        sink.definition(std::move(arena), *def);
+    } else {
+        // Error recovery - skip to next definition
+        synchronize();
+    }
+}
+
+void Parser::streamModule(DefinitionSink& sink) {
+    auto loc = currentToken_.location;
+    expect(TokenType::KwModule, "Expected 'module'");
+
+    if (!check(TokenType::Identifier)) {
+        error("Expected module name");
+        synchronize();
+        return;
+    }
+    Name name = Name::intern(currentToken_.text);
+    advance();
+
+    expect(TokenType::LeftBrace, "Expected '{' after module name");
+
+    sink.beginModule(name, loc);
+    while (!check(TokenType::RightBrace) && !check(TokenType::Eof)) {
+        streamDefinition(sink);
+    }
+    sink.endModule();
+
+    expect(TokenType::RightBrace, "Expected '}' at end of module");
+    expectSemicolon();
+}
+
+bool Parser::parseImport(std::vector<ImportedUnit>& imports, size_t position) {
+    std::string_view text = currentToken_.text;
+    if (!includeCache_ || text.substr(0, preprocessor::kImportPragma.size()) !=
+                              preprocessor::kImportPragma) {
+        return false;
+    }
+
+    uint32_t id = static_cast<uint32_t>(
+        std::strtoul(std::string(text.substr(preprocessor::kImportPragma.size())).c_str(),
+                     nullptr, 10));
+    const HeaderUnit* header = includeCache_->getHeader(id);
+    if (!header) {
+        error("Unknown imported header");
+        advance();
+        return true;
+    }
+
+    importedSymbols_.push_back(&header->symbols);
+    imports.push_back({header->unit, position});
+    advance();
+    return true;
+}
+
 std::vector<ParserError> Parser::getWarnings() const {
     std::vector<ParserError> warnings;
     for (const auto& err : errors_) {
@@ -59,8 +169,8 @@ bool Parser::hasErrors() const {
 // ============================================================================
 
 void Parser::advance() {
-    previousToken_ = currentToken_;
-    
+    previousToken_ = std::move(currentToken_);
+
     while (true) {
         currentToken_ = lexer_.nextToken();
         
@@ -127,7 +237,7 @@ void Parser::errorAt(const Token& token, const std::string& message) {
     hadError_ = true;
 
     std::ostringstream oss;
-    oss << token.location.toString() << ": error: " << message;
+    oss << lexer_.getSourceManager()->format(token.location) << ": error: " << message;
     if (token.type == TokenType::Eof) {
         oss << " at end of file";
     } else if (token.type != TokenType::Unknown) {
@@ -139,7 +249,7 @@ void Parser::errorAt(const Token& token, const std::string& message) {
 
 void Parser::warning(const std::string& message) {
     std::ostringstream oss;
-    oss << currentToken_.location.toString() << ": warning: " << message;
+    oss << lexer_.getSourceManager()->format(currentToken_.location) << ": warning: " << message;
     errors_.push_back({oss.str(), currentToken_.location, true});
 }
 
@@ -190,8 +300,6 @@ bool Parser::isDefinitionStart() const {
 // ============================================================================
 
 ASTPtr<DefinitionNode> Parser::parseDefinition() {
-    auto loc = currentToken_.location;
-
     // Handle modifiers
     bool isAbstract = match(TokenType::KwAbstract);
     bool isLocal = match(TokenType::KwLocal);
@@ -236,30 +344,26 @@ ASTPtr<ModuleNode> Parser::parseModule() {
         error("Expected module name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
-    // Register module in symbol table
-    symbolTable_.addSymbol(name, SymbolKind::Module);
-    symbolTable_.enterScope(name);
-
-    auto node = std::make_unique<ModuleNode>(name, loc);
-    node->fullyQualifiedName = symbolTable_.getCurrentScopeName();
+    auto node = arena_->create<ModuleNode>(name, loc);
 
     expect(TokenType::LeftBrace, "Expected '{' after module name");
 
+    std::vector<DefinitionNode*> definitions;
     while (!check(TokenType::RightBrace) && !check(TokenType::Eof)) {
         if (auto def = parseDefinition()) {
-            node->definitions.push_back(std::move(def));
+            definitions.push_back(def);
         } else {
             synchronize();
         }
     }
+    node->definitions = arena_->copyArray(definitions);
 
     expect(TokenType::RightBrace, "Expected '}' at end of module");
     expectSemicolon();
 
-    symbolTable_.leaveScope();
     return node;
 }
 
@@ -271,10 +375,10 @@ ASTPtr<InterfaceNode> Parser::parseInterface(bool isAbstract, bool isLocal) {
         error("Expected interface name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
-    auto node = std::make_unique<InterfaceNode>(name, loc);
+    auto node = arena_->create<InterfaceNode>(name, loc);
     node->isAbstract = isAbstract;
     node->isLocal = isLocal;
 
@@ -282,8 +386,6 @@ ASTPtr<InterfaceNode> Parser::parseInterface(bool isAbstract, bool isLocal) {
     if (check(TokenType::Semicolon)) {
         advance();
         node->isForward = true;
-        symbolTable_.addSymbol(name, SymbolKind::Interface, node.get());
-        node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
         return node;
     }
 
@@ -292,14 +394,10 @@ ASTPtr<InterfaceNode> Parser::parseInterface(bool isAbstract, bool isLocal) {
         node->baseInterfaces = parseInheritanceSpec();
     }
 
-    // Register in symbol table and enter scope
-    symbolTable_.addSymbol(name, SymbolKind::Interface, node.get());
-    node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
-    symbolTable_.enterScope(name);
-
     expect(TokenType::LeftBrace, "Expected '{' after interface name");
 
     // Parse interface body
+    std::vector<DefinitionNode*> contents;
     while (!check(TokenType::RightBrace) && !check(TokenType::Eof)) {
         // Parse interface member
         bool readonly = match(TokenType::KwReadonly);
@@ -311,7 +409,7 @@ ASTPtr<InterfaceNode> Parser::parseInterface(bool isAbstract, bool isLocal) {
             }
             auto attr = parseAttribute(readonly);
             if (attr) {
-                node->contents.push_back(std::move(attr));
+                contents.push_back(attr);
             }
         } else if (isDefinitionStart()) {
             // Nested type definition
@@ -319,7 +417,7 @@ ASTPtr<InterfaceNode> Parser::parseInterface(bool isAbstract, bool isLocal) {
                 error("'readonly' and 'oneway' can only be applied to attributes and operations");
             }
             if (auto def = parseDefinition()) {
-                node->contents.push_back(std::move(def));
+                contents.push_back(def);
             }
         } else {
             // Operation
@@ -337,20 +435,20 @@ ASTPtr<InterfaceNode> Parser::parseInterface(bool isAbstract, bool isLocal) {
                 synchronize();
                 continue;
             }
-            std::string opName = currentToken_.text;
+            Name opName = Name::intern(currentToken_.text);
             advance();
 
             auto op = parseOperation(std::move(retType), opName, oneway);
             if (op) {
-                node->contents.push_back(std::move(op));
+                contents.push_back(op);
             }
         }
     }
+    node->contents = arena_->copyArray(contents);
 
     expect(TokenType::RightBrace, "Expected '}' at end of interface");
     expectSemicolon();
 
-    symbolTable_.leaveScope();
     return node;
 }
 
@@ -362,38 +460,32 @@ ASTPtr<StructNode> Parser::parseStruct() {
         error("Expected struct name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
     // Check for forward declaration
     if (check(TokenType::Semicolon)) {
         advance();
-        auto node = std::make_unique<StructNode>(name, loc);
-        symbolTable_.addSymbol(name, SymbolKind::Struct, node.get());
-        node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
-        return node;
+        return arena_->create<StructNode>(name, loc);
     }
 
-    symbolTable_.addSymbol(name, SymbolKind::Struct);
-    symbolTable_.enterScope(name);
-
-    auto node = std::make_unique<StructNode>(name, loc);
-    node->fullyQualifiedName = symbolTable_.getCurrentScopeName();
+    auto node = arena_->create<StructNode>(name, loc);
 
     expect(TokenType::LeftBrace, "Expected '{' after struct name");
 
+    std::vector<StructMemberNode*> members;
     while (!check(TokenType::RightBrace) && !check(TokenType::Eof)) {
         if (auto member = parseStructMember()) {
-            node->members.push_back(std::move(member));
+            members.push_back(member);
         } else {
             synchronize();
         }
     }
+    node->members = arena_->copyArray(members);
 
     expect(TokenType::RightBrace, "Expected '}' at end of struct");
     expectSemicolon();
 
-    symbolTable_.leaveScope();
     return node;
 }
 
@@ -405,7 +497,7 @@ ASTPtr<UnionNode> Parser::parseUnion() {
         error("Expected union name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
     expect(TokenType::KwSwitch, "Expected 'switch' after union name");
@@ -419,26 +511,23 @@ ASTPtr<UnionNode> Parser::parseUnion() {
 
     expect(TokenType::RightParen, "Expected ')' after discriminator type");
 
-    symbolTable_.addSymbol(name, SymbolKind::Union);
-    symbolTable_.enterScope(name);
-
-    auto node = std::make_unique<UnionNode>(name, std::move(discType), loc);
-    node->fullyQualifiedName = symbolTable_.getCurrentScopeName();
+    auto node = arena_->create<UnionNode>(name, std::move(discType), loc);
 
     expect(TokenType::LeftBrace, "Expected '{' after union switch");
 
+    std::vector<UnionCaseNode*> cases;
     while (!check(TokenType::RightBrace) && !check(TokenType::Eof)) {
         if (auto caseNode = parseUnionCase()) {
-            node->cases.push_back(std::move(caseNode));
+            cases.push_back(caseNode);
         } else {
             synchronize();
         }
     }
+    node->cases = arena_->copyArray(cases);
 
     expect(TokenType::RightBrace, "Expected '}' at end of union");
     expectSemicolon();
 
-    symbolTable_.leaveScope();
     return node;
 }
 
@@ -450,34 +539,25 @@ ASTPtr<EnumNode> Parser::parseEnum() {
         error("Expected enum name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
     expect(TokenType::LeftBrace, "Expected '{' after enum name");
 
-    std::vector<std::string> values;
+    std::vector<Name> values;
     do {
         if (!check(TokenType::Identifier)) {
             error("Expected enumerator name");
             break;
         }
-        values.push_back(currentToken_.text);
+        values.push_back(Name::intern(currentToken_.text));
         advance();
     } while (match(TokenType::Comma));
 
     expect(TokenType::RightBrace, "Expected '}' at end of enum");
     expectSemicolon();
 
-    auto node = std::make_unique<EnumNode>(name, std::move(values), loc);
-    symbolTable_.addSymbol(name, SymbolKind::Enum, node.get());
-    node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
-
-    // Register enum values
-    for (const auto& val : node->enumerators) {
-        symbolTable_.addSymbol(val, SymbolKind::EnumValue);
-    }
-
-    return node;
+    return arena_->create<EnumNode>(name, std::move(values), loc);
 }
 
 ASTPtr<TypedefNode> Parser::parseTypedef() {
@@ -502,14 +582,11 @@ ASTPtr<TypedefNode> Parser::parseTypedef() {
     for (const auto& decl : declarators) {
         ast::TypedefDeclarator astDecl;
         astDecl.name = decl.name;
-        astDecl.arrayDimensions = decl.arrayDimensions;
+        astDecl.dimensionExprs = arena_->copyArray(decl.dimensions);
         astDeclarators.push_back(std::move(astDecl));
-        symbolTable_.addSymbol(decl.name, SymbolKind::Typedef);
     }
 
-    auto node = std::make_unique<TypedefNode>(std::move(type), std::move(astDeclarators), loc);
-    node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(node->name);
-    return node;
+    return arena_->create<TypedefNode>(std::move(type), std::move(astDeclarators), loc);
 }
 
 ASTPtr<ConstNode> Parser::parseConst() {
@@ -526,7 +603,7 @@ ASTPtr<ConstNode> Parser::parseConst() {
         error("Expected const name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
     expect(TokenType::Equals, "Expected '=' after const name");
@@ -535,10 +612,7 @@ ASTPtr<ConstNode> Parser::parseConst() {
 
     expectSemicolon();
 
-    auto node = std::make_unique<ConstNode>(name, std::move(type), std::move(value), loc);
-    symbolTable_.addSymbol(name, SymbolKind::Constant, node.get());
-    node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
-    return node;
+    return arena_->create<ConstNode>(name, std::move(type), value, loc);
 }
 
 ASTPtr<ExceptionNode> Parser::parseException() {
@@ -549,29 +623,26 @@ ASTPtr<ExceptionNode> Parser::parseException() {
         error("Expected exception name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
-    symbolTable_.addSymbol(name, SymbolKind::Exception);
-    symbolTable_.enterScope(name);
-
-    auto node = std::make_unique<ExceptionNode>(name, loc);
-    node->fullyQualifiedName = symbolTable_.getCurrentScopeName();
+    auto node = arena_->create<ExceptionNode>(name, loc);
 
     expect(TokenType::LeftBrace, "Expected '{' after exception name");
 
+    std::vector<StructMemberNode*> members;
     while (!check(TokenType::RightBrace) && !check(TokenType::Eof)) {
         if (auto member = parseStructMember()) {
-            node->members.push_back(std::move(member));
+            members.push_back(member);
         } else {
             synchronize();
         }
     }
+    node->members = arena_->copyArray(members);
 
     expect(TokenType::RightBrace, "Expected '}' at end of exception");
     expectSemicolon();
 
-    symbolTable_.leaveScope();
     return node;
 }
 
@@ -580,23 +651,24 @@ ASTPtr<ExceptionNode> Parser::parseException() {
 // ============================================================================
 
 ASTPtr<OperationNode> Parser::parseOperation(ASTPtr<TypeNode> returnType,
-                                              const std::string& name,
+                                              Name name,
                                               bool isOneway) {
     auto loc = previousToken_.location;
 
-    auto node = std::make_unique<OperationNode>(name, std::move(returnType), loc);
+    auto node = arena_->create<OperationNode>(name, std::move(returnType), loc);
     node->isOneway = isOneway;
-    node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
 
     expect(TokenType::LeftParen, "Expected '(' after operation name");
 
     // Parse parameters
     if (!check(TokenType::RightParen)) {
+        std::vector<ParameterNode*> parameters;
         do {
             if (auto param = parseParameter()) {
-                node->parameters.push_back(std::move(param));
+                parameters.push_back(param);
             }
         } while (match(TokenType::Comma));
+        node->parameters = arena_->copyArray(parameters);
     }
 
     expect(TokenType::RightParen, "Expected ')' after parameters");
@@ -608,7 +680,6 @@ ASTPtr<OperationNode> Parser::parseOperation(ASTPtr<TypeNode> returnType,
 
     expectSemicolon();
 
-    symbolTable_.addSymbol(name, SymbolKind::Operation, node.get());
     return node;
 }
 
@@ -626,15 +697,12 @@ ASTPtr<AttributeNode> Parser::parseAttribute(bool isReadonly) {
         error("Expected attribute name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
     expectSemicolon();
 
-    auto node = std::make_unique<AttributeNode>(name, std::move(type), isReadonly, loc);
-    symbolTable_.addSymbol(name, SymbolKind::Attribute, node.get());
-    node->fullyQualifiedName = symbolTable_.buildFullyQualifiedName(name);
-    return node;
+    return arena_->create<AttributeNode>(name, std::move(type), isReadonly, loc);
 }
 
 ASTPtr<ParameterNode> Parser::parseParameter() {
@@ -652,10 +720,10 @@ ASTPtr<ParameterNode> Parser::parseParameter() {
         error("Expected parameter name");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
-    return std::make_unique<ParameterNode>(direction, std::move(type), name, loc);
+    return arena_->create<ParameterNode>(direction, std::move(type), name, loc);
 }
 
 ASTPtr<StructMemberNode> Parser::parseStructMember() {
@@ -680,14 +748,14 @@ ASTPtr<StructMemberNode> Parser::parseStructMember() {
 
     // Handle array dimensions
     ASTPtr<TypeNode> memberType;
-    if (!decl.arrayDimensions.empty()) {
-        memberType = std::make_unique<ArrayTypeNode>(
-            std::move(type), decl.arrayDimensions, loc);
+    if (!decl.dimensions.empty()) {
+        memberType = arena_->create<ArrayTypeNode>(
+            std::move(type), arena_->copyArray(decl.dimensions), loc);
     } else {
         memberType = std::move(type);
     }
 
-    return std::make_unique<StructMemberNode>(std::move(memberType), decl.name, loc);
+    return arena_->create<StructMemberNode>(std::move(memberType), decl.name, loc);
 }
 
 ASTPtr<UnionCaseNode> Parser::parseUnionCase() {
@@ -702,7 +770,7 @@ ASTPtr<UnionCaseNode> Parser::parseUnionCase() {
             expect(TokenType::Colon, "Expected ':' after 'default'");
         } else {
             advance(); // consume 'case'
-            label.value = parseConstExpr();
+            label.expr = parseConstExpr();
             expect(TokenType::Colon, "Expected ':' after case value");
         }
         labels.push_back(label);
@@ -723,12 +791,12 @@ ASTPtr<UnionCaseNode> Parser::parseUnionCase() {
         error("Expected member name in union case");
         return nullptr;
     }
-    std::string name = currentToken_.text;
+    Name name = Name::intern(currentToken_.text);
     advance();
 
     expectSemicolon();
 
-    return std::make_unique<UnionCaseNode>(std::move(labels), std::move(type), name, loc);
+    return arena_->create<UnionCaseNode>(std::move(labels), std::move(type), name, loc);
 }
 
 // ============================================================================
@@ -766,7 +834,7 @@ ASTPtr<TypeNode> Parser::parseSimpleTypeSpec() {
 ASTPtr<TypeNode> Parser::parseBaseTypeSpec() {
     auto loc = currentToken_.location;
     auto basicType = parseBasicType();
-    return std::make_unique<BasicTypeNode>(basicType, loc);
+    return arena_->create<BasicTypeNode>(basicType, loc);
 }
 
 ASTPtr<SequenceTypeNode> Parser::parseSequenceType() {
@@ -780,42 +848,36 @@ ASTPtr<SequenceTypeNode> Parser::parseSequenceType() {
         return nullptr;
     }
 
-    std::optional<size_t> bound;
+    ASTPtr<ConstExpr> boundExpr = nullptr;
     if (match(TokenType::Comma)) {
-        auto boundExpr = parseConstExpr();
-        if (auto* val = std::get_if<int64_t>(&boundExpr)) {
-            bound = static_cast<size_t>(*val);
-        } else if (auto* uval = std::get_if<uint64_t>(&boundExpr)) {
-            bound = static_cast<size_t>(*uval);
-        }
+        boundExpr = parseConstExpr();
     }
 
     expect(TokenType::RightAngle, "Expected '>' at end of sequence type");
 
-    return std::make_unique<SequenceTypeNode>(std::move(elemType), bound, loc);
+    auto node = arena_->create<SequenceTypeNode>(std::move(elemType), std::nullopt, loc);
+    node->boundExpr = boundExpr;
+    return node;
 }
 
 ASTPtr<StringTypeNode> Parser::parseStringType(bool isWide) {
     auto loc = currentToken_.location;
     advance(); // consume 'string' or 'wstring'
 
-    std::optional<size_t> bound;
+    ASTPtr<ConstExpr> boundExpr = nullptr;
     if (match(TokenType::LeftAngle)) {
-        auto boundExpr = parseConstExpr();
-        if (auto* val = std::get_if<int64_t>(&boundExpr)) {
-            bound = static_cast<size_t>(*val);
-        } else if (auto* uval = std::get_if<uint64_t>(&boundExpr)) {
-            bound = static_cast<size_t>(*uval);
-        }
+        boundExpr = parseConstExpr();
         expect(TokenType::RightAngle, "Expected '>' at end of string bound");
     }
 
-    return std::make_unique<StringTypeNode>(bound, isWide, loc);
+    auto node = arena_->create<StringTypeNode>(std::nullopt, isWide, loc);
+    node->boundExpr = boundExpr;
+    return node;
 }
 
 ASTPtr<TypeNode> Parser::parseScopedName() {
     auto loc = currentToken_.location;
-    std::vector<std::string> parts;
+    std::vector<Name> parts;
     bool isAbsolute = match(TokenType::DoubleColon);
 
     if (!check(TokenType::Identifier)) {
@@ -828,11 +890,11 @@ ASTPtr<TypeNode> Parser::parseScopedName() {
             error("Expected identifier after '::'");
             break;
         }
-        parts.push_back(currentToken_.text);
+        parts.push_back(Name::intern(currentToken_.text));
         advance();
     } while (match(TokenType::DoubleColon));
 
-    return std::make_unique<ScopedNameNode>(std::move(parts), isAbsolute, loc);
+    return arena_->create<ScopedNameNode>(std::move(parts), isAbsolute, loc);
 }
 
 // ============================================================================
@@ -846,19 +908,12 @@ Parser::Declarator Parser::parseDeclarator() {
         error("Expected identifier");
         return decl;
     }
-    decl.name = currentToken_.text;
+    decl.name = Name::intern(currentToken_.text);
     advance();
 
     // Parse array dimensions
     while (match(TokenType::LeftBracket)) {
-        auto sizeExpr = parseConstExpr();
-        size_t size = 0;
-        if (auto* val = std::get_if<int64_t>(&sizeExpr)) {
-            size = static_cast<size_t>(*val);
-        } else if (auto* uval = std::get_if<uint64_t>(&sizeExpr)) {
-            size = static_cast<size_t>(*uval);
-        }
-        decl.arrayDimensions.push_back(size);
+        decl.dimensions.push_back(parseConstExpr());
         expect(TokenType::RightBracket, "Expected ']'");
     }
 
@@ -881,74 +936,48 @@ std::vector<Parser::Declarator> Parser::parseDeclarators() {
 // Expression Parsing (for constants)
 // ============================================================================
 
-ConstValue Parser::parseConstExpr() {
+ASTPtr<ConstExpr> Parser::parseConstExpr() {
     return parseOrExpr();
 }
 
-ConstValue Parser::parseOrExpr() {
+ASTPtr<ConstExpr> Parser::parseOrExpr() {
     auto left = parseXorExpr();
 
     while (match(TokenType::Pipe)) {
-        auto right = parseXorExpr();
-        // Compute result
-        if (auto* l = std::get_if<int64_t>(&left)) {
-            if (auto* r = std::get_if<int64_t>(&right)) {
-                left = *l | *r;
-            }
-        }
+        left = makeBinary(ConstExpr::Op::Or, left, parseXorExpr());
     }
 
     return left;
 }
 
-ConstValue Parser::parseXorExpr() {
+ASTPtr<ConstExpr> Parser::parseXorExpr() {
     auto left = parseAndExpr();
 
     while (match(TokenType::Caret)) {
-        auto right = parseAndExpr();
-        if (auto* l = std::get_if<int64_t>(&left)) {
-            if (auto* r = std::get_if<int64_t>(&right)) {
-                left = *l ^ *r;
-            }
-        }
+        left = makeBinary(ConstExpr::Op::Xor, left, parseAndExpr());
     }
 
     return left;
 }
 
-ConstValue Parser::parseAndExpr() {
+ASTPtr<ConstExpr> Parser::parseAndExpr() {
     auto left = parseShiftExpr();
 
     while (match(TokenType::Ampersand)) {
-        auto right = parseShiftExpr();
-        if (auto* l = std::get_if<int64_t>(&left)) {
-            if (auto* r = std::get_if<int64_t>(&right)) {
-                left = *l & *r;
-            }
-        }
+        left = makeBinary(ConstExpr::Op::And, left, parseShiftExpr());
     }
 
     return left;
 }
 
-ConstValue Parser::parseShiftExpr() {
+ASTPtr<ConstExpr> Parser::parseShiftExpr() {
     auto left = parseAddExpr();
 
     while (true) {
         if (match(TokenType::LeftShift)) {
-            auto right = parseAddExpr();
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    left = *l << *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::ShiftLeft, left, parseAddExpr());
         } else if (match(TokenType::RightShift)) {
-            auto right = parseAddExpr();
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    left = *l >> *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::ShiftRight, left, parseAddExpr());
         } else {
             break;
         }
@@ -957,33 +986,14 @@ ConstValue Parser::parseShiftExpr() {
     return left;
 }
 
-ConstValue Parser::parseAddExpr() {
+ASTPtr<ConstExpr> Parser::parseAddExpr() {
     auto left = parseMulExpr();
 
     while (true) {
         if (match(TokenType::Plus)) {
-            auto right = parseMulExpr();
-            // Handle different types
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    left = *l + *r;
-                }
-            } else if (auto* l = std::get_if<double>(&left)) {
-                if (auto* r = std::get_if<double>(&right)) {
-                    left = *l + *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::Add, left, parseMulExpr());
         } else if (match(TokenType::Minus)) {
-            auto right = parseMulExpr();
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    left = *l - *r;
-                }
-            } else if (auto* l = std::get_if<double>(&left)) {
-                if (auto* r = std::get_if<double>(&right)) {
-                    left = *l - *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::Subtract, left, parseMulExpr());
         } else {
             break;
         }
@@ -992,39 +1002,16 @@ ConstValue Parser::parseAddExpr() {
     return left;
 }
 
-ConstValue Parser::parseMulExpr() {
+ASTPtr<ConstExpr> Parser::parseMulExpr() {
     auto left = parseUnaryExpr();
 
     while (true) {
         if (match(TokenType::Star)) {
-            auto right = parseUnaryExpr();
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    left = *l * *r;
-                }
-            } else if (auto* l = std::get_if<double>(&left)) {
-                if (auto* r = std::get_if<double>(&right)) {
-                    left = *l * *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::Multiply, left, parseUnaryExpr());
         } else if (match(TokenType::Slash)) {
-            auto right = parseUnaryExpr();
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    if (*r != 0) left = *l / *r;
-                }
-            } else if (auto* l = std::get_if<double>(&left)) {
-                if (auto* r = std::get_if<double>(&right)) {
-                    left = *l / *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::Divide, left, parseUnaryExpr());
         } else if (match(TokenType::Percent)) {
-            auto right = parseUnaryExpr();
-            if (auto* l = std::get_if<int64_t>(&left)) {
-                if (auto* r = std::get_if<int64_t>(&right)) {
-                    if (*r != 0) left = *l % *r;
-                }
-            }
+            left = makeBinary(ConstExpr::Op::Modulo, left, parseUnaryExpr());
         } else {
             break;
         }
@@ -1033,96 +1020,108 @@ ConstValue Parser::parseMulExpr() {
     return left;
 }
 
-ConstValue Parser::parseUnaryExpr() {
+ASTPtr<ConstExpr> Parser::parseUnaryExpr() {
+    auto loc = currentToken_.location;
     if (match(TokenType::Minus)) {
-        auto val = parseUnaryExpr();
-        if (auto* v = std::get_if<int64_t>(&val)) {
-            return -(*v);
-        } else if (auto* v = std::get_if<double>(&val)) {
-            return -(*v);
-        }
-        return val;
+        return makeUnary(ConstExpr::Op::Negate, parseUnaryExpr(), loc);
     }
     if (match(TokenType::Plus)) {
         return parseUnaryExpr();
     }
     if (match(TokenType::Tilde)) {
-        auto val = parseUnaryExpr();
-        if (auto* v = std::get_if<int64_t>(&val)) {
-            return ~(*v);
-        }
-        return val;
+        return makeUnary(ConstExpr::Op::Complement, parseUnaryExpr(), loc);
     }
 
     return parsePrimaryExpr();
 }
 
-ConstValue Parser::parsePrimaryExpr() {
+ASTPtr<ConstExpr> Parser::parsePrimaryExpr() {
     // Parenthesized expression
     if (match(TokenType::LeftParen)) {
-        auto val = parseConstExpr();
+        auto expr = parseConstExpr();
         expect(TokenType::RightParen, "Expected ')'");
-        return val;
+        return expr;
     }
 
-    // Literals
+    // Literals. Integer literals, mostly bounds and array sizes, never
+    // need a location, so equal ones share a node.
     if (check(TokenType::IntegerLiteral)) {
-        auto val = std::get<int64_t>(currentToken_.value);
+        auto value = std::get<int64_t>(currentToken_.value);
         advance();
-        return val;
+        auto& shared = integerLiterals_[value];
+        if (!shared) {
+            shared = arena_->create<ConstExpr>();
+            shared->literal = value;
+        }
+        return shared;
     }
+
+    auto expr = arena_->create<ConstExpr>();
+    expr->location = currentToken_.location;
+
     if (check(TokenType::FloatLiteral)) {
-        auto val = std::get<double>(currentToken_.value);
+        expr->literal = std::get<double>(currentToken_.value);
         advance();
-        return val;
+        return expr;
     }
     if (check(TokenType::StringLiteral) || check(TokenType::WideStringLiteral)) {
-        auto val = std::get<std::string>(currentToken_.value);
+        expr->literal = arena_->copyString(currentToken_.stringValue());
         advance();
-        return val;
+        return expr;
     }
     if (check(TokenType::CharLiteral) || check(TokenType::WideCharLiteral)) {
-        auto val = std::get<char>(currentToken_.value);
+        char value = std::get<char>(currentToken_.value);
+        expr->literal = arena_->copyString(std::string_view(&value, 1));
         advance();
-        return std::string(1, val);
+        return expr;
     }
     if (match(TokenType::KwTrue)) {
-        return true;
+        expr->literal = true;
+        return expr;
     }
     if (match(TokenType::KwFalse)) {
-        return false;
+        expr->literal = false;
+        return expr;
     }
 
-    // Scoped name (constant reference)
+    // Scoped name (constant reference), looked up during semantic analysis
     if (check(TokenType::Identifier) || check(TokenType::DoubleColon)) {
-        std::vector<std::string> parts;
-        bool isAbsolute = match(TokenType::DoubleColon);
+        std::vector<Name> parts;
+        expr->op = ConstExpr::Op::Name;
+        expr->isAbsolute = match(TokenType::DoubleColon);
 
         do {
             if (!check(TokenType::Identifier)) break;
-            parts.push_back(currentToken_.text);
+            parts.push_back(Name::intern(currentToken_.text));
             advance();
         } while (match(TokenType::DoubleColon));
 
-        // Look up the constant in symbol table
-        if (auto sym = symbolTable_.lookupScoped(parts, isAbsolute)) {
-            if (sym->kind == SymbolKind::Constant && sym->node) {
-                auto* constNode = static_cast<ConstNode*>(sym->node);
-                return constNode->value;
-            }
-            if (sym->kind == SymbolKind::EnumValue) {
-                // Return the enum value index (simplified)
-                return int64_t(0);
-            }
-        }
-
-        // Return 0 if not found (simplified error handling)
-        warning("Unknown constant: " + parts.back());
-        return int64_t(0);
+        expr->parts = arena_->copyArray(parts);
+        return expr;
     }
 
     error("Expected expression");
-    return int64_t(0);
+    expr->literal = int64_t(0);
+    return expr;
+}
+
+ASTPtr<ConstExpr> Parser::makeUnary(ConstExpr::Op op, ASTPtr<ConstExpr> operand,
+                                    SourceLocation loc) {
+    auto expr = arena_->create<ConstExpr>();
+    expr->op = op;
+    expr->lhs = operand;
+    expr->location = loc;
+    return expr;
+}
+
+ASTPtr<ConstExpr> Parser::makeBinary(ConstExpr::Op op, ASTPtr<ConstExpr> left,
+                                     ASTPtr<ConstExpr> right) {
+    auto expr = arena_->create<ConstExpr>();
+    expr->op = op;
+    expr->lhs = left;
+    expr->rhs = right;
+    expr->location = left->location;
+    return expr;
 }
 
 // ============================================================================
@@ -1274,7 +1273,7 @@ bool Parser::isTypeKeyword(TokenType type) const {
 }
 
 std::string Parser::getTokenText() const {
-    return currentToken_.text;
+    return std::string(currentToken_.text);
 }
 
 } // namespace iborb::parser
@@ -2,15 +2,22 @@
 #define IBORB_IDL_PARSER_HPP
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <functional>
 #include "ast/ast.hpp"
 #include "lexer/lexer.hpp"
-#include "semantic/symbol_table.hpp"
+#include "parser/definition_sink.hpp"
+
+namespace iborb::semantic {
+class SymbolTable;
+}
 
 namespace iborb::parser {
 
+class IncludeCache;
+
 /**
  * @brief Parser error information
  */
@@ -23,8 +30,9 @@ struct ParserError {
 /**
  * @brief IDL Recursive Descent Parser
  * 
- * Parses IDL tokens into an Abstract Syntax Tree while performing
- * basic semantic analysis (symbol table management).
+ * Parses IDL tokens into an Abstract Syntax Tree. The tree is purely
+ * syntactic: names are not looked up and constant expressions are not
+ * evaluated; semantic::Analyzer does both afterwards.
  */
 class Parser {
 public:
@@ -33,7 +41,20 @@ public:
      * @param source IDL source code
      * @param filename Filename for error reporting
      */
-    Parser(const std::string& source, const std::string& filename = "<input>");
+    Parser(std::string source, const std::string& filename = "<input>");
+
+    /**
+     * @brief Construct parser over a mapped or owning source buffer
+     * @param buffer Source buffer, lexed in place without copying
+     * @param filename Filename for error reporting
+     */
+    Parser(std::unique_ptr<source::SourceBuffer> buffer, const std::string& filename = "<input>");
+
+    /**
+     * @brief Resolve import pragmas against a cache of parsed headers
+     * @param cache Cache that produced the imports (may be nullptr)
+     */
+    void setIncludeCache(const IncludeCache* cache) { includeCache_ = cache; }
 
     /**
      * @brief Parse the entire translation unit
@@ -41,6 +62,14 @@ public:
      */
     ast::TranslationUnit parse();
 
+    /**
+     * @brief Parse the translation unit, handing it over as it is parsed
+     *
+     * Each definition is given to the sink as soon as it is complete,
+     * in an arena of its own, so no complete tree is ever built.
+     */
+    void parse(DefinitionSink& sink);
+
     /**
      * @brief Get all collected errors
      */
@@ -57,17 +86,21 @@ public:
     bool hasErrors() const;
 
     /**
-     * @brief Get the symbol table (for semantic analysis)
+     * @brief Get the symbols of the imported headers, parallel to TranslationUnit::imports
      */
-    semantic::SymbolTable& getSymbolTable() { return symbolTable_; }
-    const semantic::SymbolTable& getSymbolTable() const { return symbolTable_; }
+    const std::vector<const semantic::SymbolTable*>& getImportedSymbols() const {
+        return importedSymbols_;
+    }
 
 private:
     lexer::Lexer lexer_;
     lexer::Token currentToken_;
     lexer::Token previousToken_;
     std::vector<ParserError> errors_;
-    semantic::SymbolTable symbolTable_;
+    std::vector<const semantic::SymbolTable*> importedSymbols_;
+    const IncludeCache* includeCache_ = nullptr;
+    ast::Arena* arena_ = nullptr;  // Arena of the unit or streamed definition being parsed
+    std::unordered_map<int64_t, ast::ASTPtr<ast::ConstExpr>> integerLiterals_;  // In arena_
     bool hadError_ = false;
     bool panicMode_ = false;
 
@@ -90,6 +123,9 @@ private:
     // ========================================================================
 
     // Top-level definitions
+    bool parseImport(std::vector<ast::ImportedUnit>& imports, size_t position);
+    void streamDefinition(DefinitionSink& sink);
+    void streamModule(DefinitionSink& sink);
     ast::ASTPtr<ast::DefinitionNode> parseDefinition();
     ast::ASTPtr<ast::ModuleNode> parseModule();
     ast::ASTPtr<ast::InterfaceNode> parseInterface(bool isAbstract = false, bool isLocal = false);
@@ -102,7 +138,7 @@ private:
 
     // Interface contents
     ast::ASTPtr<ast::OperationNode> parseOperation(ast::ASTPtr<ast::TypeNode> returnType,
-                                                    const std::string& name,
+                                                    ast::Name name,
                                                     bool isOneway = false);
     ast::ASTPtr<ast::AttributeNode> parseAttribute(bool isReadonly = false);
     ast::ASTPtr<ast::ParameterNode> parseParameter();
@@ -122,22 +158,26 @@ private:
 
     // Declarators (for typedef with arrays)
     struct Declarator {
-        std::string name;
-        std::vector<size_t> arrayDimensions;
+        ast::Name name;
+        std::vector<ast::ASTPtr<ast::ConstExpr>> dimensions;
     };
     Declarator parseDeclarator();
     std::vector<Declarator> parseDeclarators();
 
     // Expressions (for constants and array bounds)
-    ast::ConstValue parseConstExpr();
-    ast::ConstValue parseOrExpr();
-    ast::ConstValue parseXorExpr();
-    ast::ConstValue parseAndExpr();
-    ast::ConstValue parseShiftExpr();
-    ast::ConstValue parseAddExpr();
-    ast::ConstValue parseMulExpr();
-    ast::ConstValue parseUnaryExpr();
-    ast::ConstValue parsePrimaryExpr();
+    ast::ASTPtr<ast::ConstExpr> parseConstExpr();
+    ast::ASTPtr<ast::ConstExpr> parseOrExpr();
+    ast::ASTPtr<ast::ConstExpr> parseXorExpr();
+    ast::ASTPtr<ast::ConstExpr> parseAndExpr();
+    ast::ASTPtr<ast::ConstExpr> parseShiftExpr();
+    ast::ASTPtr<ast::ConstExpr> parseAddExpr();
+    ast::ASTPtr<ast::ConstExpr> parseMulExpr();
+    ast::ASTPtr<ast::ConstExpr> parseUnaryExpr();
+    ast::ASTPtr<ast::ConstExpr> parsePrimaryExpr();
+    ast::ASTPtr<ast::ConstExpr> makeUnary(ast::ConstExpr::Op op, ast::ASTPtr<ast::ConstExpr> operand,
+                                          ast::SourceLocation loc);
+    ast::ASTPtr<ast::ConstExpr> makeBinary(ast::ConstExpr::Op op, ast::ASTPtr<ast::ConstExpr> left,
+                                           ast::ASTPtr<ast::ConstExpr> right);
 
     // Helpers
     std::vector<std::string> parseInheritanceSpec();
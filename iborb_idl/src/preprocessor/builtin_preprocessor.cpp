@@ -0,0 +1,1564 @@
+#include "preprocessor/builtin_preprocessor.hpp"
+#include "source/source_buffer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace iborb::preprocessor {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr int kMaxIncludeDepth = 200;
+
+/**
+ * @brief Fatal preprocessing error; the message is prefixed with the location
+ */
+struct PreprocessError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// ============================================================================
+// Character helpers
+// ============================================================================
+
+bool isIdentStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool isIdentChar(char c) {
+    return isIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool isSpace(char c) {
+    return isBlank(c) || c == '\n';
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+std::string_view readIdentifier(std::string_view text, size_t& pos) {
+    size_t start = pos;
+    if (pos < text.size() && isIdentStart(text[pos])) {
+        while (pos < text.size() && isIdentChar(text[pos])) ++pos;
+    }
+    return text.substr(start, pos - start);
+}
+
+/**
+ * @brief Skip a string or character literal starting at text[pos]
+ * @return Offset just past the closing quote, or the end of the text
+ */
+size_t skipQuoted(std::string_view text, size_t pos) {
+    char quote = text[pos++];
+    while (pos < text.size() && text[pos] != quote && text[pos] != '\n') {
+        if (text[pos] == '\\' && pos + 1 < text.size()) ++pos;
+        ++pos;
+    }
+    return pos < text.size() && text[pos] == quote ? pos + 1 : pos;
+}
+
+/**
+ * @brief Directory part of a path as GCC composes it for quoted includes
+ */
+std::string directoryOf(const std::string& path) {
+#ifdef _WIN32
+    size_t slash = path.find_last_of("/\\");
+#else
+    size_t slash = path.find_last_of('/');
+#endif
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// ============================================================================
+// Preprocessing tokens
+// ============================================================================
+
+enum class PPTokenKind { Identifier, Number, Literal, Punct, Space };
+
+struct PPToken {
+    PPTokenKind kind = PPTokenKind::Space;
+    std::string text;
+    std::vector<std::string_view> hideSet;  // Macros that must not expand this token
+
+    bool is(std::string_view punct) const {
+        return kind == PPTokenKind::Punct && text == punct;
+    }
+};
+
+using TokenList = std::vector<PPToken>;
+
+constexpr std::string_view kPunctuators[] = {
+    "...", "<<=", ">>=",
+    "##", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "::", "->",
+    "++", "--", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+};
+
+bool isPunctuator(std::string_view text) {
+    for (auto p : kPunctuators) {
+        if (p == text) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Split one logical line (comments already removed) into tokens
+ */
+TokenList tokenize(std::string_view text) {
+    TokenList tokens;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        size_t start = pos;
+        PPTokenKind kind;
+
+        if (isSpace(c)) {
+            while (pos < text.size() && isSpace(text[pos])) ++pos;
+            bool newline = text.substr(start, pos - start).find('\n') != std::string_view::npos;
+            tokens.push_back({PPTokenKind::Space, newline ? "\n" : " ", {}});
+            continue;
+        }
+
+        if (isIdentStart(c)) {
+            readIdentifier(text, pos);
+            kind = PPTokenKind::Identifier;
+            if (pos - start == 1 && c == 'L' && pos < text.size() &&
+                (text[pos] == '"' || text[pos] == '\'')) {
+                pos = skipQuoted(text, pos);
+                kind = PPTokenKind::Literal;
+            }
+        } else if (isDigit(c) || (c == '.' && pos + 1 < text.size() && isDigit(text[pos + 1]))) {
+            ++pos;
+            while (pos < text.size()) {
+                char n = text[pos];
+                if ((n == '+' || n == '-') && std::strchr("eEpP", text[pos - 1])) {
+                    ++pos;
+                } else if (isIdentChar(n) || n == '.') {
+                    ++pos;
+                } else {
+                    break;
+                }
+            }
+            kind = PPTokenKind::Number;
+        } else if (c == '"' || c == '\'') {
+            pos = skipQuoted(text, pos);
+            kind = PPTokenKind::Literal;
+        } else {
+            size_t len = 1;
+            for (size_t n = 3; n >= 2; --n) {
+                if (isPunctuator(text.substr(pos, n))) {
+                    len = n;
+                    break;
+                }
+            }
+            pos += len;
+            kind = PPTokenKind::Punct;
+        }
+
+        tokens.push_back({kind, std::string(text.substr(start, pos - start)), {}});
+    }
+    return tokens;
+}
+
+/**
+ * @brief Check whether two adjacent tokens would lex differently if joined
+ */
+bool needsSeparator(const PPToken& a, const PPToken& b) {
+    bool aWord = a.kind == PPTokenKind::Identifier || a.kind == PPTokenKind::Number;
+    bool bWord = b.kind == PPTokenKind::Identifier || b.kind == PPTokenKind::Number;
+    if (aWord && (bWord || b.kind == PPTokenKind::Literal)) return true;
+    if (a.kind == PPTokenKind::Number && b.text[0] == '.') return true;
+    if (a.kind == PPTokenKind::Punct && b.kind == PPTokenKind::Punct) {
+        char joined[2] = {a.text.back(), b.text.front()};
+        return isPunctuator(std::string_view(joined, 2));
+    }
+    return false;
+}
+
+void appendTokens(std::string& out, const TokenList& tokens) {
+    const PPToken* prev = nullptr;
+    for (const auto& tok : tokens) {
+        if (tok.kind == PPTokenKind::Space) {
+            out += tok.text;
+            prev = nullptr;
+            continue;
+        }
+        if (prev && needsSeparator(*prev, tok)) {
+            out += ' ';
+        }
+        out += tok.text;
+        prev = &tok;
+    }
+}
+
+size_t skipSpaces(const TokenList& tokens, size_t i) {
+    while (i < tokens.size() && tokens[i].kind == PPTokenKind::Space) ++i;
+    return i;
+}
+
+void trimSpaces(TokenList& tokens) {
+    while (!tokens.empty() && tokens.back().kind == PPTokenKind::Space) tokens.pop_back();
+    size_t first = skipSpaces(tokens, 0);
+    tokens.erase(tokens.begin(), tokens.begin() + static_cast<std::ptrdiff_t>(first));
+}
+
+// ============================================================================
+// Logical lines
+// ============================================================================
+
+/**
+ * @brief Splits a buffer into logical lines
+ *
+ * Joins backslash continuations and replaces each comment with a single
+ * space. Newlines inside block comments, and continuations between
+ * tokens, are kept so that the tokens after them stay on their original
+ * lines. Lines without comments, quotes or
+ * continuations are returned as views into the buffer; the rest are
+ * assembled in a scratch string.
+ */
+class LineReader {
+public:
+    explicit LineReader(std::string_view text) : text_(text) {}
+
+    /**
+     * @brief Read the next logical line
+     * @param line Receives the line without its terminating newline
+     * @return false at end of input
+     */
+    bool next(std::string_view& line) {
+        if (pos_ >= text_.size()) return false;
+        startLine_ = nextLine_;
+
+        const char* begin = text_.data() + pos_;
+        size_t remaining = text_.size() - pos_;
+        auto* newline = static_cast<const char*>(std::memchr(begin, '\n', remaining));
+        size_t length = newline ? static_cast<size_t>(newline - begin) : remaining;
+
+        std::string_view raw(begin, length);
+        if (raw.find_first_of("/\\\"'") == std::string_view::npos) {
+            line = raw;
+            pos_ += length + 1;
+            ++nextLine_;
+            return true;
+        }
+
+        assembleLine();
+        line = scratch_;
+        return true;
+    }
+
+    /**
+     * @brief Physical line number at which the last logical line started
+     */
+    unsigned lineNumber() const { return startLine_; }
+
+    /**
+     * @brief Number of physical lines the last logical line spanned
+     */
+    unsigned physicalLines() const { return nextLine_ - startLine_; }
+
+    bool hadUnterminatedComment() const { return unterminatedComment_; }
+
+private:
+    std::string_view text_;
+    size_t pos_ = 0;
+    unsigned startLine_ = 1;
+    unsigned nextLine_ = 1;
+    std::string scratch_;
+    bool unterminatedComment_ = false;
+
+    void assembleLine() {
+        scratch_.clear();
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c == '\n') {
+                ++pos_;
+                break;
+            }
+            if (c == '\\' && isContinuation(pos_ + 1)) {
+                pos_ = skipNewline(pos_ + 1);
+                ++nextLine_;
+                // Keep the line break unless it splits a token
+                bool between = (!scratch_.empty() && isSpace(scratch_.back())) ||
+                               (pos_ < text_.size() && isBlank(text_[pos_]));
+                if (between) scratch_ += '\n';
+                continue;
+            }
+            if (c == '/' && pos_ + 1 < text_.size() && text_[pos_ + 1] == '/') {
+                while (pos_ < text_.size() && text_[pos_] != '\n') ++pos_;
+                scratch_ += ' ';
+                continue;
+            }
+            if (c == '/' && pos_ + 1 < text_.size() && text_[pos_ + 1] == '*') {
+                size_t end = text_.find("*/", pos_ + 2);
+                if (end == std::string_view::npos) {
+                    unterminatedComment_ = true;
+                    end = text_.size();
+                } else {
+                    end += 2;
+                }
+                auto newlines = static_cast<unsigned>(
+                    std::count(text_.begin() + static_cast<std::ptrdiff_t>(pos_),
+                               text_.begin() + static_cast<std::ptrdiff_t>(end), '\n'));
+                nextLine_ += newlines;
+                pos_ = end;
+                scratch_ += ' ';
+                scratch_.append(newlines, '\n');
+                continue;
+            }
+            if (c == '"' || c == '\'') {
+                size_t end = skipQuoted(text_, pos_);
+                scratch_.append(text_.substr(pos_, end - pos_));
+                pos_ = end;
+                continue;
+            }
+            scratch_ += c;
+            ++pos_;
+        }
+        ++nextLine_;
+    }
+
+    bool isContinuation(size_t pos) const {
+        if (pos < text_.size() && text_[pos] == '\n') return true;
+        return pos + 1 < text_.size() && text_[pos] == '\r' && text_[pos + 1] == '\n';
+    }
+
+    size_t skipNewline(size_t pos) const {
+        return text_[pos] == '\r' ? pos + 2 : pos + 1;
+    }
+};
+
+// ============================================================================
+// Macros
+// ============================================================================
+
+struct Macro {
+    std::string name;
+    std::vector<std::string> params;
+    TokenList body;
+    bool functionLike = false;
+    bool variadic = false;
+    bool predefined = false;  // Defined on the command line and untouched since
+
+    int paramIndex(const PPToken& tok) const {
+        if (!functionLike || tok.kind != PPTokenKind::Identifier) return -1;
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (params[i] == tok.text) return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+} // anonymous namespace
+
+/**
+ * @brief A file whose text ends up in a preprocessed header
+ */
+struct IncludedFile {
+    static constexpr uint32_t kTextual = UINT32_MAX;
+
+    std::string canonical;
+    std::string guard;                 // Include guard, empty if none
+    uint32_t owner = kTextual;         // Id of the imported header holding it, or kTextual
+};
+
+/**
+ * @brief Macro state left behind by preprocessing a header on its own
+ *
+ * Replaying it into another run affects the following lines exactly as
+ * reading the header would, as long as that run defines none of the
+ * names the header looked up while they were undefined and has not
+ * changed any of the predefined macros the header used.
+ */
+struct MacroState {
+    std::vector<Macro> macros;         // Defined at the end, except untouched predefined ones
+    std::vector<std::string> removed;  // Predefined macros the header undefined
+    std::unordered_map<std::string, std::string> includeGuards;
+    std::unordered_set<std::string> onceFiles;
+    std::vector<IncludedFile> files;  // Every file read or imported, directly or not
+    std::vector<cache::FileHash> fileHashes;  // Content of every file read, through imports too
+    std::unordered_set<std::string> undefinedLookups;   // Names looked up while undefined
+    std::unordered_set<std::string> predefinedLookups;  // Predefined macros that were used
+    std::string guard;         // Include guard of the header itself
+    bool pragmaOnce = false;
+    bool includeOnce = false;  // Guarded or #pragma once, and ends between definitions
+};
+
+namespace {
+
+// ============================================================================
+// #if expression evaluation
+// ============================================================================
+
+/**
+ * @brief Evaluates a fully macro-expanded #if expression
+ *
+ * Values are intmax_t or uintmax_t as in C: a u or U suffix, or a
+ * literal too large for int64_t, makes a value unsigned, and the usual
+ * arithmetic conversions make an operation unsigned if either operand
+ * is. Signed overflow wraps instead of being undefined.
+ */
+class ExpressionEvaluator {
+public:
+    explicit ExpressionEvaluator(const TokenList& tokens) {
+        for (const auto& tok : tokens) {
+            if (tok.kind != PPTokenKind::Space) tokens_.push_back(&tok);
+        }
+    }
+
+    int64_t evaluate() {
+        if (tokens_.empty()) {
+            throw PreprocessError("#if with no expression");
+        }
+        Value value = parseConditional();
+        if (pos_ < tokens_.size()) {
+            throw PreprocessError("missing binary operator before token \"" +
+                                  tokens_[pos_]->text + "\"");
+        }
+        return value.asSigned();
+    }
+
+private:
+    /**
+     * @brief Two's complement bits of a value and whether they are read as unsigned
+     */
+    struct Value {
+        uint64_t bits = 0;
+        bool isUnsigned = false;
+
+        static Value fromSigned(int64_t value) { return {static_cast<uint64_t>(value), false}; }
+        static Value fromBool(bool value) { return {value ? 1u : 0u, false}; }
+
+        int64_t asSigned() const { return static_cast<int64_t>(bits); }
+        explicit operator bool() const { return bits != 0; }
+    };
+
+    std::vector<const PPToken*> tokens_;
+    size_t pos_ = 0;
+    int skipDepth_ = 0;  // > 0 inside a branch that is not evaluated
+
+    bool match(std::string_view punct) {
+        if (pos_ < tokens_.size() && tokens_[pos_]->is(punct)) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    Value parseConditional() {
+        Value cond = parseBinary(0);
+        if (!match("?")) return cond;
+
+        if (!cond) ++skipDepth_;
+        Value whenTrue = parseConditional();
+        if (!cond) --skipDepth_;
+        if (!match(":")) {
+            throw PreprocessError("expected ':' in #if expression");
+        }
+        if (cond) ++skipDepth_;
+        Value whenFalse = parseConditional();
+        if (cond) --skipDepth_;
+
+        // The result has the common type of both branches
+        Value result = cond ? whenTrue : whenFalse;
+        result.isUnsigned = whenTrue.isUnsigned || whenFalse.isUnsigned;
+        return result;
+    }
+
+    static int precedence(std::string_view op) {
+        static const std::pair<std::string_view, int> table[] = {
+            {"||", 1}, {"&&", 2}, {"|", 3}, {"^", 4}, {"&", 5},
+            {"==", 6}, {"!=", 6}, {"<", 7}, {">", 7}, {"<=", 7}, {">=", 7},
+            {"<<", 8}, {">>", 8}, {"+", 9}, {"-", 9}, {"*", 10}, {"/", 10}, {"%", 10},
+        };
+        for (const auto& [text, prec] : table) {
+            if (text == op) return prec;
+        }
+        return -1;
+    }
+
+    Value parseBinary(int minPrec) {
+        Value lhs = parseUnary();
+        while (pos_ < tokens_.size() && tokens_[pos_]->kind == PPTokenKind::Punct) {
+            std::string_view op = tokens_[pos_]->text;
+            int prec = precedence(op);
+            if (prec < minPrec) break;
+            ++pos_;
+
+            bool shortCircuit = (op == "&&" && !lhs) || (op == "||" && lhs);
+            if (shortCircuit) ++skipDepth_;
+            Value rhs = parseBinary(prec + 1);
+            if (shortCircuit) --skipDepth_;
+            lhs = apply(op, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    Value apply(std::string_view op, Value lhs, Value rhs) const {
+        if (op == "||") return Value::fromBool(lhs || rhs);
+        if (op == "&&") return Value::fromBool(lhs && rhs);
+        if (op == "<<" || op == ">>") return shift(op == "<<", lhs, rhs);
+
+        // Usual arithmetic conversions
+        bool isUnsigned = lhs.isUnsigned || rhs.isUnsigned;
+        uint64_t a = lhs.bits;
+        uint64_t b = rhs.bits;
+        auto less = [&](uint64_t x, uint64_t y) {
+            return isUnsigned ? x < y : static_cast<int64_t>(x) < static_cast<int64_t>(y);
+        };
+        if (op == "==") return Value::fromBool(a == b);
+        if (op == "!=") return Value::fromBool(a != b);
+        if (op == "<") return Value::fromBool(less(a, b));
+        if (op == ">") return Value::fromBool(less(b, a));
+        if (op == "<=") return Value::fromBool(!less(b, a));
+        if (op == ">=") return Value::fromBool(!less(a, b));
+
+        Value result{0, isUnsigned};
+        if (op == "|") result.bits = a | b;
+        else if (op == "^") result.bits = a ^ b;
+        else if (op == "&") result.bits = a & b;
+        else if (op == "+") result.bits = a + b;
+        else if (op == "-") result.bits = a - b;
+        else if (op == "*") result.bits = a * b;
+        else {
+            if (b == 0) {
+                if (skipDepth_ > 0) return result;
+                throw PreprocessError("division by zero in #if");
+            }
+            if (isUnsigned) {
+                result.bits = op == "/" ? a / b : a % b;
+            } else if (static_cast<int64_t>(b) == -1) {
+                // INT64_MIN / -1 overflows; wrap like the other operators
+                result.bits = op == "/" ? 0 - a : 0;
+            } else {
+                auto x = static_cast<int64_t>(a);
+                auto y = static_cast<int64_t>(b);
+                result.bits = static_cast<uint64_t>(op == "/" ? x / y : x % y);
+            }
+        }
+        return result;
+    }
+
+    // The result has the type of the left operand; a negative count
+    // shifts the other way, as GCC does
+    static Value shift(bool left, Value lhs, Value rhs) {
+        uint64_t count = rhs.bits;
+        if (!rhs.isUnsigned && rhs.asSigned() < 0) {
+            left = !left;
+            count = 0 - count;
+        }
+        Value result{0, lhs.isUnsigned};
+        if (left) {
+            result.bits = count >= 64 ? 0 : lhs.bits << count;
+        } else if (lhs.isUnsigned || lhs.asSigned() >= 0) {
+            result.bits = count >= 64 ? 0 : lhs.bits >> count;
+        } else {
+            result.bits = static_cast<uint64_t>(lhs.asSigned() >> (count >= 64 ? 63 : count));
+        }
+        return result;
+    }
+
+    Value parseUnary() {
+        if (match("!")) return Value::fromBool(!parseUnary());
+        if (match("~")) {
+            Value value = parseUnary();
+            value.bits = ~value.bits;
+            return value;
+        }
+        if (match("-")) {
+            Value value = parseUnary();
+            value.bits = 0 - value.bits;
+            return value;
+        }
+        if (match("+")) return parseUnary();
+        return parsePrimary();
+    }
+
+    Value parsePrimary() {
+        if (pos_ >= tokens_.size()) {
+            throw PreprocessError("#if expression ends unexpectedly");
+        }
+        const PPToken& tok = *tokens_[pos_++];
+
+        if (tok.is("(")) {
+            Value value = parseConditional();
+            if (!match(")")) {
+                throw PreprocessError("missing ')' in #if expression");
+            }
+            return value;
+        }
+        if (tok.kind == PPTokenKind::Number) {
+            return parseNumber(tok.text);
+        }
+        if (tok.kind == PPTokenKind::Literal && tok.text.back() == '\'') {
+            return Value::fromSigned(parseCharacter(tok.text));
+        }
+        if (tok.kind == PPTokenKind::Identifier) {
+            return Value();  // Identifiers left after expansion evaluate to 0
+        }
+        throw PreprocessError("token \"" + tok.text + "\" is not valid in #if expressions");
+    }
+
+    static Value parseNumber(const std::string& text) {
+        std::string digits = text;
+        bool isUnsigned = false;
+        while (!digits.empty() && std::strchr("uUlL", digits.back())) {
+            if (digits.back() == 'u' || digits.back() == 'U') isUnsigned = true;
+            digits.pop_back();
+        }
+
+        int base = 10;
+        size_t start = 0;
+        if (digits.size() > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+            base = 16;
+            start = 2;
+        } else if (digits.size() > 2 && digits[0] == '0' && (digits[1] == 'b' || digits[1] == 'B')) {
+            base = 2;
+            start = 2;
+        } else if (digits.size() > 1 && digits[0] == '0') {
+            base = 8;
+            start = 1;
+        }
+
+        char* end = nullptr;
+        uint64_t value = std::strtoull(digits.c_str() + start, &end, base);
+        if (start == digits.size() || *end != '\0') {
+            throw PreprocessError("invalid integer \"" + text + "\" in #if expression");
+        }
+
+        // A literal too large for intmax_t is a uintmax_t
+        if (value > static_cast<uint64_t>(INT64_MAX)) isUnsigned = true;
+        return {value, isUnsigned};
+    }
+
+    static int64_t parseCharacter(const std::string& text) {
+        size_t pos = text.find('\'') + 1;
+        if (pos >= text.size() - 1) {
+            throw PreprocessError("empty character constant in #if expression");
+        }
+        if (text[pos] != '\\') {
+            return static_cast<unsigned char>(text[pos]);
+        }
+        char esc = text[pos + 1];
+        switch (esc) {
+            case 'n': return '\n';
+            case 't': return '\t';
+            case 'r': return '\r';
+            case 'a': return '\a';
+            case 'b': return '\b';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case 'x': return static_cast<int64_t>(std::strtoul(text.c_str() + pos + 2, nullptr, 16));
+            default:
+                if (esc >= '0' && esc <= '7') {
+                    return static_cast<int64_t>(std::strtoul(text.c_str() + pos + 1, nullptr, 8));
+                }
+                return static_cast<unsigned char>(esc);
+        }
+    }
+};
+
+// ============================================================================
+// Preprocessor run
+// ============================================================================
+
+/**
+ * @brief State of one preprocessing run over a main file and its includes
+ */
+class Processor {
+public:
+    Processor(const std::vector<std::string>& includePaths, IncludeHandler* handler)
+        : includePaths_(includePaths), handler_(handler) {}
+
+    void define(const std::string& name, const std::string& value) {
+        std::string text = name + " " + (value.empty() ? "1" : value);
+        Macro& macro = defineMacro(text);
+        macro.predefined = true;
+        predefinedNames_.push_back(macro.name);
+    }
+
+    void processMain(std::string_view text, const std::string& filename) {
+        out_.reserve(text.size() + text.size() / 8);
+        out_ += "# 1 \"" + filename + "\"\n";
+        state_.fileHashes.push_back({filename, cache::hashFileContent(text)});
+        std::string guard = processText(text, filename, std::string());
+        captureState(guard);
+    }
+
+    std::string takeOutput() { return std::move(out_); }
+    std::vector<std::string> takeWarnings() { return std::move(warnings_); }
+    std::shared_ptr<const MacroState> takeState() {
+        return std::make_shared<MacroState>(std::move(state_));
+    }
+
+private:
+    /**
+     * @brief Location state of the file currently being read
+     */
+    struct FileState {
+        std::string name;       // Presumed name, as written in line markers
+        std::string directory;  // Directory searched first by quoted includes
+        unsigned line = 1;      // Physical line of the current logical line
+        int lineDelta = 0;      // Adjustment applied by #line
+    };
+
+    struct Conditional {
+        bool parentActive;
+        bool active;
+        bool taken;     // Some branch of this group has been selected
+        bool seenElse;
+    };
+
+    enum class GuardState { Start, InGuard, AfterGuard, None };
+
+    const std::vector<std::string>& includePaths_;
+    IncludeHandler* handler_;
+    std::unordered_map<std::string_view, std::unique_ptr<Macro>> macros_;
+    std::vector<std::string> predefinedNames_;
+    std::unordered_map<std::string, std::string> includeGuards_;  // Canonical path -> guard macro
+    std::unordered_set<std::string> onceFiles_;
+    std::unordered_map<std::string, uint32_t> files_;  // Canonical path -> IncludedFile::owner
+    MacroState state_;  // Dependencies recorded for the handler
+    std::string out_;
+    std::vector<std::string> warnings_;
+    FileState* file_ = nullptr;
+    int depth_ = 0;
+    bool mainPragmaOnce_ = false;
+
+    // Position in the output, used to decide whether an include may be imported
+    int braceDepth_ = 0;
+    char lastSignificant_ = 0;
+
+    unsigned presumedLine() const {
+        return static_cast<unsigned>(static_cast<int>(file_->line) + file_->lineDelta);
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw PreprocessError(file_->name + ":" + std::to_string(presumedLine()) +
+                              ": error: " + message);
+    }
+
+    static void recordLookup(std::unordered_set<std::string>& names, std::string_view name) {
+        names.insert(std::string(name));
+    }
+
+    /**
+     * @brief Look up a macro, recording the dependency when headers are shared
+     */
+    const Macro* findMacro(std::string_view name) {
+        auto it = macros_.find(name);
+        if (it == macros_.end()) {
+            if (handler_) recordLookup(state_.undefinedLookups, name);
+            return nullptr;
+        }
+        if (handler_ && it->second->predefined) {
+            recordLookup(state_.predefinedLookups, name);
+        }
+        return it->second.get();
+    }
+
+    bool isDefined(std::string_view name) {
+        return name == "__FILE__" || name == "__LINE__" || findMacro(name) != nullptr;
+    }
+
+    /**
+     * @brief Preprocess one file's text
+     * @return The file's include guard macro, or an empty string if it has none
+     */
+    std::string processText(std::string_view text, const std::string& name,
+                            const std::string& canonical) {
+        FileState state{name, directoryOf(name), 1, 0};
+        FileState* parent = file_;
+        file_ = &state;
+
+        LineReader reader(text);
+        std::vector<Conditional> conditionals;
+        GuardState guard = GuardState::Start;
+        std::string guardMacro;
+        std::string_view line;
+
+        while (reader.next(line)) {
+            state.line = reader.lineNumber();
+            unsigned physical = reader.physicalLines();
+            std::string_view content = trim(line);
+
+            if (!content.empty() && guard == GuardState::AfterGuard) {
+                guard = GuardState::None;
+            }
+
+            if (!content.empty() && content[0] == '#') {
+                size_t pos = 1;
+                while (pos < content.size() && isSpace(content[pos])) ++pos;
+                std::string_view directive = readIdentifier(content, pos);
+                std::string_view rest = trim(content.substr(pos));
+
+                if (guard == GuardState::Start) {
+                    guard = directive == "ifndef" ? GuardState::InGuard : GuardState::None;
+                    size_t wordPos = 0;
+                    guardMacro = std::string(readIdentifier(rest, wordPos));
+                } else if (guard == GuardState::InGuard && conditionals.size() == 1) {
+                    if (directive == "endif") {
+                        guard = GuardState::AfterGuard;
+                    } else if (directive == "else" || directive == "elif") {
+                        guard = GuardState::None;
+                    }
+                }
+
+                if (handleDirective(directive, rest, content, conditionals, physical, canonical)) {
+                    continue;  // The directive wrote its own line markers
+                }
+                out_.append(physical, '\n');
+                continue;
+            }
+
+            if (!content.empty() && guard == GuardState::Start) {
+                guard = GuardState::None;
+            }
+
+            bool active = conditionals.empty() || conditionals.back().active;
+            if (active && !content.empty()) {
+                physical -= std::min(physical - 1, expandLine(line));
+            }
+            out_.append(physical, '\n');
+        }
+
+        if (reader.hadUnterminatedComment()) {
+            fail("unterminated comment");
+        }
+        if (!conditionals.empty()) {
+            fail("unterminated conditional directive");
+        }
+        if (guard != GuardState::AfterGuard) {
+            guardMacro.clear();
+        }
+        if (!guardMacro.empty() && !canonical.empty()) {
+            includeGuards_[canonical] = guardMacro;
+        }
+
+        file_ = parent;
+        return guardMacro;
+    }
+
+    void captureState(const std::string& guard) {
+        for (const auto& [name, macro] : macros_) {
+            if (!macro->predefined) state_.macros.push_back(*macro);
+        }
+        for (const auto& name : predefinedNames_) {
+            if (macros_.count(name) == 0) state_.removed.push_back(name);
+        }
+        state_.includeGuards = includeGuards_;
+        state_.onceFiles = onceFiles_;
+        state_.guard = guard;
+        state_.pragmaOnce = mainPragmaOnce_;
+        state_.includeOnce = (!guard.empty() || mainPragmaOnce_) && atDefinitionBoundary();
+    }
+
+    /**
+     * @brief Execute a directive line
+     * @return true if the directive emitted the newlines for its line itself
+     */
+    bool handleDirective(std::string_view directive, std::string_view rest,
+                         std::string_view content, std::vector<Conditional>& conditionals,
+                         unsigned physical, const std::string& canonical) {
+        bool active = conditionals.empty() || conditionals.back().active;
+
+        if (directive == "if" || directive == "ifdef" || directive == "ifndef") {
+            if (!active) {
+                conditionals.push_back({false, false, true, false});
+                return false;
+            }
+            bool value;
+            if (directive == "if") {
+                value = evaluateCondition(rest);
+            } else {
+                size_t pos = 0;
+                std::string_view name = readIdentifier(rest, pos);
+                if (name.empty()) {
+                    fail("no macro name given in #" + std::string(directive) + " directive");
+                }
+                value = isDefined(name) == (directive == "ifdef");
+            }
+            conditionals.push_back({true, value, value, false});
+            return false;
+        }
+
+        if (directive == "elif" || directive == "else" || directive == "endif") {
+            if (conditionals.empty()) {
+                fail("#" + std::string(directive) + " without #if");
+            }
+            Conditional& cond = conditionals.back();
+            if (directive == "endif") {
+                conditionals.pop_back();
+                return false;
+            }
+            if (cond.seenElse) {
+                fail("#" + std::string(directive) + " after #else");
+            }
+            if (directive == "else") {
+                cond.seenElse = true;
+                cond.active = cond.parentActive && !cond.taken;
+            } else {
+                cond.active = cond.parentActive && !cond.taken && evaluateCondition(rest);
+            }
+            cond.taken = cond.taken || cond.active;
+            return false;
+        }
+
+        if (!active) {
+            return false;
+        }
+
+        if (directive == "define") {
+            defineMacro(rest);
+        } else if (directive == "undef") {
+            size_t pos = 0;
+            std::string_view name = readIdentifier(rest, pos);
+            if (name.empty()) {
+                fail("no macro name given in #undef directive");
+            }
+            macros_.erase(name);
+        } else if (directive == "include") {
+            includeFile(rest, physical);
+            return true;
+        } else if (directive == "pragma") {
+            if (rest == "once") {
+                if (!canonical.empty()) {
+                    onceFiles_.insert(canonical);
+                } else if (depth_ == 0) {
+                    mainPragmaOnce_ = true;
+                }
+                return false;
+            }
+            out_ += content;
+            out_.append(physical, '\n');
+            return true;
+        } else if (directive == "error") {
+            fail("#error " + std::string(rest));
+        } else if (directive == "warning") {
+            warnings_.push_back(file_->name + ":" + std::to_string(presumedLine()) +
+                                ": warning: #warning " + std::string(rest));
+        } else if (directive == "line" || (directive.empty() && !rest.empty() && isDigit(rest[0]))) {
+            applyLineDirective(rest, physical);
+            return true;
+        } else if (directive == "ident" || directive == "sccs" || (directive.empty() && rest.empty())) {
+            // Ignored
+        } else {
+            fail("invalid preprocessing directive #" + std::string(directive));
+        }
+        return false;
+    }
+
+    // ------------------------------------------------------------------------
+    // #define / #line / #include
+    // ------------------------------------------------------------------------
+
+    Macro& defineMacro(std::string_view text) {
+        size_t pos = 0;
+        std::string_view name = readIdentifier(text, pos);
+        if (name.empty()) {
+            fail("macro names must be identifiers");
+        }
+        if (name == "defined") {
+            fail("\"defined\" cannot be used as a macro name");
+        }
+
+        auto macro = std::make_unique<Macro>();
+        macro->name = std::string(name);
+
+        if (pos < text.size() && text[pos] == '(') {
+            macro->functionLike = true;
+            ++pos;
+            while (true) {
+                while (pos < text.size() && isSpace(text[pos])) ++pos;
+                if (pos < text.size() && text[pos] == ')' && macro->params.empty()) {
+                    ++pos;
+                    break;
+                }
+                std::string param(readIdentifier(text, pos));
+                while (pos < text.size() && isSpace(text[pos])) ++pos;
+                if (text.compare(pos, 3, "...") == 0) {
+                    macro->variadic = true;
+                    pos += 3;
+                    if (param.empty()) param = "__VA_ARGS__";
+                    while (pos < text.size() && isSpace(text[pos])) ++pos;
+                }
+                if (param.empty()) {
+                    fail("expected parameter name in macro \"" + macro->name + "\"");
+                }
+                macro->params.push_back(std::move(param));
+                if (pos < text.size() && text[pos] == ')') {
+                    ++pos;
+                    break;
+                }
+                if (macro->variadic || pos >= text.size() || text[pos] != ',') {
+                    fail("expected ',' or ')' in parameter list of macro \"" + macro->name + "\"");
+                }
+                ++pos;
+            }
+        }
+
+        macro->body = tokenize(text.substr(pos));
+        trimSpaces(macro->body);
+        for (auto& tok : macro->body) {
+            if (tok.kind == PPTokenKind::Space) tok.text = " ";
+        }
+
+        return addMacro(std::move(macro));
+    }
+
+    Macro& addMacro(std::unique_ptr<Macro> macro) {
+        std::string_view key = macro->name;
+        macros_.erase(key);
+        return *macros_.emplace(key, std::move(macro)).first->second;
+    }
+
+    void applyLineDirective(std::string_view rest, unsigned physical) {
+        TokenList tokens = tokenize(rest);
+        expandTokens(tokens);
+        size_t i = skipSpaces(tokens, 0);
+        if (i >= tokens.size() || tokens[i].kind != PPTokenKind::Number ||
+            !isDigit(tokens[i].text[0])) {
+            fail("\"" + std::string(rest) + "\" after #line is not a positive integer");
+        }
+        auto line = static_cast<unsigned>(std::strtoul(tokens[i].text.c_str(), nullptr, 10));
+        i = skipSpaces(tokens, i + 1);
+        if (i < tokens.size() && tokens[i].kind == PPTokenKind::Literal &&
+            tokens[i].text.front() == '"') {
+            file_->name = tokens[i].text.substr(1, tokens[i].text.size() - 2);
+        }
+
+        unsigned nextLine = file_->line + physical;
+        file_->lineDelta = static_cast<int>(line) - static_cast<int>(nextLine);
+        out_ += "# " + std::to_string(line) + " \"" + file_->name + "\"\n";
+    }
+
+    std::string resolveInclude(const std::string& name, bool quoted) const {
+        std::error_code ec;
+        if (fs::path(name).is_absolute()) {
+            return fs::is_regular_file(name, ec) ? name : std::string();
+        }
+        if (quoted) {
+            std::string candidate = file_->directory + name;
+            if (fs::is_regular_file(candidate, ec)) return candidate;
+        }
+        for (const auto& dir : includePaths_) {
+            std::string base = dir;
+            while (base.size() > 1 && (base.back() == '/' || base.back() == '\\')) base.pop_back();
+            std::string candidate = base + "/" + name;
+            if (fs::is_regular_file(candidate, ec)) return candidate;
+        }
+        return std::string();
+    }
+
+    void includeFile(std::string_view rest, unsigned physical) {
+        std::string spec(rest);
+        if (!spec.empty() && spec[0] != '"' && spec[0] != '<') {
+            TokenList tokens = tokenize(rest);
+            expandTokens(tokens);
+            spec.clear();
+            appendTokens(spec, tokens);
+            spec = std::string(trim(spec));
+        }
+
+        char close = !spec.empty() && spec[0] == '<' ? '>' : '"';
+        size_t end = spec.find(close, 1);
+        if (spec.empty() || (spec[0] != '"' && spec[0] != '<') || end == std::string::npos) {
+            fail("#include expects \"FILENAME\" or <FILENAME>");
+        }
+        std::string name = spec.substr(1, end - 1);
+
+        if (depth_ >= kMaxIncludeDepth) {
+            fail("#include nested depth " + std::to_string(depth_) + " exceeds maximum");
+        }
+        std::string path = resolveInclude(name, close == '"');
+        if (path.empty()) {
+            fail(name + ": No such file or directory");
+        }
+
+        std::error_code ec;
+        std::string canonical = fs::weakly_canonical(path, ec).string();
+        if (ec) canonical = path;
+
+        unsigned returnLine = presumedLine() + physical;
+        bool skip = onceFiles_.count(canonical) != 0;
+        if (!skip) {
+            auto guard = includeGuards_.find(canonical);
+            skip = guard != includeGuards_.end() && macros_.count(guard->second) != 0;
+        }
+
+        if (!skip && handler_ && atDefinitionBoundary() && files_.count(canonical) == 0) {
+            auto header = handler_->findHeader(path, canonical);
+            if (header && canImport(*header->macros)) {
+                importMacros(*header->macros, canonical, header->id);
+                out_ += kImportPragma;
+                out_ += " " + std::to_string(header->id) + "\n";
+                skip = true;
+            }
+        }
+
+        if (!skip) {
+            bool first = files_.emplace(canonical, IncludedFile::kTextual).second;
+
+            std::unique_ptr<source::SourceBuffer> buffer;
+            try {
+                buffer = source::SourceBuffer::fromFile(path);
+            } catch (const std::exception& e) {
+                fail(e.what());
+            }
+
+            out_ += "# 1 \"" + path + "\" 1\n";
+            state_.fileHashes.push_back({path, cache::hashFileContent(buffer->data())});
+            ++depth_;
+            std::string guard = processText(buffer->data(), path, canonical);
+            --depth_;
+            if (first && handler_) {
+                state_.files.push_back({canonical, std::move(guard), IncludedFile::kTextual});
+            }
+        }
+        out_ += "# " + std::to_string(returnLine) + " \"" + file_->name + "\" 2\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // Shared headers
+    // ------------------------------------------------------------------------
+
+    bool atDefinitionBoundary() const {
+        return braceDepth_ == 0 &&
+               (lastSignificant_ == 0 || lastSignificant_ == ';' || lastSignificant_ == '}');
+    }
+
+    void trackDefinitionBoundary(std::string_view text) {
+        for (size_t pos = 0; pos < text.size(); ++pos) {
+            char c = text[pos];
+            if (c == '"' || c == '\'') {
+                pos = skipQuoted(text, pos) - 1;
+            } else if (c == '{') {
+                ++braceDepth_;
+            } else if (c == '}') {
+                --braceDepth_;
+            }
+            if (!isSpace(c)) lastSignificant_ = c;
+        }
+    }
+
+    /**
+     * @brief Check that importing a header gives the same result as reading it
+     */
+    bool canImport(const MacroState& header) const {
+        if (!header.includeOnce) {
+            return false;
+        }
+        for (const auto& [name, macro] : macros_) {
+            if (header.undefinedLookups.count(std::string(name)) != 0) return false;
+        }
+        for (const auto& name : header.predefinedLookups) {
+            auto it = macros_.find(name);
+            if (it == macros_.end() || !it->second->predefined) return false;
+        }
+        // Each file may reach the output once: a file the header reads as
+        // text must be new here, and one it imports must be new or come
+        // from the same parsed header, still guarded as in the header
+        for (const auto& file : header.files) {
+            auto it = files_.find(file.canonical);
+            if (it == files_.end()) {
+                if (file.owner != IncludedFile::kTextual && macros_.count(file.guard) != 0) {
+                    return false;
+                }
+            } else if (file.owner == IncludedFile::kTextual || it->second != file.owner ||
+                       (!file.guard.empty() && macros_.count(file.guard) == 0)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void importMacros(const MacroState& header, const std::string& canonical, uint32_t id) {
+        for (const auto& macro : header.macros) {
+            addMacro(std::make_unique<Macro>(macro));
+        }
+        for (const auto& name : header.removed) {
+            macros_.erase(name);
+        }
+        includeGuards_.insert(header.includeGuards.begin(), header.includeGuards.end());
+        onceFiles_.insert(header.onceFiles.begin(), header.onceFiles.end());
+        if (!header.guard.empty()) includeGuards_[canonical] = header.guard;
+        if (header.pragmaOnce) onceFiles_.insert(canonical);
+
+        // This run now depends on whatever the header depended on, except
+        // the header's own guard, which was checked by the include itself
+        files_.emplace(canonical, id);
+        for (const auto& file : header.files) {
+            files_.emplace(file.canonical,
+                           file.owner == IncludedFile::kTextual ? id : file.owner);
+        }
+        for (const auto& name : header.undefinedLookups) {
+            if (name != header.guard) state_.undefinedLookups.insert(name);
+        }
+        state_.predefinedLookups.insert(header.predefinedLookups.begin(),
+                                        header.predefinedLookups.end());
+        state_.fileHashes.insert(state_.fileHashes.end(), header.fileHashes.begin(),
+                                 header.fileHashes.end());
+        state_.files.push_back({canonical, header.guard, id});
+        for (const auto& file : header.files) {
+            state_.files.push_back({file.canonical, file.guard,
+                                    file.owner == IncludedFile::kTextual ? id : file.owner});
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Macro expansion
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Append a text line, expanding macros only if it names one
+     * @return Number of newlines written as part of the line
+     */
+    unsigned expandLine(std::string_view line) {
+        bool hasMacro = false;
+        for (size_t pos = 0; pos < line.size() && !hasMacro;) {
+            char c = line[pos];
+            if (isIdentStart(c)) {
+                std::string_view word = readIdentifier(line, pos);
+                hasMacro = isDefined(word);
+            } else if (isDigit(c)) {
+                while (pos < line.size() && isIdentChar(line[pos])) ++pos;
+            } else if (c == '"' || c == '\'') {
+                pos = skipQuoted(line, pos);
+            } else {
+                ++pos;
+            }
+        }
+
+        size_t start = out_.size();
+        if (hasMacro) {
+            TokenList tokens = tokenize(line);
+            expandTokens(tokens);
+            appendTokens(out_, tokens);
+        } else {
+            out_ += line;
+        }
+        if (handler_) {
+            trackDefinitionBoundary(std::string_view(out_).substr(start));
+        }
+        return static_cast<unsigned>(std::count(out_.begin() + static_cast<std::ptrdiff_t>(start),
+                                                out_.end(), '\n'));
+    }
+
+    static bool inHideSet(const PPToken& tok, std::string_view name) {
+        return std::find(tok.hideSet.begin(), tok.hideSet.end(), name) != tok.hideSet.end();
+    }
+
+    /**
+     * @brief Fully macro-expand a token list in place
+     *
+     * Each replacement is spliced back into the list and rescanned. Tokens
+     * produced by a macro carry it in their hide set so that recursive
+     * references are left unexpanded.
+     */
+    void expandTokens(TokenList& tokens) {
+        size_t i = 0;
+        while (i < tokens.size()) {
+            PPToken& tok = tokens[i];
+            if (tok.kind != PPTokenKind::Identifier) {
+                ++i;
+                continue;
+            }
+
+            if (tok.text == "__FILE__") {
+                tok = {PPTokenKind::Literal, "\"" + file_->name + "\"", {}};
+                ++i;
+                continue;
+            }
+            if (tok.text == "__LINE__") {
+                tok = {PPTokenKind::Number, std::to_string(presumedLine()), {}};
+                ++i;
+                continue;
+            }
+
+            const Macro* macro = findMacro(tok.text);
+            if (!macro || inHideSet(tok, macro->name)) {
+                ++i;
+                continue;
+            }
+
+            std::vector<std::string_view> hideSet = tok.hideSet;
+            hideSet.push_back(macro->name);
+
+            size_t end = i + 1;
+            std::vector<TokenList> args;
+            if (macro->functionLike) {
+                size_t open = skipSpaces(tokens, i + 1);
+                if (open >= tokens.size() || !tokens[open].is("(")) {
+                    ++i;  // Name without arguments is not an invocation
+                    continue;
+                }
+                end = collectArguments(tokens, open, *macro, args);
+            }
+
+            TokenList replacement = substitute(*macro, args);
+            for (auto& t : replacement) {
+                t.hideSet.insert(t.hideSet.end(), hideSet.begin(), hideSet.end());
+            }
+            tokens.erase(tokens.begin() + static_cast<std::ptrdiff_t>(i),
+                         tokens.begin() + static_cast<std::ptrdiff_t>(end));
+            tokens.insert(tokens.begin() + static_cast<std::ptrdiff_t>(i),
+                          std::make_move_iterator(replacement.begin()),
+                          std::make_move_iterator(replacement.end()));
+        }
+    }
+
+    /**
+     * @brief Collect the arguments of a function-like macro invocation
+     * @return Index one past the closing parenthesis
+     */
+    size_t collectArguments(const TokenList& tokens, size_t open, const Macro& macro,
+                            std::vector<TokenList>& args) {
+        args.emplace_back();
+        int depth = 0;
+        size_t i = open + 1;
+        for (; i < tokens.size(); ++i) {
+            const PPToken& tok = tokens[i];
+            if (tok.is("(")) {
+                ++depth;
+            } else if (tok.is(")")) {
+                if (depth == 0) break;
+                --depth;
+            } else if (tok.is(",") && depth == 0 &&
+                       !(macro.variadic && args.size() == macro.params.size())) {
+                args.emplace_back();
+                continue;
+            }
+            args.back().push_back(tok);
+        }
+        if (i >= tokens.size()) {
+            fail("unterminated argument list invoking macro \"" + macro.name + "\"");
+        }
+
+        for (auto& arg : args) trimSpaces(arg);
+        if (macro.params.empty() && args.size() == 1 && args[0].empty()) {
+            args.clear();
+        }
+        if (macro.variadic && args.size() == macro.params.size() - 1) {
+            args.emplace_back();  // Empty variable argument list
+        }
+        if (args.size() != macro.params.size()) {
+            fail("macro \"" + macro.name + "\" requires " + std::to_string(macro.params.size()) +
+                 " arguments, but " + std::to_string(args.size()) + " given");
+        }
+        return i + 1;
+    }
+
+    static PPToken stringize(const TokenList& arg) {
+        std::string text = "\"";
+        for (const auto& tok : arg) {
+            if (tok.kind == PPTokenKind::Literal) {
+                for (char c : tok.text) {
+                    if (c == '"' || c == '\\') text += '\\';
+                    text += c;
+                }
+            } else if (tok.kind == PPTokenKind::Space) {
+                text += ' ';
+            } else {
+                text += tok.text;
+            }
+        }
+        text += '"';
+        return {PPTokenKind::Literal, std::move(text), {}};
+    }
+
+    /**
+     * @brief Join two tokens with the ## operator
+     */
+    void paste(TokenList& result, const TokenList& rhs) {
+        while (!result.empty() && result.back().kind == PPTokenKind::Space) result.pop_back();
+        if (rhs.empty()) return;
+        if (result.empty()) {
+            result.insert(result.end(), rhs.begin(), rhs.end());
+            return;
+        }
+
+        std::string joined = result.back().text + rhs.front().text;
+        TokenList pasted = tokenize(joined);
+        if (pasted.size() != 1) {
+            fail("pasting \"" + result.back().text + "\" and \"" + rhs.front().text +
+                 "\" does not give a valid preprocessing token");
+        }
+        result.back() = std::move(pasted.front());
+        result.insert(result.end(), rhs.begin() + 1, rhs.end());
+    }
+
+    /**
+     * @brief Replace a macro invocation with its body, substituting arguments
+     */
+    TokenList substitute(const Macro& macro, const std::vector<TokenList>& args) {
+        TokenList result;
+        const TokenList& body = macro.body;
+
+        for (size_t b = 0; b < body.size(); ++b) {
+            const PPToken& tok = body[b];
+
+            if (tok.is("##")) {
+                size_t next = skipSpaces(body, b + 1);
+                if (b == 0 || next >= body.size()) {
+                    fail("'##' cannot appear at either end of a macro expansion");
+                }
+                int index = macro.paramIndex(body[next]);
+                paste(result, index >= 0 ? args[static_cast<size_t>(index)] : TokenList{body[next]});
+                b = next;
+                continue;
+            }
+
+            if (macro.functionLike && tok.is("#")) {
+                size_t next = skipSpaces(body, b + 1);
+                int index = next < body.size() ? macro.paramIndex(body[next]) : -1;
+                if (index < 0) {
+                    fail("'#' is not followed by a macro parameter");
+                }
+                result.push_back(stringize(args[static_cast<size_t>(index)]));
+                b = next;
+                continue;
+            }
+
+            int index = macro.paramIndex(tok);
+            if (index >= 0) {
+                const TokenList& arg = args[static_cast<size_t>(index)];
+                size_t next = skipSpaces(body, b + 1);
+                if (next < body.size() && body[next].is("##")) {
+                    result.insert(result.end(), arg.begin(), arg.end());
+                } else {
+                    TokenList expanded = arg;
+                    expandTokens(expanded);
+                    result.insert(result.end(), expanded.begin(), expanded.end());
+                }
+                continue;
+            }
+
+            result.push_back(tok);
+        }
+        return result;
+    }
+
+    // ------------------------------------------------------------------------
+    // #if
+    // ------------------------------------------------------------------------
+
+    bool evaluateCondition(std::string_view expression) {
+        TokenList tokens = tokenize(expression);
+
+        // Resolve defined(X) before macro expansion can rewrite X
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            if (tokens[i].kind != PPTokenKind::Identifier || tokens[i].text != "defined") {
+                continue;
+            }
+            size_t j = skipSpaces(tokens, i + 1);
+            bool paren = j < tokens.size() && tokens[j].is("(");
+            if (paren) j = skipSpaces(tokens, j + 1);
+            if (j >= tokens.size() || tokens[j].kind != PPTokenKind::Identifier) {
+                fail("operator \"defined\" requires an identifier");
+            }
+            bool defined = isDefined(tokens[j].text);
+            if (paren) {
+                j = skipSpaces(tokens, j + 1);
+                if (j >= tokens.size() || !tokens[j].is(")")) {
+                    fail("missing ')' after \"defined\"");
+                }
+            }
+            tokens[i] = {PPTokenKind::Number, defined ? "1" : "0", {}};
+            tokens.erase(tokens.begin() + static_cast<std::ptrdiff_t>(i) + 1,
+                         tokens.begin() + static_cast<std::ptrdiff_t>(j) + 1);
+        }
+
+        expandTokens(tokens);
+        try {
+            return ExpressionEvaluator(tokens).evaluate() != 0;
+        } catch (const PreprocessError& e) {
+            fail(e.what());
+        }
+    }
+};
+
+PreprocessResult runProcessor(const std::vector<std::string>& includePaths,
+                              const std::vector<std::pair<std::string, std::string>>& defines,
+                              IncludeHandler* handler,
+                              std::string_view text, const std::string& filename) {
+    PreprocessResult result;
+    try {
+        Processor processor(includePaths, handler);
+        for (const auto& [name, value] : defines) {
+            processor.define(name, value);
+        }
+        processor.processMain(text, filename);
+        result.success = true;
+        result.output = processor.takeOutput();
+        result.warnings = processor.takeWarnings();
+        result.macroState = processor.takeState();
+        result.fileHashes = result.macroState->fileHashes;
+    } catch (const PreprocessError& e) {
+        result.success = false;
+        result.exitCode = 1;
+        result.errorMessage = e.what();
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+bool isShareableHeader(const MacroState& state) {
+    return state.includeOnce;
+}
+
+std::vector<std::string> includedFiles(const MacroState& state) {
+    std::vector<std::string> files;
+    files.reserve(state.files.size());
+    for (const auto& file : state.files) {
+        files.push_back(file.canonical);
+    }
+    return files;
+}
+
+void BuiltinPreprocessor::addIncludePath(const std::string& path) {
+    includePaths_.push_back(path);
+}
+
+void BuiltinPreprocessor::addDefine(const std::string& name, const std::string& value) {
+    defines_.emplace_back(name, value);
+}
+
+PreprocessResult BuiltinPreprocessor::preprocessFile(const std::string& inputFile) const {
+    std::unique_ptr<source::SourceBuffer> buffer;
+    try {
+        buffer = source::SourceBuffer::fromFile(inputFile);
+    } catch (const std::exception&) {
+        PreprocessResult result;
+        result.success = false;
+        result.errorMessage = "Input file not found: " + inputFile;
+        return result;
+    }
+    return runProcessor(includePaths_, defines_, includeHandler_, buffer->data(), inputFile);
+}
+
+PreprocessResult BuiltinPreprocessor::preprocessString(const std::string& content,
+                                                       const std::string& filename) const {
+    return runProcessor(includePaths_, defines_, includeHandler_, content, filename);
+}
+
+} // namespace iborb::preprocessor
@@ -0,0 +1,126 @@
+#ifndef IBORB_IDL_BUILTIN_PREPROCESSOR_HPP
+#define IBORB_IDL_BUILTIN_PREPROCESSOR_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "preprocessor/preprocessor.hpp"
+
+namespace iborb::preprocessor {
+
+/**
+ * @brief Pragma that stands in for an #include of a shared header
+ *
+ * Emitted as `#pragma iborb_import <id>` at the point of the include.
+ */
+inline constexpr std::string_view kImportPragma = "#pragma iborb_import";
+
+/**
+ * @brief Check whether a preprocessed file can be shared as a header
+ *
+ * True when the file is protected by an include guard or `#pragma once`
+ * and ends between top-level definitions.
+ */
+bool isShareableHeader(const MacroState& state);
+
+/**
+ * @brief Canonical paths of the files a preprocessed header read or
+ * imported, directly or not, excluding the header itself
+ */
+std::vector<std::string> includedFiles(const MacroState& state);
+
+/**
+ * @brief A parsed header that can replace a textual #include
+ */
+struct HeaderImport {
+    uint32_t id = 0;                           // Carried by the import pragma
+    std::shared_ptr<const MacroState> macros;  // Macro state the header leaves behind
+};
+
+/**
+ * @brief Supplies previously parsed headers to the preprocessor
+ */
+class IncludeHandler {
+public:
+    virtual ~IncludeHandler() = default;
+
+    /**
+     * @brief Find or build the shared unit for an included file
+     * @param path Path of the file as spelled in line markers
+     * @param canonical Canonical path of the file
+     * @return The header, or std::nullopt to include the file textually
+     */
+    virtual std::optional<HeaderImport> findHeader(const std::string& path,
+                                                   const std::string& canonical) = 0;
+};
+
+/**
+ * @brief In-process IDL preprocessor
+ *
+ * Implements the part of the C preprocessor that IDL files rely on:
+ * `#include` with `-I` search, object- and function-like `#define`,
+ * `#undef`, `#if`/`#ifdef`/`#ifndef`/`#elif`/`#else`/`#endif` with
+ * integer expressions, `#error`, `#warning`, `#line`, and `#pragma`
+ * passthrough. The output carries GCC-style line markers
+ * (`# 1 "file.idl" 1`) that the lexer maps back to the original files.
+ *
+ * Include paths are spelled the same way GCC spells them, so the
+ * locations in diagnostics and generated code match the external
+ * preprocessor. Files protected by an include guard or `#pragma once`
+ * are not reopened once the guard is defined.
+ *
+ * With an IncludeHandler set, a guarded header included between
+ * top-level definitions is replaced by an import pragma when the
+ * handler has a parsed copy of it and the header's expansion cannot be
+ * affected by the macros defined at that point. The header's macros
+ * are then imported as if it had been read.
+ */
+class BuiltinPreprocessor {
+public:
+    BuiltinPreprocessor() = default;
+
+    /**
+     * @brief Add an include directory searched by `#include`
+     */
+    void addIncludePath(const std::string& path);
+
+    /**
+     * @brief Add a macro definition
+     * @param name Macro name, optionally with a parameter list
+     * @param value Replacement text (empty defines the macro as 1)
+     */
+    void addDefine(const std::string& name, const std::string& value = "");
+
+    /**
+     * @brief Set the handler consulted for shared headers (may be nullptr)
+     */
+    void setIncludeHandler(IncludeHandler* handler) { includeHandler_ = handler; }
+
+    /**
+     * @brief Preprocess an IDL file
+     * @param inputFile Path to the input IDL file
+     * @return PreprocessResult containing the preprocessed output or error
+     */
+    PreprocessResult preprocessFile(const std::string& inputFile) const;
+
+    /**
+     * @brief Preprocess IDL content from a string
+     * @param content IDL content to preprocess
+     * @param filename Virtual filename for line markers and relative includes
+     * @return PreprocessResult containing the preprocessed output or error
+     */
+    PreprocessResult preprocessString(const std::string& content,
+                                      const std::string& filename = "<stdin>") const;
+
+private:
+    std::vector<std::string> includePaths_;
+    std::vector<std::pair<std::string, std::string>> defines_;
+    IncludeHandler* includeHandler_ = nullptr;
+};
+
+} // namespace iborb::preprocessor
+
+#endif // IBORB_IDL_BUILTIN_PREPROCESSOR_HPP
@@ -21,6 +21,8 @@ namespace iborb::preprocessor {
 
 Preprocessor::Preprocessor() 
     : compilerPath_(detectCompiler()) {
+    // detectCompiler() only returns compilers it found on the PATH
+    available_ = !compilerPath_.empty();
 }
 
 Preprocessor::Preprocessor(std::string compilerPath)
@@ -96,7 +98,10 @@ PreprocessResult Preprocessor::preprocessString(const std::string& content,
 }
 
 bool Preprocessor::isAvailable() const {
-    return !compilerPath_.empty() && commandExists(compilerPath_);
+    if (!available_) {
+        available_ = !compilerPath_.empty() && commandExists(compilerPath_);
+    }
+    return *available_;
 }
 
 std::string Preprocessor::buildCommand(const std::string& inputFile) const {
@@ -195,6 +200,12 @@ PreprocessResult Preprocessor::executeCommand(const std::string& command) const
 }
 
 std::string Preprocessor::detectCompiler() {
+    // Probing spawns a shell per candidate, so do it once per process
+    static const std::string detected = findCompiler();
+    return detected;
+}
+
+std::string Preprocessor::findCompiler() {
     // Try compilers in order of preference
     static const std::vector<std::string> candidates = {
 #ifdef _WIN32
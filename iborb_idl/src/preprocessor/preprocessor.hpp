@@ -1,12 +1,16 @@
 #ifndef IBORB_IDL_PREPROCESSOR_HPP
 #define IBORB_IDL_PREPROCESSOR_HPP
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
+#include "cache/content_hash.hpp"
 
 namespace iborb::preprocessor {
 
+struct MacroState;
+
 /**
  * @brief Result of preprocessing operation
  */
@@ -14,6 +18,9 @@ struct PreprocessResult {
     bool success = false;
     std::string output;
     std::string errorMessage;
+    std::vector<std::string> warnings;  // Diagnostics that did not stop preprocessing
+    std::shared_ptr<const MacroState> macroState;  // Set by BuiltinPreprocessor only
+    std::vector<cache::FileHash> fileHashes;  // Every file read, through imports too; BuiltinPreprocessor only
     int exitCode = 0;
 };
 
@@ -21,7 +28,8 @@ struct PreprocessResult {
  * @brief Cross-platform preprocessor wrapper
  * 
  * Uses the system's GCC or Clang preprocessor to handle #include
- * directives and macro expansion before IDL parsing.
+ * directives and macro expansion before IDL parsing. This is the
+ * fallback for inputs the BuiltinPreprocessor cannot handle.
  */
 class Preprocessor {
 public:
@@ -78,6 +86,7 @@ private:
     std::string compilerPath_;
     std::vector<std::string> includePaths_;
     std::vector<std::pair<std::string, std::string>> defines_;
+    mutable std::optional<bool> available_;  // Cached result of isAvailable()
 
     /**
      * @brief Build the preprocessor command line
@@ -90,10 +99,15 @@ private:
     PreprocessResult executeCommand(const std::string& command) const;
 
     /**
-     * @brief Auto-detect available compiler
+     * @brief Auto-detect available compiler (probed once per process)
      */
     static std::string detectCompiler();
 
+    /**
+     * @brief Probe the candidate compilers in order of preference
+     */
+    static std::string findCompiler();
+
     /**
      * @brief Check if a command exists on the system
      */
@@ -0,0 +1,303 @@
+#include "semantic/analyzer.hpp"
+#include "ast/static_visitor.hpp"
+#include "semantic/const_evaluator.hpp"
+#include "semantic/type_resolver.hpp"
+#include "driver/worker_pool.hpp"
+#include "source/source_manager.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace iborb::semantic {
+
+using namespace ast;
+
+namespace {
+
+/**
+ * @brief Enters the definitions of a subtree into a symbol table
+ *
+ * Also gives every definition its fully qualified name.
+ */
+class SymbolCollector : public StaticVisitor<SymbolCollector> {
+public:
+    SymbolCollector(SymbolTable& symbols, std::vector<const ConstNode*>& constants)
+        : symbols_(symbols), constants_(constants) {}
+
+    void visit(ModuleNode& node) {
+        symbols_.addSymbol(node.name, SymbolKind::Module, &node);
+        symbols_.enterScope(node.name);
+        node.fullyQualifiedName = symbols_.getCurrentScopeName();
+        for (auto* def : node.definitions) {
+            dispatch(*def);
+        }
+        symbols_.leaveScope();
+    }
+
+    void visit(InterfaceNode& node) {
+        symbols_.addSymbol(node.name, SymbolKind::Interface, &node);
+        node.fullyQualifiedName = symbols_.buildFullyQualifiedName(node.name);
+        if (node.isForward) {
+            return;
+        }
+        symbols_.enterScope(node.name);
+        for (auto* content : node.contents) {
+            dispatch(*content);
+        }
+        symbols_.leaveScope();
+    }
+
+    void visit(OperationNode& node) {
+        node.fullyQualifiedName = symbols_.buildFullyQualifiedName(node.name);
+        symbols_.addSymbol(node.name, SymbolKind::Operation, &node);
+    }
+
+    void visit(AttributeNode& node) {
+        symbols_.addSymbol(node.name, SymbolKind::Attribute, &node);
+        node.fullyQualifiedName = symbols_.buildFullyQualifiedName(node.name);
+    }
+
+    void visit(StructNode& node) {
+        enterDefinition(node, SymbolKind::Struct);
+        symbols_.leaveScope();
+    }
+
+    void visit(TypedefNode& node) {
+        for (const auto& declarator : node.declarators) {
+            symbols_.addSymbol(declarator.name, SymbolKind::Typedef, &node);
+        }
+        node.fullyQualifiedName = symbols_.buildFullyQualifiedName(node.name);
+    }
+
+    void visit(EnumNode& node) {
+        symbols_.addSymbol(node.name, SymbolKind::Enum, &node);
+        node.fullyQualifiedName = symbols_.buildFullyQualifiedName(node.name);
+        for (Name value : node.enumerators) {
+            symbols_.addSymbol(value, SymbolKind::EnumValue);
+        }
+    }
+
+    void visit(ConstNode& node) {
+        symbols_.addSymbol(node.name, SymbolKind::Constant, &node);
+        node.fullyQualifiedName = symbols_.buildFullyQualifiedName(node.name);
+        constants_.push_back(&node);
+    }
+
+    void visit(ExceptionNode& node) {
+        enterDefinition(node, SymbolKind::Exception);
+        symbols_.leaveScope();
+    }
+
+    void visit(UnionNode& node) {
+        enterDefinition(node, SymbolKind::Union);
+        symbols_.leaveScope();
+    }
+
+    // Members, parameters, cases and types declare nothing
+    void visit(ParameterNode&) {}
+    void visit(StructMemberNode&) {}
+    void visit(UnionCaseNode&) {}
+    void visit(BasicTypeNode&) {}
+    void visit(SequenceTypeNode&) {}
+    void visit(StringTypeNode&) {}
+    void visit(ScopedNameNode&) {}
+    void visit(ArrayTypeNode&) {}
+
+private:
+    SymbolTable& symbols_;
+    std::vector<const ConstNode*>& constants_;
+
+    // Add a definition and open its scope, as members may be looked up in it
+    void enterDefinition(DefinitionNode& node, SymbolKind kind) {
+        symbols_.addSymbol(node.name, kind, &node);
+        symbols_.enterScope(node.name);
+        node.fullyQualifiedName = symbols_.getCurrentScopeName();
+    }
+};
+
+/**
+ * @brief Fold the constants of a subtree, in declaration order
+ * @param scope Scope that encloses the definition
+ */
+void foldConstants(DefinitionNode& def, const Scope& scope, ConstEvaluator& evaluator,
+                   std::unordered_set<const ConstNode*>& unfolded) {
+    if (auto* constNode = dyn_cast<ConstNode>(&def)) {
+        if (constNode->expr) {
+            constNode->value = evaluator.evaluate(*constNode->expr, scope);
+        }
+        unfolded.erase(constNode);
+        return;
+    }
+
+    // Constants can only be declared in modules and interfaces
+    const ASTList<DefinitionNode>* children = nullptr;
+    if (auto* module = dyn_cast<ModuleNode>(&def)) {
+        children = &module->definitions;
+    } else if (auto* iface = dyn_cast<InterfaceNode>(&def)) {
+        children = &iface->contents;
+    }
+    const Scope* inner = children ? scope.getChildScope(def.name) : nullptr;
+    if (!inner) {
+        return;
+    }
+    for (auto* child : *children) {
+        foldConstants(*child, *inner, evaluator, unfolded);
+    }
+}
+
+} // anonymous namespace
+
+Analyzer::Analyzer(const driver::WorkerPool* pool)
+    : pool_(pool) {
+}
+
+template<typename Fn>
+void Analyzer::forEachDefinition(const TranslationUnit& unit, Fn&& fn) const {
+    size_t count = unit.definitions.size();
+    if (pool_ && pool_->size() > 1 && count > 1) {
+        pool_->run(count, fn);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+    }
+}
+
+bool Analyzer::analyze(TranslationUnit& unit,
+                       const std::vector<const SymbolTable*>& importedSymbols) {
+    size_t count = unit.definitions.size();
+
+    // Symbol collection, one table per top-level definition
+    std::vector<SymbolTable> fragments(count);
+    std::vector<std::vector<const ConstNode*>> constants(count);
+    forEachDefinition(unit, [&](size_t i) {
+        SymbolCollector collector(fragments[i], constants[i]);
+        collector.dispatch(*unit.definitions[i]);
+    });
+
+    // Merge in source order; imports come before the definition they precede
+    size_t nextImport = 0;
+    for (size_t i = 0; i <= count; ++i) {
+        for (; nextImport < unit.imports.size() && unit.imports[nextImport].position == i;
+             ++nextImport) {
+            if (nextImport < importedSymbols.size() && importedSymbols[nextImport]) {
+                symbols_.merge(*importedSymbols[nextImport]);
+            }
+        }
+        if (i < count) {
+            symbols_.merge(std::move(fragments[i]));
+        }
+    }
+
+    // Constants may refer to constants of earlier definitions, so they
+    // are folded in one pass over the whole unit
+    std::vector<std::vector<Diagnostic>> found(count);
+    std::unordered_set<const ConstNode*> unfolded;
+    for (const auto& list : constants) {
+        unfolded.insert(list.begin(), list.end());
+    }
+    if (!unfolded.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            ConstEvaluator evaluator(symbols_, found[i]);
+            evaluator.setUnfolded(&unfolded);
+            foldConstants(*unit.definitions[i], *symbols_.getGlobalScope(), evaluator, unfolded);
+        }
+    }
+
+    // Type resolution only reads the merged table
+    forEachDefinition(unit, [&](size_t i) {
+        TypeResolver resolver(symbols_, found[i]);
+        resolver.resolve(*unit.definitions[i], *symbols_.getGlobalScope());
+    });
+
+    for (auto& list : found) {
+        report(list, unit.sourceManager.get());
+    }
+    return !hasErrors();
+}
+
+void Analyzer::addImportedSymbols(const SymbolTable& symbols) {
+    symbols_.merge(symbols);
+}
+
+void Analyzer::beginModule(Name name) {
+    symbols_.addSymbol(name, SymbolKind::Module);
+    symbols_.enterScope(name);
+}
+
+void Analyzer::endModule() {
+    symbols_.leaveScope();
+}
+
+Name Analyzer::getCurrentScopeName() const {
+    return symbols_.getCurrentScopeName();
+}
+
+bool Analyzer::analyzeDefinition(DefinitionNode& definition,
+                                 const source::SourceManager* sourceManager) {
+    Scope& scope = *symbols_.getCurrentScope();
+
+    std::vector<const ConstNode*> constants;
+    SymbolCollector collector(symbols_, constants);
+    collector.dispatch(definition);
+
+    std::vector<Diagnostic> found;
+    if (!constants.empty()) {
+        std::unordered_set<const ConstNode*> unfolded(constants.begin(), constants.end());
+        ConstEvaluator evaluator(symbols_, found);
+        evaluator.setUnfolded(&unfolded);
+        foldConstants(definition, scope, evaluator, unfolded);
+        retainConstants(constants, scope, definition);
+    }
+
+    TypeResolver resolver(symbols_, found);
+    resolver.resolve(definition, scope);
+
+    bool ok = std::none_of(found.begin(), found.end(),
+                           [](const Diagnostic& diagnostic) { return !diagnostic.isWarning; });
+    report(found, sourceManager);
+    return ok;
+}
+
+void Analyzer::retainConstants(const std::vector<const ConstNode*>& constants, Scope& scope,
+                               const DefinitionNode& definition) {
+    // Constants are declared directly in the definition's scope, or in
+    // the scope of an interface
+    Scope* inner = scope.getChildScope(definition.name);
+    for (const ConstNode* constNode : constants) {
+        auto* copy = retained_.create<ConstNode>(constNode->name, nullptr, nullptr,
+                                                 constNode->location);
+        copy->value = constNode->value;
+        copy->fullyQualifiedName = constNode->fullyQualifiedName;
+        for (Scope* owner : {&scope, inner}) {
+            if (!owner) {
+                continue;
+            }
+            auto it = owner->symbols.find(constNode->name);
+            if (it != owner->symbols.end() && it->second.node == constNode) {
+                it->second.node = copy;
+            }
+        }
+    }
+}
+
+void Analyzer::report(std::vector<Diagnostic>& found, const source::SourceManager* sourceManager) {
+    for (auto& diagnostic : found) {
+        if (sourceManager) {
+            diagnostic.message = sourceManager->format(diagnostic.location) +
+                                 (diagnostic.isWarning ? ": warning: " : ": error: ") +
+                                 diagnostic.message;
+        }
+        diagnostics_.push_back(std::move(diagnostic));
+    }
+}
+
+bool Analyzer::hasErrors() const {
+    for (const auto& diagnostic : diagnostics_) {
+        if (!diagnostic.isWarning) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace iborb::semantic
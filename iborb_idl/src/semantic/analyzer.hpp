@@ -0,0 +1,126 @@
+#ifndef IBORB_IDL_ANALYZER_HPP
+#define IBORB_IDL_ANALYZER_HPP
+
+#include <vector>
+#include "ast/ast.hpp"
+#include "semantic/diagnostic.hpp"
+#include "semantic/symbol_table.hpp"
+
+namespace iborb::driver {
+class WorkerPool;
+}
+
+namespace iborb::source {
+class SourceManager;
+}
+
+namespace iborb::semantic {
+
+/**
+ * @brief Semantic analysis of a parsed translation unit
+ *
+ * Runs on the purely syntactic tree built by parser::Parser:
+ * 1. Symbol collection: each top-level definition is entered into a
+ *    table of its own, and its nodes get their fully qualified names.
+ * 2. Merge: the tables are merged in source order, together with the
+ *    symbols of imported headers, as if everything had been declared
+ *    in one pass.
+ * 3. Constant folding, in declaration order, so that a constant only
+ *    sees the constants declared before it.
+ * 4. Type resolution (see TypeResolver), which also folds bounds,
+ *    array dimensions and union case labels.
+ *
+ * Steps 1 and 4 work on each top-level definition independently and
+ * run in parallel when a worker pool is given. Imported units are
+ * analyzed before they are shared and are not visited again.
+ *
+ * A unit that is streamed instead (see parser::DefinitionSink) is
+ * analyzed one definition at a time with analyzeDefinition(), which
+ * runs the same steps serially in the scope opened by beginModule().
+ * The caller may release a definition afterwards: the symbols stay,
+ * and the constants it declared are copied, but no other symbol's
+ * node may be followed once its definition is gone.
+ */
+class Analyzer {
+public:
+    /**
+     * @param pool Runs the per-definition steps in parallel (may be nullptr)
+     */
+    explicit Analyzer(const driver::WorkerPool* pool = nullptr);
+
+    /**
+     * @brief Analyze a unit
+     * @param importedSymbols Symbols of unit.imports, in the same order
+     * @return true if no errors were found
+     */
+    bool analyze(ast::TranslationUnit& unit,
+                 const std::vector<const SymbolTable*>& importedSymbols);
+
+    /**
+     * @brief Add the symbols of an imported header to a streamed unit
+     */
+    void addImportedSymbols(const SymbolTable& symbols);
+
+    /**
+     * @brief Open a module of a streamed unit
+     */
+    void beginModule(ast::Name name);
+
+    /**
+     * @brief Close the module opened last
+     */
+    void endModule();
+
+    /**
+     * @brief Get the fully qualified name of the module currently open
+     */
+    ast::Name getCurrentScopeName() const;
+
+    /**
+     * @brief Analyze one definition of a streamed unit
+     *
+     * Lookups see the definitions analyzed so far, which is everything
+     * IDL allows a definition to refer to.
+     *
+     * @param sourceManager Formats the locations of diagnostics (may be nullptr)
+     * @return true if no errors were found in the definition
+     */
+    bool analyzeDefinition(ast::DefinitionNode& definition,
+                           const source::SourceManager* sourceManager);
+
+    /**
+     * @brief Get the symbols of the unit, including imported ones
+     */
+    SymbolTable& getSymbolTable() { return symbols_; }
+    const SymbolTable& getSymbolTable() const { return symbols_; }
+
+    /**
+     * @brief Get all errors and warnings, with locations, in source order
+     */
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics_; }
+
+    /**
+     * @brief Check if any errors occurred
+     */
+    bool hasErrors() const;
+
+private:
+    const driver::WorkerPool* pool_;
+    SymbolTable symbols_;
+    std::vector<Diagnostic> diagnostics_;
+    ast::Arena retained_;  // Constants of streamed definitions
+
+    // Copy the constants of a streamed definition and point their symbols at the copies
+    void retainConstants(const std::vector<const ast::ConstNode*>& constants, Scope& scope,
+                         const ast::DefinitionNode& definition);
+
+    // Prefix diagnostics with their locations and keep them
+    void report(std::vector<Diagnostic>& found, const source::SourceManager* sourceManager);
+
+    template<typename Fn>
+    void forEachDefinition(const ast::TranslationUnit& unit, Fn&& fn) const;
+};
+
+} // namespace iborb::semantic
+
+#endif // IBORB_IDL_ANALYZER_HPP
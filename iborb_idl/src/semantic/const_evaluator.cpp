@@ -0,0 +1,143 @@
+#include "semantic/const_evaluator.hpp"
+#include <type_traits>
+
+namespace iborb::semantic {
+
+using namespace ast;
+
+namespace {
+
+using Op = ConstExpr::Op;
+
+// Apply an operator that is defined on integers only
+ConstValue foldInteger(Op op, const ConstValue& left, const ConstValue& right) {
+    auto* l = std::get_if<int64_t>(&left);
+    auto* r = std::get_if<int64_t>(&right);
+    if (!l || !r) {
+        return left;
+    }
+    switch (op) {
+        case Op::Or:         return *l | *r;
+        case Op::Xor:        return *l ^ *r;
+        case Op::And:        return *l & *r;
+        case Op::ShiftLeft:  return *l << *r;
+        case Op::ShiftRight: return *l >> *r;
+        case Op::Modulo:     return *r != 0 ? ConstValue(*l % *r) : left;
+        default:             return left;
+    }
+}
+
+// Apply an arithmetic operator to two integers or two floating point values
+ConstValue foldArithmetic(Op op, const ConstValue& left, const ConstValue& right) {
+    if (auto* l = std::get_if<int64_t>(&left)) {
+        auto* r = std::get_if<int64_t>(&right);
+        if (!r) {
+            return left;
+        }
+        switch (op) {
+            case Op::Add:      return *l + *r;
+            case Op::Subtract: return *l - *r;
+            case Op::Multiply: return *l * *r;
+            case Op::Divide:   return *r != 0 ? ConstValue(*l / *r) : left;
+            default:           return left;
+        }
+    }
+    if (auto* l = std::get_if<double>(&left)) {
+        auto* r = std::get_if<double>(&right);
+        if (!r) {
+            return left;
+        }
+        switch (op) {
+            case Op::Add:      return *l + *r;
+            case Op::Subtract: return *l - *r;
+            case Op::Multiply: return *l * *r;
+            case Op::Divide:   return *l / *r;
+            default:           return left;
+        }
+    }
+    return left;
+}
+
+} // anonymous namespace
+
+ConstEvaluator::ConstEvaluator(const SymbolTable& symbols, std::vector<Diagnostic>& diagnostics)
+    : symbols_(symbols), diagnostics_(diagnostics) {
+}
+
+ConstValue ConstEvaluator::evaluate(const ConstExpr& expr, const Scope& scope) {
+    switch (expr.op) {
+        case Op::Literal:
+            return std::visit([](auto value) -> ConstValue {
+                if constexpr (std::is_same_v<decltype(value), std::string_view>) {
+                    return std::string(value);
+                } else {
+                    return value;
+                }
+            }, expr.literal);
+
+        case Op::Name:
+            return evaluateName(expr, scope);
+
+        case Op::Negate: {
+            ConstValue value = evaluate(*expr.lhs, scope);
+            if (auto* v = std::get_if<int64_t>(&value)) {
+                return -(*v);
+            }
+            if (auto* v = std::get_if<double>(&value)) {
+                return -(*v);
+            }
+            return value;
+        }
+
+        case Op::Complement: {
+            ConstValue value = evaluate(*expr.lhs, scope);
+            if (auto* v = std::get_if<int64_t>(&value)) {
+                return ~(*v);
+            }
+            return value;
+        }
+
+        case Op::Add:
+        case Op::Subtract:
+        case Op::Multiply:
+        case Op::Divide:
+            return foldArithmetic(expr.op, evaluate(*expr.lhs, scope), evaluate(*expr.rhs, scope));
+
+        default:
+            return foldInteger(expr.op, evaluate(*expr.lhs, scope), evaluate(*expr.rhs, scope));
+    }
+}
+
+std::optional<size_t> ConstEvaluator::evaluateSize(const ConstExpr& expr, const Scope& scope) {
+    ConstValue value = evaluate(expr, scope);
+    if (auto* v = std::get_if<int64_t>(&value)) {
+        return static_cast<size_t>(*v);
+    }
+    if (auto* v = std::get_if<uint64_t>(&value)) {
+        return static_cast<size_t>(*v);
+    }
+    return std::nullopt;
+}
+
+ConstValue ConstEvaluator::evaluateName(const ConstExpr& expr, const Scope& scope) {
+    parts_.assign(expr.parts.begin(), expr.parts.end());
+    if (const Symbol* sym = symbols_.lookupScoped(parts_, expr.isAbsolute, scope)) {
+        if (sym->kind == SymbolKind::Constant && sym->node) {
+            auto* constNode = static_cast<const ConstNode*>(sym->node);
+            if (!unfolded_ || !unfolded_->count(constNode)) {
+                return constNode->value;
+            }
+        }
+        if (sym->kind == SymbolKind::EnumValue) {
+            // Return the enum value index (simplified)
+            return int64_t(0);
+        }
+    }
+
+    // Return 0 if not found (simplified error handling)
+    Name last = expr.parts.empty() ? Name() : expr.parts.back();
+    diagnostics_.push_back({"Unknown constant: " + last.str(), expr.location, true});
+    return int64_t(0);
+}
+
+} // namespace iborb::semantic
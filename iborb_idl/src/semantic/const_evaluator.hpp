@@ -0,0 +1,63 @@
+#ifndef IBORB_IDL_CONST_EVALUATOR_HPP
+#define IBORB_IDL_CONST_EVALUATOR_HPP
+
+#include <optional>
+#include <unordered_set>
+#include <vector>
+#include "ast/ast.hpp"
+#include "semantic/diagnostic.hpp"
+#include "semantic/symbol_table.hpp"
+
+namespace iborb::semantic {
+
+/**
+ * @brief Folds constant expressions into values
+ *
+ * Operators apply when both operands have the same numeric type and
+ * otherwise yield the left operand unchanged. Names resolve to the
+ * value of a constant; enumerators fold to 0. Names that do not
+ * resolve to a folded constant are reported as warnings and fold to 0.
+ *
+ * Evaluation only reads the symbol table, so evaluators working on
+ * different parts of a unit can run in parallel.
+ */
+class ConstEvaluator {
+public:
+    /**
+     * @param diagnostics Receives warnings for unknown constants
+     */
+    ConstEvaluator(const SymbolTable& symbols, std::vector<Diagnostic>& diagnostics);
+
+    /**
+     * @brief Treat the given constants as not yet declared
+     *
+     * Used while folding the constants themselves, in declaration
+     * order, so that a constant only sees those declared before it.
+     */
+    void setUnfolded(const std::unordered_set<const ast::ConstNode*>* unfolded) {
+        unfolded_ = unfolded;
+    }
+
+    /**
+     * @brief Fold an expression whose names are looked up from the given scope
+     */
+    ast::ConstValue evaluate(const ast::ConstExpr& expr, const Scope& scope);
+
+    /**
+     * @brief Fold a bound or array dimension
+     * @return The value, or std::nullopt if it is not an integer
+     */
+    std::optional<size_t> evaluateSize(const ast::ConstExpr& expr, const Scope& scope);
+
+private:
+    const SymbolTable& symbols_;
+    std::vector<Diagnostic>& diagnostics_;
+    const std::unordered_set<const ast::ConstNode*>* unfolded_ = nullptr;
+    std::vector<ast::Name> parts_;  // Reused for name lookups
+
+    ast::ConstValue evaluateName(const ast::ConstExpr& expr, const Scope& scope);
+};
+
+} // namespace iborb::semantic
+
+#endif // IBORB_IDL_CONST_EVALUATOR_HPP
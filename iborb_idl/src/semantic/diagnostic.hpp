@@ -0,0 +1,20 @@
+#ifndef IBORB_IDL_DIAGNOSTIC_HPP
+#define IBORB_IDL_DIAGNOSTIC_HPP
+
+#include <string>
+#include "ast/ast.hpp"
+
+namespace iborb::semantic {
+
+/**
+ * @brief Error or warning found during semantic analysis
+ */
+struct Diagnostic {
+    std::string message;  // Prefixed with location and severity by Analyzer
+    ast::SourceLocation location;
+    bool isWarning = false;
+};
+
+} // namespace iborb::semantic
+
+#endif // IBORB_IDL_DIAGNOSTIC_HPP
@@ -4,62 +4,68 @@
 
 namespace iborb::semantic {
 
+namespace {
+
+// Qualify a name with its enclosing scope: "Outer::Inner::name"
+ast::Name qualify(ast::Name scope, ast::Name name) {
+    if (scope.empty()) {
+        return name;
+    }
+    // Reused so that names which are already interned cost no allocation
+    thread_local std::string buffer;
+    buffer.assign(scope.view());
+    buffer += "::";
+    buffer += name.view();
+    return ast::Name::intern(buffer);
+}
+
+// Name hashes are addresses; spread them over the index slots
+size_t indexSlot(ast::Name name, size_t mask) {
+    return (name.hash() * 0x9E3779B97F4A7C15ull >> 16) & mask;
+}
+
+} // anonymous namespace
+
 // ============================================================================
 // Scope Implementation
 // ============================================================================
 
-Scope::Scope(std::string scopeName, Scope* parentScope)
-    : name(std::move(scopeName)), parent(parentScope) {
-    if (parent) {
-        if (parent->fullyQualifiedName.empty()) {
-            fullyQualifiedName = name;
-        } else {
-            fullyQualifiedName = parent->fullyQualifiedName + "::" + name;
-        }
-    } else {
-        fullyQualifiedName = name;
-    }
+Scope::Scope(ast::Name scopeName, Scope* parentScope)
+    : name(scopeName), parent(parentScope) {
+    fullyQualifiedName = parent ? qualify(parent->fullyQualifiedName, name) : name;
 }
 
-bool Scope::addSymbol(const Symbol& symbol) {
+const Symbol* Scope::addSymbol(const Symbol& symbol) {
     auto [it, inserted] = symbols.try_emplace(symbol.name, symbol);
-    return inserted;
+    return inserted ? &it->second : nullptr;
 }
 
-std::optional<Symbol> Scope::lookupLocal(const std::string& symbolName) const {
+const Symbol* Scope::lookupLocal(ast::Name symbolName) const {
     auto it = symbols.find(symbolName);
-    if (it != symbols.end()) {
-        return it->second;
-    }
-    return std::nullopt;
+    return it != symbols.end() ? &it->second : nullptr;
 }
 
-std::optional<Symbol> Scope::lookup(const std::string& symbolName) const {
-    // First check this scope
-    if (auto sym = lookupLocal(symbolName)) {
-        return sym;
-    }
-    // Then check parent scope
-    if (parent) {
-        return parent->lookup(symbolName);
+const Symbol* Scope::lookup(ast::Name symbolName) const {
+    // Check this scope, then its parents
+    for (const Scope* scope = this; scope; scope = scope->parent) {
+        if (const Symbol* sym = scope->lookupLocal(symbolName)) {
+            return sym;
+        }
     }
-    return std::nullopt;
+    return nullptr;
 }
 
-Scope* Scope::createChildScope(const std::string& childName) {
+Scope* Scope::createChildScope(ast::Name childName) {
     auto child = std::make_unique<Scope>(childName, this);
     Scope* ptr = child.get();
     children.push_back(std::move(child));
+    childIndex.emplace(childName, ptr);
     return ptr;
 }
 
-Scope* Scope::getChildScope(const std::string& childName) const {
-    for (const auto& child : children) {
-        if (child->name == childName) {
-            return child.get();
-        }
-    }
-    return nullptr;
+Scope* Scope::getChildScope(ast::Name childName) const {
+    auto it = childIndex.find(childName);
+    return it != childIndex.end() ? it->second : nullptr;
 }
 
 // ============================================================================
@@ -67,11 +73,11 @@ Scope* Scope::getChildScope(const std::string& childName) const {
 // ============================================================================
 
 SymbolTable::SymbolTable() {
-    globalScope_ = std::make_unique<Scope>("", nullptr);
+    globalScope_ = std::make_unique<Scope>();
     currentScope_ = globalScope_.get();
 }
 
-void SymbolTable::enterScope(const std::string& scopeName) {
+void SymbolTable::enterScope(ast::Name scopeName) {
     // Check if the scope already exists (for reopening modules)
     Scope* existing = currentScope_->getChildScope(scopeName);
     if (existing) {
@@ -87,28 +93,76 @@ void SymbolTable::leaveScope() {
     }
 }
 
-bool SymbolTable::addSymbol(const std::string& name, SymbolKind kind, ast::ASTNode* node) {
+bool SymbolTable::addSymbol(ast::Name name, SymbolKind kind, ast::ASTNode* node) {
     Symbol sym;
     sym.name = name;
     sym.kind = kind;
     sym.node = node;
     sym.scope = currentScope_->fullyQualifiedName;
     sym.fullyQualifiedName = buildFullyQualifiedName(name);
-    return currentScope_->addSymbol(sym);
+    return addToScope(*currentScope_, sym) != nullptr;
+}
+
+const Symbol* SymbolTable::addToScope(Scope& scope, const Symbol& symbol) {
+    const Symbol* added = scope.addSymbol(symbol);
+    if (added && !qualifiedIndex_.empty()) {
+        indexSymbol(added);
+    }
+    return added;
+}
+
+void SymbolTable::buildQualifiedIndex(const Scope& scope) const {
+    for (const auto& [symbolName, symbol] : scope.symbols) {
+        indexSymbol(&symbol);
+    }
+    for (const auto& child : scope.children) {
+        buildQualifiedIndex(*child);
+    }
 }
 
-std::optional<Symbol> SymbolTable::lookup(const std::string& name) const {
+void SymbolTable::indexSymbol(const Symbol* symbol) const {
+    // Keep the table at most half full
+    if ((qualifiedCount_ + 1) * 2 > qualifiedIndex_.size()) {
+        std::vector<const Symbol*> old(std::max<size_t>(qualifiedIndex_.size() * 2, 64));
+        old.swap(qualifiedIndex_);
+        qualifiedCount_ = 0;
+        for (const Symbol* indexed : old) {
+            if (indexed) {
+                indexSymbol(indexed);
+            }
+        }
+    }
+
+    size_t mask = qualifiedIndex_.size() - 1;
+    for (size_t slot = indexSlot(symbol->fullyQualifiedName, mask);; slot = (slot + 1) & mask) {
+        if (!qualifiedIndex_[slot]) {
+            qualifiedIndex_[slot] = symbol;
+            ++qualifiedCount_;
+            return;
+        }
+        if (qualifiedIndex_[slot]->fullyQualifiedName == symbol->fullyQualifiedName) {
+            return;
+        }
+    }
+}
+
+const Symbol* SymbolTable::lookup(ast::Name name) const {
     return currentScope_->lookup(name);
 }
 
-std::optional<Symbol> SymbolTable::lookupScoped(const std::vector<std::string>& parts,
-                                                 bool isAbsolute) const {
+const Symbol* SymbolTable::lookupScoped(const std::vector<ast::Name>& parts,
+                                        bool isAbsolute) const {
+    return lookupScoped(parts, isAbsolute, *currentScope_);
+}
+
+const Symbol* SymbolTable::lookupScoped(const std::vector<ast::Name>& parts, bool isAbsolute,
+                                        const Scope& from) const {
     if (parts.empty()) {
-        return std::nullopt;
+        return nullptr;
     }
 
-    // Start from global scope if absolute, otherwise from current scope
-    const Scope* searchScope = isAbsolute ? globalScope_.get() : currentScope_;
+    // Start from global scope if absolute, otherwise from the given scope
+    const Scope* searchScope = isAbsolute ? globalScope_.get() : &from;
 
     // If not absolute, first try to find the first part as a symbol in current/parent scopes
     if (!isAbsolute && parts.size() == 1) {
@@ -117,8 +171,8 @@ std::optional<Symbol> SymbolTable::lookupScoped(const std::vector<std::string>&
 
     // For multi-part names, we need to traverse scopes
     if (!isAbsolute) {
-        // Try to find the first part in current scope hierarchy
-        const Scope* scope = currentScope_;
+        // Try to find the first part in the enclosing scope hierarchy
+        const Scope* scope = &from;
         while (scope) {
             // Check if this scope has a child matching the first part
             Scope* child = scope->getChildScope(parts[0]);
@@ -128,7 +182,7 @@ std::optional<Symbol> SymbolTable::lookupScoped(const std::vector<std::string>&
             }
             // Or if it's a symbol
             if (parts.size() == 1) {
-                if (auto sym = scope->lookupLocal(parts[0])) {
+                if (const Symbol* sym = scope->lookupLocal(parts[0])) {
                     return sym;
                 }
             }
@@ -136,7 +190,7 @@ std::optional<Symbol> SymbolTable::lookupScoped(const std::vector<std::string>&
         }
         if (!scope && parts.size() > 1) {
             // Couldn't find the first part
-            return std::nullopt;
+            return nullptr;
         }
     }
 
@@ -145,7 +199,7 @@ std::optional<Symbol> SymbolTable::lookupScoped(const std::vector<std::string>&
     for (size_t i = (isAbsolute ? 0 : 1); i < parts.size() - 1; ++i) {
         Scope* child = currentSearch->getChildScope(parts[i]);
         if (!child) {
-            return std::nullopt;
+            return nullptr;
         }
         currentSearch = child;
     }
@@ -154,31 +208,94 @@ std::optional<Symbol> SymbolTable::lookupScoped(const std::vector<std::string>&
     return currentSearch->lookupLocal(parts.back());
 }
 
-std::optional<Symbol> SymbolTable::lookupQualified(const std::string& qualifiedName) const {
-    auto parts = parseQualifiedName(qualifiedName);
+const Symbol* SymbolTable::lookupQualified(std::string_view qualifiedName) const {
     bool isAbsolute = qualifiedName.size() >= 2 && 
                       qualifiedName[0] == ':' && qualifiedName[1] == ':';
-    return lookupScoped(parts, isAbsolute);
+    if (isAbsolute) {
+        // Stored names carry no leading "::"
+        ast::Name fqn = ast::Name::find(qualifiedName.substr(2));
+        return fqn.empty() ? nullptr : lookupFullyQualified(fqn);
+    }
+
+    // Reused so that repeated lookups do not allocate
+    thread_local std::vector<ast::Name> parts;
+    if (!parseQualifiedName(qualifiedName, parts)) {
+        return nullptr;
+    }
+    return lookupScoped(parts, false);
 }
 
-std::string SymbolTable::getCurrentScopeName() const {
+const Symbol* SymbolTable::lookupFullyQualified(ast::Name fullyQualifiedName) const {
+    if (qualifiedIndex_.empty()) {
+        buildQualifiedIndex(*globalScope_);
+        if (qualifiedIndex_.empty()) {
+            return nullptr;
+        }
+    }
+    size_t mask = qualifiedIndex_.size() - 1;
+    for (size_t slot = indexSlot(fullyQualifiedName, mask);; slot = (slot + 1) & mask) {
+        const Symbol* symbol = qualifiedIndex_[slot];
+        if (!symbol || symbol->fullyQualifiedName == fullyQualifiedName) {
+            return symbol;
+        }
+    }
+}
+
+ast::Name SymbolTable::getCurrentScopeName() const {
     return currentScope_->fullyQualifiedName;
 }
 
-bool SymbolTable::existsInCurrentScope(const std::string& name) const {
-    return currentScope_->lookupLocal(name).has_value();
+bool SymbolTable::existsInCurrentScope(ast::Name name) const {
+    return currentScope_->lookupLocal(name) != nullptr;
 }
 
-std::string SymbolTable::buildFullyQualifiedName(const std::string& name) const {
-    if (currentScope_->fullyQualifiedName.empty()) {
-        return name;
+ast::Name SymbolTable::buildFullyQualifiedName(ast::Name name) const {
+    return qualify(currentScope_->fullyQualifiedName, name);
+}
+
+void SymbolTable::merge(const SymbolTable& other) {
+    mergeScope(*globalScope_, *other.globalScope_);
+}
+
+void SymbolTable::mergeScope(Scope& target, const Scope& source) {
+    for (const auto& [symbolName, symbol] : source.symbols) {
+        addToScope(target, symbol);
+    }
+    for (const auto& child : source.children) {
+        Scope* existing = target.getChildScope(child->name);
+        mergeScope(existing ? *existing : *target.createChildScope(child->name), *child);
     }
-    return currentScope_->fullyQualifiedName + "::" + name;
 }
 
-std::vector<std::string> SymbolTable::parseQualifiedName(const std::string& name) {
-    std::vector<std::string> parts;
-    std::string current;
+void SymbolTable::merge(SymbolTable&& other) {
+    mergeScope(*globalScope_, std::move(*other.globalScope_));
+    other.globalScope_ = std::make_unique<Scope>();
+    other.currentScope_ = other.globalScope_.get();
+    other.qualifiedIndex_.clear();
+    other.qualifiedCount_ = 0;
+}
+
+void SymbolTable::mergeScope(Scope& target, Scope&& source) {
+    for (const auto& [symbolName, symbol] : source.symbols) {
+        addToScope(target, symbol);
+    }
+    for (auto& child : source.children) {
+        if (Scope* existing = target.getChildScope(child->name)) {
+            mergeScope(*existing, std::move(*child));
+            continue;
+        }
+        // The scope's path, and so its qualified name, is the same here
+        child->parent = &target;
+        target.childIndex.emplace(child->name, child.get());
+        if (!qualifiedIndex_.empty()) {
+            buildQualifiedIndex(*child);
+        }
+        target.children.push_back(std::move(child));
+    }
+}
+
+bool SymbolTable::parseQualifiedName(std::string_view name, std::vector<ast::Name>& parts) {
+    parts.clear();
     
     size_t i = 0;
     // Skip leading ::
@@ -186,24 +303,26 @@ std::vector<std::string> SymbolTable::parseQualifiedName(const std::string& name
         i = 2;
     }
 
-    while (i < name.size()) {
-        if (i + 1 < name.size() && name[i] == ':' && name[i + 1] == ':') {
-            if (!current.empty()) {
-                parts.push_back(current);
-                current.clear();
+    size_t start = i;
+    while (i <= name.size()) {
+        bool atSeparator = i + 1 < name.size() && name[i] == ':' && name[i + 1] == ':';
+        if (i == name.size() || atSeparator) {
+            if (i > start) {
+                // A spelling that was never interned cannot name a symbol
+                ast::Name part = ast::Name::find(name.substr(start, i - start));
+                if (part.empty()) {
+                    return false;
+                }
+                parts.push_back(part);
             }
-            i += 2;
+            i += atSeparator ? 2 : 1;
+            start = i;
         } else {
-            current += name[i];
             ++i;
         }
     }
 
-    if (!current.empty()) {
-        parts.push_back(current);
-    }
-
-    return parts;
+    return true;
 }
 
 std::string symbolKindToString(SymbolKind kind) {
@@ -2,10 +2,10 @@
 #define IBORB_IDL_SYMBOL_TABLE_HPP
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <memory>
-#include <optional>
 #include "ast/ast.hpp"
 
 namespace iborb::semantic {
@@ -32,15 +32,15 @@ enum class SymbolKind {
  * @brief Symbol information stored in the symbol table
  */
 struct Symbol {
-    std::string name;
-    std::string fullyQualifiedName;
+    ast::Name name;
+    ast::Name fullyQualifiedName;
     SymbolKind kind;
     ast::ASTNode* node = nullptr;  // Non-owning pointer to AST node
-    std::string scope;  // Parent scope
+    ast::Name scope;  // Parent scope
 
     Symbol() = default;
-    Symbol(std::string n, std::string fqn, SymbolKind k, ast::ASTNode* astNode = nullptr)
-        : name(std::move(n)), fullyQualifiedName(std::move(fqn)), kind(k), node(astNode) {}
+    Symbol(ast::Name n, ast::Name fqn, SymbolKind k, ast::ASTNode* astNode = nullptr)
+        : name(n), fullyQualifiedName(fqn), kind(k), node(astNode) {}
 };
 
 /**
@@ -48,39 +48,41 @@ struct Symbol {
  */
 class Scope {
 public:
-    std::string name;
-    std::string fullyQualifiedName;
+    ast::Name name;
+    ast::Name fullyQualifiedName;
     Scope* parent = nullptr;
-    std::unordered_map<std::string, Symbol> symbols;
-    std::vector<std::unique_ptr<Scope>> children;
+    std::unordered_map<ast::Name, Symbol> symbols;  // Hashed by handle address
+    std::vector<std::unique_ptr<Scope>> children;   // In creation order
+    std::unordered_map<ast::Name, Scope*> childIndex;  // Children by name
 
-    explicit Scope(std::string scopeName = "", Scope* parentScope = nullptr);
+    explicit Scope(ast::Name scopeName = {}, Scope* parentScope = nullptr);
 
     /**
      * @brief Add a symbol to this scope
-     * @return true if added successfully, false if duplicate
+     * @return The stored symbol, or nullptr if the name is a duplicate
      */
-    bool addSymbol(const Symbol& symbol);
+    const Symbol* addSymbol(const Symbol& symbol);
 
     /**
      * @brief Look up a symbol in this scope only (not parent scopes)
+     * @return Pointer that stays valid for the lifetime of the scope, or nullptr
      */
-    std::optional<Symbol> lookupLocal(const std::string& name) const;
+    const Symbol* lookupLocal(ast::Name name) const;
 
     /**
      * @brief Look up a symbol in this scope and parent scopes
      */
-    std::optional<Symbol> lookup(const std::string& name) const;
+    const Symbol* lookup(ast::Name name) const;
 
     /**
      * @brief Create a child scope
      */
-    Scope* createChildScope(const std::string& childName);
+    Scope* createChildScope(ast::Name childName);
 
     /**
      * @brief Get a child scope by name
      */
-    Scope* getChildScope(const std::string& childName) const;
+    Scope* getChildScope(ast::Name childName) const;
 };
 
 /**
@@ -93,7 +95,7 @@ public:
     /**
      * @brief Enter a new scope (module, interface, etc.)
      */
-    void enterScope(const std::string& scopeName);
+    void enterScope(ast::Name scopeName);
 
     /**
      * @brief Leave the current scope and return to parent
@@ -104,28 +106,44 @@ public:
      * @brief Add a symbol to the current scope
      * @return true if added, false if duplicate
      */
-    bool addSymbol(const std::string& name, SymbolKind kind, ast::ASTNode* node = nullptr);
+    bool addSymbol(ast::Name name, SymbolKind kind, ast::ASTNode* node = nullptr);
 
     /**
      * @brief Look up a symbol by simple name (searches current and parent scopes)
+     * @return Pointer that stays valid for the lifetime of the table, or nullptr
      */
-    std::optional<Symbol> lookup(const std::string& name) const;
+    const Symbol* lookup(ast::Name name) const;
 
     /**
      * @brief Look up a symbol by scoped name (e.g., "ModuleA::StructB")
      */
-    std::optional<Symbol> lookupScoped(const std::vector<std::string>& parts, 
-                                        bool isAbsolute = false) const;
+    const Symbol* lookupScoped(const std::vector<ast::Name>& parts,
+                               bool isAbsolute = false) const;
+
+    /**
+     * @brief Look up a scoped name as if referenced from the given scope
+     */
+    const Symbol* lookupScoped(const std::vector<ast::Name>& parts, bool isAbsolute,
+                               const Scope& from) const;
 
     /**
      * @brief Look up a symbol by fully qualified name string (e.g., "::ModuleA::StructB")
+     *
+     * Absolute names are found with a single hash lookup in the table's
+     * fully-qualified-name index. The first such lookup builds the index,
+     * so it must not race with other lookups on the same table.
      */
-    std::optional<Symbol> lookupQualified(const std::string& qualifiedName) const;
+    const Symbol* lookupQualified(std::string_view qualifiedName) const;
+
+    /**
+     * @brief Look up a symbol by its fully qualified name, as stored in Symbol
+     */
+    const Symbol* lookupFullyQualified(ast::Name fullyQualifiedName) const;
 
     /**
      * @brief Get the current scope's fully qualified name
      */
-    std::string getCurrentScopeName() const;
+    ast::Name getCurrentScopeName() const;
 
     /**
      * @brief Get the current scope
@@ -140,21 +158,59 @@ public:
     /**
      * @brief Check if a symbol exists in the current scope (local only)
      */
-    bool existsInCurrentScope(const std::string& name) const;
+    bool existsInCurrentScope(ast::Name name) const;
 
     /**
      * @brief Build fully qualified name for a symbol in current scope
      */
-    std::string buildFullyQualifiedName(const std::string& name) const;
+    ast::Name buildFullyQualifiedName(ast::Name name) const;
+
+    /**
+     * @brief Merge the symbols of another table into this one
+     *
+     * Scopes are matched by name, as when a module is reopened. Symbols
+     * that already exist are kept. Node pointers are copied, so the other
+     * table's AST must outlive this table.
+     */
+    void merge(const SymbolTable& other);
+
+    /**
+     * @brief Merge another table into this one, taking over its scopes
+     *
+     * Child scopes this table does not have yet are moved over whole
+     * rather than copied, so merging tables that were built for separate
+     * modules costs little. Scopes and symbols keep their addresses; the
+     * other table is left empty.
+     */
+    void merge(SymbolTable&& other);
 
 private:
     std::unique_ptr<Scope> globalScope_;
     Scope* currentScope_;
 
+    // Every symbol by fully qualified name: open addressing with linear
+    // probing over a power-of-two table, keyed by the symbol's own FQN.
+    // Parsing rarely needs it, so it is built by the first lookup and
+    // kept up to date from then on.
+    mutable std::vector<const Symbol*> qualifiedIndex_;
+    mutable size_t qualifiedCount_ = 0;
+
     /**
-     * @brief Parse a qualified name string into parts
+     * @brief Add a symbol to a scope and to the index, once it exists
      */
-    static std::vector<std::string> parseQualifiedName(const std::string& name);
+    const Symbol* addToScope(Scope& scope, const Symbol& symbol);
+
+    void buildQualifiedIndex(const Scope& scope) const;
+    void indexSymbol(const Symbol* symbol) const;
+
+    /**
+     * @brief Split a qualified name string into parts
+     * @return false if a part was never interned, so cannot name a symbol
+     */
+    static bool parseQualifiedName(std::string_view name, std::vector<ast::Name>& parts);
+
+    void mergeScope(Scope& target, const Scope& source);
+    void mergeScope(Scope& target, Scope&& source);
 };
 
 /**
@@ -0,0 +1,275 @@
+#include "semantic/type_resolver.hpp"
+
+namespace iborb::semantic {
+
+using namespace ast;
+
+namespace {
+
+const char* mapBasicType(BasicType type) {
+    switch (type) {
+        case BasicType::Void:       return "void";
+        case BasicType::Boolean:    return "bool";
+        case BasicType::Char:       return "char";
+        case BasicType::WChar:      return "wchar_t";
+        case BasicType::Octet:      return "uint8_t";
+        case BasicType::Short:      return "int16_t";
+        case BasicType::UShort:     return "uint16_t";
+        case BasicType::Long:       return "int32_t";
+        case BasicType::ULong:      return "uint32_t";
+        case BasicType::LongLong:   return "int64_t";
+        case BasicType::ULongLong:  return "uint64_t";
+        case BasicType::Float:      return "float";
+        case BasicType::Double:     return "double";
+        case BasicType::LongDouble: return "long double";
+        case BasicType::Any:        return "std::any";
+        case BasicType::Object:     return "Object";
+    }
+    return "void";
+}
+
+constexpr size_t kBasicTypeCount = static_cast<size_t>(BasicType::Object) + 1;
+
+/**
+ * @brief Interned spellings of the types that need no lookup
+ */
+struct FixedTypes {
+    Name basicCpp[kBasicTypeCount];
+    Name basicId[kBasicTypeCount];
+    Name string = Name::intern("string");
+    Name wstring = Name::intern("wstring");
+    Name stdString = Name::intern("std::string");
+    Name stdWstring = Name::intern("std::wstring");
+    Name voidType = Name::intern("void");
+
+    FixedTypes() {
+        for (size_t i = 0; i < kBasicTypeCount; ++i) {
+            auto type = static_cast<BasicType>(i);
+            basicCpp[i] = Name::intern(mapBasicType(type));
+            basicId[i] = Name::intern(BasicTypeNode::typeToString(type));
+        }
+    }
+};
+
+const FixedTypes& fixedTypes() {
+    static const FixedTypes types;
+    return types;
+}
+
+} // anonymous namespace
+
+TypeResolver::TypeResolver(const SymbolTable& symbols, std::vector<Diagnostic>& diagnostics)
+    : symbols_(symbols), evaluator_(symbols, diagnostics), scope_(symbols.getGlobalScope()) {
+}
+
+void TypeResolver::resolve(DefinitionNode& definition, const Scope& enclosing) {
+    scope_ = &enclosing;
+    dispatch(definition);
+}
+
+void TypeResolver::foldDimensions(const ASTList<ConstExpr>& exprs, std::vector<size_t>& dimensions) {
+    dimensions.clear();
+    for (auto* expr : exprs) {
+        dimensions.push_back(evaluator_.evaluateSize(*expr, *scope_).value_or(0));
+    }
+}
+
+template<typename Node, typename Fn>
+void TypeResolver::inScopeOf(const Node& node, Fn&& fn) {
+    // A scope is missing only after parse errors; stay in the parent then
+    const Scope* parent = scope_;
+    if (const Scope* child = scope_->getChildScope(node.name)) {
+        scope_ = child;
+    }
+    fn();
+    scope_ = parent;
+}
+
+void TypeResolver::resolveType(TypeNode* type) {
+    if (type && type->typeId.empty()) {
+        dispatch(*type);
+    }
+}
+
+// ============================================================================
+// Definitions
+// ============================================================================
+
+void TypeResolver::visit(ModuleNode& node) {
+    inScopeOf(node, [&] {
+        for (auto* def : node.definitions) {
+            dispatch(*def);
+        }
+    });
+}
+
+void TypeResolver::visit(InterfaceNode& node) {
+    if (node.isForward) {
+        return;
+    }
+    inScopeOf(node, [&] {
+        for (auto* content : node.contents) {
+            dispatch(*content);
+        }
+    });
+}
+
+void TypeResolver::visit(OperationNode& node) {
+    resolveType(node.returnType);
+    for (auto* param : node.parameters) {
+        dispatch(*param);
+    }
+}
+
+void TypeResolver::visit(ParameterNode& node) {
+    resolveType(node.type);
+}
+
+void TypeResolver::visit(AttributeNode& node) {
+    resolveType(node.type);
+}
+
+void TypeResolver::visit(StructNode& node) {
+    inScopeOf(node, [&] {
+        for (auto* member : node.members) {
+            dispatch(*member);
+        }
+    });
+}
+
+void TypeResolver::visit(StructMemberNode& node) {
+    resolveType(node.type);
+}
+
+void TypeResolver::visit(TypedefNode& node) {
+    resolveType(node.originalType);
+    for (auto& declarator : node.declarators) {
+        foldDimensions(declarator.dimensionExprs, declarator.arrayDimensions);
+    }
+}
+
+void TypeResolver::visit(EnumNode&) {
+    // Enumerators have no types
+}
+
+void TypeResolver::visit(ConstNode& node) {
+    resolveType(node.type);
+}
+
+void TypeResolver::visit(ExceptionNode& node) {
+    inScopeOf(node, [&] {
+        for (auto* member : node.members) {
+            dispatch(*member);
+        }
+    });
+}
+
+void TypeResolver::visit(UnionNode& node) {
+    // The discriminator is declared before the union's scope opens
+    resolveType(node.discriminatorType);
+    inScopeOf(node, [&] {
+        for (auto* caseNode : node.cases) {
+            dispatch(*caseNode);
+        }
+    });
+}
+
+void TypeResolver::visit(UnionCaseNode& node) {
+    for (auto& label : node.labels) {
+        if (label.expr) {
+            label.value = evaluator_.evaluate(*label.expr, *scope_);
+        }
+    }
+    resolveType(node.type);
+}
+
+// ============================================================================
+// Types
+// ============================================================================
+
+void TypeResolver::visit(BasicTypeNode& node) {
+    auto index = static_cast<size_t>(node.type);
+    node.resolvedCppType = fixedTypes().basicCpp[index];
+    node.typeId = fixedTypes().basicId[index];
+}
+
+void TypeResolver::visit(SequenceTypeNode& node) {
+    if (node.boundExpr) {
+        node.bound = evaluator_.evaluateSize(*node.boundExpr, *scope_);
+    }
+    resolveType(node.elementType);
+    Name elemType = node.elementType ? node.elementType->resolvedCppType : fixedTypes().voidType;
+    Name elemId = node.elementType ? node.elementType->typeId : fixedTypes().voidType;
+
+    buffer_.assign("std::vector<").append(elemType.view()).append(">");
+    node.resolvedCppType = Name::intern(buffer_);
+
+    buffer_.assign("sequence<").append(elemId.view());
+    if (node.bound) {
+        buffer_.append(",").append(std::to_string(*node.bound));
+    }
+    node.typeId = Name::intern(buffer_.append(">"));
+}
+
+void TypeResolver::visit(StringTypeNode& node) {
+    if (node.boundExpr) {
+        node.bound = evaluator_.evaluateSize(*node.boundExpr, *scope_);
+    }
+    const FixedTypes& fixed = fixedTypes();
+    node.resolvedCppType = node.isWide ? fixed.stdWstring : fixed.stdString;
+    node.typeId = node.isWide ? fixed.wstring : fixed.string;
+    if (node.bound) {
+        buffer_.assign(node.typeId.view()).append("<").append(std::to_string(*node.bound));
+        node.typeId = Name::intern(buffer_.append(">"));
+    }
+}
+
+void TypeResolver::visit(ScopedNameNode& node) {
+    // IDL scopes map one to one onto C++ namespaces and classes, so the
+    // name is spelled in C++ exactly as it is in IDL
+    if (node.parts.size() == 1 && !node.isAbsolute) {
+        node.resolvedCppType = node.parts[0];
+    } else {
+        buffer_.clear();
+        for (size_t i = 0; i < node.parts.size(); ++i) {
+            if (i > 0 || node.isAbsolute) {
+                buffer_ += "::";
+            }
+            buffer_.append(node.parts[i].view());
+        }
+        node.resolvedCppType = Name::intern(buffer_);
+    }
+
+    if (const Symbol* symbol = symbols_.lookupScoped(node.parts, node.isAbsolute, *scope_)) {
+        node.resolvedScope = symbol->scope;
+        node.typeId = symbol->fullyQualifiedName;
+    } else {
+        node.typeId = node.resolvedCppType;
+    }
+}
+
+void TypeResolver::visit(ArrayTypeNode& node) {
+    foldDimensions(node.dimensionExprs, node.dimensions);
+    resolveType(node.elementType);
+    Name elemType = node.elementType ? node.elementType->resolvedCppType : fixedTypes().voidType;
+    Name elemId = node.elementType ? node.elementType->typeId : fixedTypes().voidType;
+
+    // Outermost dimension first: long[2][3] is std::array<std::array<int32_t, 3>, 2>
+    buffer_.clear();
+    for (size_t i = 0; i < node.dimensions.size(); ++i) {
+        buffer_ += "std::array<";
+    }
+    buffer_.append(elemType.view());
+    for (auto it = node.dimensions.rbegin(); it != node.dimensions.rend(); ++it) {
+        buffer_.append(", ").append(std::to_string(*it)).append(">");
+    }
+    node.resolvedCppType = Name::intern(buffer_);
+
+    buffer_.assign(elemId.view());
+    for (size_t dimension : node.dimensions) {
+        buffer_.append("[").append(std::to_string(dimension)).append("]");
+    }
+    node.typeId = Name::intern(buffer_);
+}
+
+} // namespace iborb::semantic
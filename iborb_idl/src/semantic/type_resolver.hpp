@@ -0,0 +1,81 @@
+#ifndef IBORB_IDL_TYPE_RESOLVER_HPP
+#define IBORB_IDL_TYPE_RESOLVER_HPP
+
+#include <string>
+#include <vector>
+#include "ast/ast.hpp"
+#include "ast/static_visitor.hpp"
+#include "semantic/const_evaluator.hpp"
+#include "semantic/diagnostic.hpp"
+#include "semantic/symbol_table.hpp"
+
+namespace iborb::semantic {
+
+/**
+ * @brief Resolves every type node of a translation unit once
+ *
+ * Fills the cached fields of each ast::TypeNode so that later passes
+ * never rebuild a type spelling:
+ * - resolvedCppType: the C++11 mapping of the type
+ * - resolvedScope: for a scoped name, the scope its symbol is declared in
+ * - typeId: a canonical IDL spelling, the same handle for structurally
+ *   identical types. Named types are identified by the fully qualified
+ *   name of their symbol, whatever scope they are referenced from.
+ *
+ * Bounds, array dimensions and union case labels are folded on the
+ * way, as they are part of the type. Constants must be folded first.
+ *
+ * Scoped names are looked up from the scope that encloses the
+ * reference. Names that do not resolve keep their spelling.
+ *
+ * The resolver only reads the symbol table, so separate resolvers can
+ * work on different definitions of a unit in parallel.
+ */
+class TypeResolver : public ast::StaticVisitor<TypeResolver> {
+public:
+    /**
+     * @param diagnostics Receives warnings from folding bounds and labels
+     */
+    TypeResolver(const SymbolTable& symbols, std::vector<Diagnostic>& diagnostics);
+
+    /**
+     * @brief Resolve the types of a definition
+     * @param enclosing Scope the definition is declared in
+     */
+    void resolve(ast::DefinitionNode& definition, const Scope& enclosing);
+
+    void visit(ast::ModuleNode& node);
+    void visit(ast::InterfaceNode& node);
+    void visit(ast::OperationNode& node);
+    void visit(ast::ParameterNode& node);
+    void visit(ast::AttributeNode& node);
+    void visit(ast::StructNode& node);
+    void visit(ast::StructMemberNode& node);
+    void visit(ast::TypedefNode& node);
+    void visit(ast::EnumNode& node);
+    void visit(ast::ConstNode& node);
+    void visit(ast::ExceptionNode& node);
+    void visit(ast::UnionNode& node);
+    void visit(ast::UnionCaseNode& node);
+    void visit(ast::BasicTypeNode& node);
+    void visit(ast::SequenceTypeNode& node);
+    void visit(ast::StringTypeNode& node);
+    void visit(ast::ScopedNameNode& node);
+    void visit(ast::ArrayTypeNode& node);
+
+private:
+    const SymbolTable& symbols_;
+    ConstEvaluator evaluator_;
+    const Scope* scope_;  // Scope enclosing the nodes being visited
+    std::string buffer_;  // Reused to build spellings, so interned ones cost no allocation
+
+    void resolveType(ast::TypeNode* type);
+    void foldDimensions(const ast::ASTList<ast::ConstExpr>& exprs, std::vector<size_t>& dimensions);
+
+    template<typename Node, typename Fn>
+    void inScopeOf(const Node& node, Fn&& fn);
+};
+
+} // namespace iborb::semantic
+
+#endif // IBORB_IDL_TYPE_RESOLVER_HPP
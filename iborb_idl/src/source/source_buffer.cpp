@@ -0,0 +1,172 @@
+#include "source/source_buffer.hpp"
+#include <stdexcept>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace iborb::source {
+
+namespace {
+
+/**
+ * @brief Buffer holding text in a std::string
+ */
+class OwnedBuffer : public SourceBuffer {
+public:
+    explicit OwnedBuffer(std::string contents) : contents_(std::move(contents)) {
+        data_ = contents_;
+    }
+
+private:
+    std::string contents_;
+};
+
+/**
+ * @brief Buffer backed by a read-only file mapping
+ */
+class MappedBuffer : public SourceBuffer {
+public:
+#ifdef _WIN32
+    MappedBuffer(HANDLE mapping, const char* view, size_t size) : mapping_(mapping) {
+        data_ = std::string_view(view, size);
+    }
+
+    ~MappedBuffer() override {
+        UnmapViewOfFile(data_.data());
+        CloseHandle(mapping_);
+    }
+#else
+    MappedBuffer(const char* view, size_t size) {
+        data_ = std::string_view(view, size);
+    }
+
+    ~MappedBuffer() override {
+        munmap(const_cast<char*>(data_.data()), data_.size());
+    }
+#endif
+
+    bool isMapped() const override { return true; }
+
+private:
+#ifdef _WIN32
+    HANDLE mapping_;
+#endif
+};
+
+#ifdef _WIN32
+/**
+ * @brief Read an open file to its end and close it
+ */
+std::unique_ptr<SourceBuffer> readAndClose(HANDLE file, const std::string& path) {
+    std::string contents;
+    char chunk[64 * 1024];
+    DWORD count = 0;
+    BOOL ok;
+    while ((ok = ReadFile(file, chunk, sizeof(chunk), &count, nullptr)) && count > 0) {
+        contents.append(chunk, count);
+    }
+    // The write end of a pipe being closed is its end of file
+    bool failed = !ok && GetLastError() != ERROR_BROKEN_PIPE;
+    CloseHandle(file);
+    if (failed) {
+        throw std::runtime_error("Cannot read file: " + path);
+    }
+    return SourceBuffer::fromString(std::move(contents));
+}
+#else
+/**
+ * @brief Read an open file to its end and close it
+ */
+std::unique_ptr<SourceBuffer> readAndClose(int fd, const std::string& path) {
+    std::string contents;
+    char chunk[64 * 1024];
+    for (;;) {
+        ssize_t count = ::read(fd, chunk, sizeof(chunk));
+        if (count > 0) {
+            contents.append(chunk, static_cast<size_t>(count));
+        } else if (count == 0) {
+            break;
+        } else if (errno != EINTR) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+    }
+    ::close(fd);
+    return SourceBuffer::fromString(std::move(contents));
+}
+#endif
+
+/**
+ * @brief Map a file, or read it when mapping is not possible
+ *
+ * Pipes, FIFOs and the like are read from the descriptor already open,
+ * as opening them a second time would block or miss their data.
+ */
+std::unique_ptr<SourceBuffer> loadFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        return readAndClose(file, path);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        return readAndClose(file, path);
+    }
+
+    auto* view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!view) {
+        CloseHandle(mapping);
+        return readAndClose(file, path);
+    }
+    CloseHandle(file);  // The mapping keeps the file open
+    return std::make_unique<MappedBuffer>(mapping, view, static_cast<size_t>(size.QuadPart));
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return readAndClose(fd, path);
+    }
+
+    auto size = static_cast<size_t>(st.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        return readAndClose(fd, path);
+    }
+    ::close(fd);  // The mapping keeps the file open
+#ifdef MADV_SEQUENTIAL
+    madvise(view, size, MADV_SEQUENTIAL);
+#endif
+    return std::make_unique<MappedBuffer>(static_cast<const char*>(view), size);
+#endif
+}
+
+} // anonymous namespace
+
+std::unique_ptr<SourceBuffer> SourceBuffer::fromFile(const std::string& path) {
+    return loadFile(path);
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::fromString(std::string contents) {
+    return std::make_unique<OwnedBuffer>(std::move(contents));
+}
+
+} // namespace iborb::source
@@ -0,0 +1,60 @@
+#ifndef IBORB_IDL_SOURCE_BUFFER_HPP
+#define IBORB_IDL_SOURCE_BUFFER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace iborb::source {
+
+/**
+ * @brief Read-only view of source text that owns its backing storage
+ *
+ * Files are mapped read-only into memory so the lexer scans the page
+ * cache directly, without reading them into an intermediate string.
+ * Text produced in memory (preprocessor output, stdin, generated input)
+ * is moved into an owning buffer instead. Either way the contents stay
+ * at a fixed address for the lifetime of the buffer, so tokens can keep
+ * string_views into it.
+ */
+class SourceBuffer {
+public:
+    virtual ~SourceBuffer() = default;
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    /**
+     * @brief Get the buffer contents
+     */
+    std::string_view data() const { return data_; }
+
+    /**
+     * @brief Check whether the contents are a memory mapping of a file
+     */
+    virtual bool isMapped() const { return false; }
+
+    /**
+     * @brief Map a file read-only, falling back to reading it
+     * @param path Path to the file
+     * @throws std::runtime_error if the file cannot be opened or read
+     *
+     * Empty files, pipes and files on filesystems that do not support
+     * mapping are read into an owning buffer.
+     */
+    static std::unique_ptr<SourceBuffer> fromFile(const std::string& path);
+
+    /**
+     * @brief Take ownership of text that is already in memory
+     */
+    static std::unique_ptr<SourceBuffer> fromString(std::string contents);
+
+protected:
+    SourceBuffer() = default;
+
+    std::string_view data_;
+};
+
+} // namespace iborb::source
+
+#endif // IBORB_IDL_SOURCE_BUFFER_HPP
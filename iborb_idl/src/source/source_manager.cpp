@@ -0,0 +1,136 @@
+#include "source/source_manager.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace iborb::source {
+
+SourceManager::SourceManager() {
+    // Reserve id 0 so that a default-constructed SourceLocation is invalid
+    entries_.emplace_back();
+    names_.emplace_back();
+}
+
+uint32_t SourceManager::addBuffer(std::unique_ptr<SourceBuffer> buffer, std::string_view filename) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto bufferId = static_cast<uint32_t>(buffers_.size());
+    buffers_.emplace_back(std::move(buffer));
+
+    FileEntry entry;
+    entry.nameId = internName(filename);
+    entry.bufferId = bufferId;
+    entries_.push_back(entry);
+    return static_cast<uint32_t>(entries_.size() - 1);
+}
+
+uint32_t SourceManager::addBuffer(std::string contents, std::string_view filename) {
+    return addBuffer(SourceBuffer::fromString(std::move(contents)), filename);
+}
+
+std::string_view SourceManager::getBufferData(uint32_t fileId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return buffers_[entries_[fileId].bufferId].data->data();
+}
+
+uint32_t SourceManager::addLineMarker(uint32_t fileId, std::string_view filename,
+                                      uint32_t offset, uint32_t line) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    FileEntry entry;
+    entry.nameId = internName(filename);
+    entry.bufferId = entries_[fileId].bufferId;
+    entry.startOffset = offset;
+    entry.line = line;
+    entries_.push_back(entry);
+    return static_cast<uint32_t>(entries_.size() - 1);
+}
+
+size_t SourceManager::getBufferCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return buffers_.size();
+}
+
+std::vector<LineMarker> SourceManager::getLineMarkers() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<LineMarker> markers;
+    // Entry 1 is the buffer itself
+    for (size_t i = 2; i < entries_.size(); ++i) {
+        const FileEntry& entry = entries_[i];
+        markers.push_back({names_[entry.nameId], entry.startOffset, entry.line});
+    }
+    return markers;
+}
+
+std::vector<std::string> SourceManager::getFilenames() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    // Name 0 belongs to the invalid location
+    return std::vector<std::string>(std::next(names_.begin()), names_.end());
+}
+
+std::string_view SourceManager::getFilename(ast::SourceLocation loc) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (!loc.isValid() || loc.fileId >= entries_.size()) {
+        return {};
+    }
+    return names_[entries_[loc.fileId].nameId];
+}
+
+PresumedLocation SourceManager::getPresumedLocation(ast::SourceLocation loc) const {
+    PresumedLocation result;
+    FileEntry entry;
+    const Buffer* buffer = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (!loc.isValid() || loc.fileId >= entries_.size()) {
+            return result;
+        }
+        entry = entries_[loc.fileId];
+        buffer = &buffers_[entry.bufferId];
+        result.filename = names_[entry.nameId];
+    }
+
+    // Buffers and names never move, so they can be used without the lock
+    const auto& lineStarts = getLineStarts(*buffer);
+    size_t physLine = findLineIndex(lineStarts, loc.offset);
+    size_t entryLine = findLineIndex(lineStarts, entry.startOffset);
+
+    result.line = entry.line + (physLine - entryLine);
+    result.column = loc.offset - lineStarts[physLine] + 1;
+    return result;
+}
+
+std::string SourceManager::format(ast::SourceLocation loc) const {
+    return getPresumedLocation(loc).toString();
+}
+
+uint32_t SourceManager::internName(std::string_view filename) {
+    auto it = nameIds_.find(filename);
+    if (it != nameIds_.end()) {
+        return it->second;
+    }
+    auto id = static_cast<uint32_t>(names_.size());
+    names_.emplace_back(filename);
+    nameIds_.emplace(names_.back(), id);
+    return id;
+}
+
+const std::vector<uint32_t>& SourceManager::getLineStarts(const Buffer& buffer) const {
+    std::call_once(buffer.lineStartsBuilt, [&buffer] {
+        std::string_view text = buffer.data->data();
+        const char* data = text.data();
+        const char* end = data + text.size();
+        buffer.lineStarts.push_back(0);
+        for (const char* p = data; p < end; ++p) {
+            p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (!p) break;
+            buffer.lineStarts.push_back(static_cast<uint32_t>(p - data + 1));
+        }
+    });
+    return buffer.lineStarts;
+}
+
+size_t SourceManager::findLineIndex(const std::vector<uint32_t>& lineStarts, uint32_t offset) {
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    return static_cast<size_t>(it - lineStarts.begin()) - 1;
+}
+
+} // namespace iborb::source
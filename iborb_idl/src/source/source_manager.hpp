@@ -0,0 +1,154 @@
+#ifndef IBORB_IDL_SOURCE_MANAGER_HPP
+#define IBORB_IDL_SOURCE_MANAGER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ast/ast.hpp"
+#include "source/source_buffer.hpp"
+
+namespace iborb::source {
+
+/**
+ * @brief Human-readable position derived from a compact SourceLocation
+ */
+struct PresumedLocation {
+    std::string_view filename;
+    size_t line = 0;
+    size_t column = 0;
+
+    bool isValid() const { return line != 0; }
+
+    std::string toString() const {
+        return std::string(filename) + ":" + std::to_string(line) + ":" + std::to_string(column);
+    }
+};
+
+/**
+ * @brief A line marker as recorded by SourceManager::addLineMarker()
+ */
+struct LineMarker {
+    std::string_view filename;
+    uint32_t offset = 0;
+    uint32_t line = 1;
+};
+
+/**
+ * @brief Owns source buffers and maps compact locations back to file/line/column
+ *
+ * Every buffer handed to the lexer is registered here. Each line marker
+ * found in a buffer (`# 12 "file.idl"`) opens a new file entry that
+ * records the interned file name, the offset at which the marker takes
+ * effect and the line number it assigns. An ast::SourceLocation is a
+ * file entry id plus a byte offset; line and column are computed on
+ * demand from a per-buffer table of line start offsets, so lexing does
+ * no line/column bookkeeping at all.
+ *
+ * Locations may be resolved from several threads at once, as happens
+ * for headers shared between input files, and while the lexer is still
+ * adding line markers, as happens when definitions are generated as
+ * soon as they are parsed.
+ */
+class SourceManager {
+public:
+    SourceManager();
+
+    /**
+     * @brief Take ownership of a source buffer
+     * @param buffer Mapped or owning buffer
+     * @param filename Name reported for locations before any line marker
+     * @return File entry id covering the start of the buffer
+     */
+    uint32_t addBuffer(std::unique_ptr<SourceBuffer> buffer, std::string_view filename);
+
+    /**
+     * @brief Take ownership of in-memory source text
+     */
+    uint32_t addBuffer(std::string contents, std::string_view filename);
+
+    /**
+     * @brief Get the contents of the buffer a file entry belongs to
+     */
+    std::string_view getBufferData(uint32_t fileId) const;
+
+    /**
+     * @brief Open a file entry for a line marker
+     * @param fileId Entry active where the marker appears
+     * @param filename File name given by the marker
+     * @param offset Offset of the first line the marker applies to
+     * @param line Line number assigned to that line
+     * @return New file entry id
+     */
+    uint32_t addLineMarker(uint32_t fileId, std::string_view filename,
+                           uint32_t offset, uint32_t line);
+
+    /**
+     * @brief Number of buffers added
+     */
+    size_t getBufferCount() const;
+
+    /**
+     * @brief Get the line markers of a manager that holds a single buffer
+     *
+     * Adding the same buffer to a new manager and then the markers in
+     * order, with the buffer's file id, recreates every file entry under
+     * the same id, so locations stay valid without lexing the buffer again.
+     */
+    std::vector<LineMarker> getLineMarkers() const;
+
+    /**
+     * @brief Get the names of the buffers and line markers, each once, in order of first use
+     */
+    std::vector<std::string> getFilenames() const;
+
+    /**
+     * @brief Get the interned file name for a location
+     */
+    std::string_view getFilename(ast::SourceLocation loc) const;
+
+    /**
+     * @brief Resolve a location to file name, line and column
+     */
+    PresumedLocation getPresumedLocation(ast::SourceLocation loc) const;
+
+    /**
+     * @brief Format a location as "file:line:column"
+     */
+    std::string format(ast::SourceLocation loc) const;
+
+private:
+    struct Buffer {
+        std::unique_ptr<SourceBuffer> data;
+        mutable std::vector<uint32_t> lineStarts;  // Built lazily
+        mutable std::once_flag lineStartsBuilt;
+
+        explicit Buffer(std::unique_ptr<SourceBuffer> buffer) : data(std::move(buffer)) {}
+    };
+
+    struct FileEntry {
+        uint32_t nameId = 0;
+        uint32_t bufferId = 0;
+        uint32_t startOffset = 0;
+        uint32_t line = 1;
+    };
+
+    std::deque<Buffer> buffers_;      // Stable addresses for lexer views
+    std::vector<FileEntry> entries_;  // Entry 0 is the invalid location
+    std::deque<std::string> names_;   // Stable storage for nameIds_ keys
+    std::unordered_map<std::string_view, uint32_t> nameIds_;
+    mutable std::shared_mutex mutex_;  // Guards the containers above against concurrent growth
+
+    uint32_t internName(std::string_view filename);
+    const std::vector<uint32_t>& getLineStarts(const Buffer& buffer) const;
+    static size_t findLineIndex(const std::vector<uint32_t>& lineStarts, uint32_t offset);
+};
+
+} // namespace iborb::source
+
+#endif // IBORB_IDL_SOURCE_MANAGER_HPP